@@ -0,0 +1,94 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static uint64_t bench_allocations = 0;
+static uint64_t bench_allocated_bytes = 0;
+
+///////////////////////////////////////////////////////////////////////////////////
+// allocator wrappers
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    __atomic_add_fetch(&bench_allocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bench_allocated_bytes, size, __ATOMIC_RELAXED);
+
+    return(__real_malloc(size));
+}
+
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    __atomic_add_fetch(&bench_allocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bench_allocated_bytes, count * size, __ATOMIC_RELAXED);
+
+    return(__real_calloc(count, size));
+}
+
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    __atomic_add_fetch(&bench_allocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bench_allocated_bytes, size, __ATOMIC_RELAXED);
+
+    return(__real_realloc(ptr, size));
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+void bench_alloc_reset(void)
+{
+    __atomic_store_n(&bench_allocations, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&bench_allocated_bytes, 0, __ATOMIC_RELAXED);
+}
+
+
+uint64_t bench_alloc_count(void)
+{
+    return(__atomic_load_n(&bench_allocations, __ATOMIC_RELAXED));
+}
+
+
+uint64_t bench_alloc_bytes(void)
+{
+    return(__atomic_load_n(&bench_allocated_bytes, __ATOMIC_RELAXED));
+}
+
+
+uint64_t bench_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return((uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+
+/**
+ * host CPU cycles, falls back to nanoseconds where there is no cycle counter
+ */
+uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return(__builtin_ia32_rdtsc());
+#else
+    return(bench_now_ns());
+#endif
+}
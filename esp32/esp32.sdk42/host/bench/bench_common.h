@@ -0,0 +1,26 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _BENCH_COMMON_H_
+#define _BENCH_COMMON_H_
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+// heap accounting, the benchmarks are linked with -Wl,--wrap for the allocator
+void bench_alloc_reset(void);
+uint64_t bench_alloc_count(void);
+uint64_t bench_alloc_bytes(void);
+
+// time and cycle counters
+uint64_t bench_now_ns(void);
+uint64_t bench_cycles(void);
+
+#endif
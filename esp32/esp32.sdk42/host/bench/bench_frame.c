@@ -0,0 +1,136 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "open_tls.h"
+#include "cmd.h"
+#include "cmd_parser.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define BENCH_FRAME_ITERATIONS              1000000
+
+// TLS 1.2 record with AES-GCM: 5-byte header, 8-byte explicit nonce, 16-byte tag
+#define BENCH_FRAME_TLS_RECORD_OVERHEAD     (5 + 8 + 16)
+
+///////////////////////////////////////////////////////////////////////////////////
+// local functions
+static bool bench_frame_decode_json(const char *data, uint32_t len, cmd_action_t *cmdSet);
+static uint32_t bench_frame_publish_size(uint32_t topicLen, uint32_t payloadLen);
+
+///////////////////////////////////////////////////////////////////////////////////
+// MAIN
+// the same OPEN command as JSON and as a binary frame, from the payload to the cmd_add() input
+int main(int argc, char *argv[])
+{
+    static const uint8_t otpAuth[16] = { 0x60, 0xe7, 0x8c, 0x9c, 0x37, 0x16, 0x3e, 0xdd,
+                                         0xce, 0x91, 0x79, 0x8e, 0x71, 0xda, 0x61, 0xd3 };
+    char json[128];
+    cmd_parser_frame_t frame;
+    cmd_action_t cmdSets[2];
+
+    memset(cmdSets, 0, sizeof(cmdSets));
+
+    // JSON as sent by the app, with the hex OTP
+    int jsonLen = snprintf(json, sizeof(json), "{\"command\":%d,\"otp-auth\":\"", CMD_ACTION_OPEN);
+    for( uint8_t oIdx = 0; oIdx < 16; oIdx++ ) {
+        jsonLen += sprintf(json + jsonLen, "%02x", otpAuth[oIdx]);
+    }
+    jsonLen += sprintf(json + jsonLen, "\"}");
+
+    frame.magic[0] = CMD_PARSER_FRAME_MAGIC_0;
+    frame.magic[1] = CMD_PARSER_FRAME_MAGIC_1;
+    frame.version = CMD_PARSER_FRAME_VERSION;
+    frame.action = CMD_ACTION_OPEN;
+    memcpy(frame.otpAuth, otpAuth, sizeof(otpAuth));
+
+    const struct {
+        const char *name;
+        const char *data;
+        uint32_t len;
+        bool (*decode)(const char *data, uint32_t len, cmd_action_t *cmdSet);
+    } formats[] = {
+        { "JSON",   json,               jsonLen,        bench_frame_decode_json },
+        { "frame",  (const char *) &frame, sizeof(frame), cmd_parser_frame },
+    };
+
+    uint32_t topicLen = strlen(OPEN_TLS_MQTT_TOPIC);
+
+    printf("%-6s %8s %10s %10s %12s\n", "format", "payload", "publish", "tls", "ns/command");
+
+    for( size_t fIdx = 0; fIdx < sizeof(formats) / sizeof(formats[0]); fIdx++ ) {
+
+        if( !formats[fIdx].decode(formats[fIdx].data, formats[fIdx].len, &cmdSets[fIdx]) ) {
+            printf("%s is not decoded\n", formats[fIdx].name);
+            return(EXIT_FAILURE);
+        }
+
+        uint64_t start = bench_now_ns();
+        for( uint32_t iter = 0; iter < BENCH_FRAME_ITERATIONS; iter++ ) {
+            formats[fIdx].decode(formats[fIdx].data, formats[fIdx].len, &cmdSets[fIdx]);
+            __asm__ volatile("" : : "r"(&cmdSets[fIdx]) : "memory");
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        uint32_t publishSize = bench_frame_publish_size(topicLen, formats[fIdx].len);
+
+        printf("%-6s %8u %10u %10u %12.1f\n", formats[fIdx].name,
+               formats[fIdx].len,
+               publishSize,
+               publishSize + BENCH_FRAME_TLS_RECORD_OVERHEAD,
+               (double) elapsed / BENCH_FRAME_ITERATIONS);
+    }
+
+    // both formats must give the same command
+    if( memcmp(&cmdSets[0], &cmdSets[1], sizeof(cmd_action_t)) ) {
+        printf("MISMATCH between JSON and frame\n");
+        return(EXIT_FAILURE);
+    }
+
+    return(EXIT_SUCCESS);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+/**
+ * the JSON path of mqtt_handle_received_control_message() up to cmd_add()
+ */
+static bool bench_frame_decode_json(const char *data, uint32_t len, cmd_action_t *cmdSet)
+{
+    cmd_parser_json_t parsed;
+
+    if( !cmd_parser_json(data, len, &parsed) || !parsed.otpAuthFound ||
+        parsed.command <= CMD_ACTION_NONE || parsed.command >= CMD_ACTION_INVALID ) {
+        return(false);
+    }
+
+    cmdSet->command_action = parsed.command;
+    memcpy(cmdSet->otpAuth, parsed.otpAuth, sizeof(cmdSet->otpAuth));
+
+    return(true);
+}
+
+
+/**
+ * size of the MQTT 3.1.1 QoS 0 PUBLISH packet on the wire
+ */
+static uint32_t bench_frame_publish_size(uint32_t topicLen, uint32_t payloadLen)
+{
+    uint32_t remaining = 2 + topicLen + payloadLen;
+    uint32_t lengthBytes = remaining < 128 ? 1 : (remaining < 16384 ? 2 : 3);
+
+    return(1 + lengthBytes + remaining);
+}
@@ -0,0 +1,195 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "mbedtls/aes.h"
+
+#include "open_tls.h"
+#include "util.h"
+#include "otp.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define BENCH_OTP_ITERATIONS                1000000     // a multiple of BENCH_OTP_DISTINCT
+#define BENCH_OTP_DISTINCT                  16          // a quarter of OTP_REPLAY_SIZE
+#define BENCH_OTP_PATHS                     3
+
+///////////////////////////////////////////////////////////////////////////////////
+// local functions
+static otp_verify_result_t bench_otp_verify_legacy(const uint8_t *otpAuth, time_t now, otp_plain_t *plain);
+static void bench_otp_encrypt(const uint8_t *plainText, uint8_t *otpAuth);
+
+///////////////////////////////////////////////////////////////////////////////////
+// MAIN
+// verifications per second:
+//   per-cmd  the key string parsed and set for every command, as cmd_loop() used to
+//   accept   the verifier built once at cmd_init(), every OTP new to the replay cache
+//   replay   the same accepted OTP again and again, as in a replay flood
+int main(int argc, char *argv[])
+{
+    static uint8_t otpAuths[BENCH_OTP_DISTINCT][16];
+    static otp_replay_store_t replay;
+    time_t now = time(NULL);
+    otp_verifier_t verifier;
+    otp_plain_t plains[BENCH_OTP_PATHS];
+
+    // valid OTPs, as the app builds them
+    for( uint32_t oIdx = 0; oIdx < BENCH_OTP_DISTINCT; oIdx++ ) {
+
+        uint8_t plainText[16];
+        uint32_t otpTime = (uint32_t) now;
+
+        for( uint8_t pIdx = 0; pIdx < 15; pIdx++ ) {
+            plainText[pIdx] = (uint8_t) (pIdx * 37 + oIdx * 11 + 5);
+        }
+        memcpy(plainText + 4, &otpTime, sizeof(otpTime));
+        plainText[15] = 0;
+        for( uint8_t pIdx = 0; pIdx < 15; pIdx++ ) {
+            plainText[15] += plainText[pIdx];
+        }
+        bench_otp_encrypt(plainText, otpAuths[oIdx]);
+    }
+
+    if( !otp_verifier_init(&verifier, OPEN_TLS_OTP_AES_KEY, OPEN_TLS_CMD_OTP_TOLERANCE, &replay) ) {
+        printf("verifier init failed\n");
+        return(EXIT_FAILURE);
+    }
+
+    const struct {
+        const char *name;
+        otp_verify_result_t expected;
+    } paths[BENCH_OTP_PATHS] = {
+        { "per-cmd",    OTP_VERIFY_OK },
+        { "accept",     OTP_VERIFY_OK },
+        { "replay",     OTP_VERIFY_REPLAY },
+    };
+
+    printf("%-10s %14s %12s\n", "path", "verify/s", "ns/verify");
+
+    for( uint8_t path = 0; path < BENCH_OTP_PATHS; path++ ) {
+
+        otp_verify_result_t result = paths[path].expected;
+
+        uint64_t start = bench_now_ns();
+        for( uint32_t iter = 0; iter < BENCH_OTP_ITERATIONS; iter++ ) {
+
+            uint32_t oIdx = iter % BENCH_OTP_DISTINCT;
+
+            if( path == 0 ) {
+
+                result = bench_otp_verify_legacy(otpAuths[oIdx], now, &plains[path]);
+
+            } else if( path == 1 ) {
+
+                // forget the accepted OTPs once all are used, amortised over BENCH_OTP_DISTINCT
+                if( oIdx == 0 ) {
+                    memset(replay.entries, 0, sizeof(replay.entries));
+                }
+                result = otp_verify(&verifier, otpAuths[oIdx], now, &plains[path]);
+
+            } else {
+
+                result = otp_verify(&verifier, otpAuths[0], now, &plains[path]);
+            }
+
+            if( result != paths[path].expected ) {
+                break;
+            }
+            __asm__ volatile("" : : "r"(&plains[path]) : "memory");
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        if( result != paths[path].expected ) {
+            printf("%s: unexpected result %d\n", paths[path].name, result);
+            return(EXIT_FAILURE);
+        }
+
+        printf("%-10s %14.0f %12.1f\n", paths[path].name,
+               (double) BENCH_OTP_ITERATIONS * 1e9 / elapsed,
+               (double) elapsed / BENCH_OTP_ITERATIONS);
+    }
+
+    printf("replay cache: %u hits, %u misses, %u full\n", verifier.stats.replayHits,
+                                                         verifier.stats.replayMisses,
+                                                         verifier.stats.replayFull);
+
+    otp_verifier_free(&verifier);
+
+    // a reboot keeps the replay set, the RTC memory of the device
+    otp_verifier_init(&verifier, OPEN_TLS_OTP_AES_KEY, OPEN_TLS_CMD_OTP_TOLERANCE, &replay);
+    otp_verify_result_t rebooted = otp_verify(&verifier, otpAuths[0], now, &plains[2]);
+    bool seen = otp_replay_seen(&verifier, otpAuths[0], now);
+    otp_verifier_free(&verifier);
+    if( rebooted != OTP_VERIFY_REPLAY || !seen ) {
+        printf("replay after reboot: unexpected result %d, %s\n", rebooted, seen ? "seen" : "not seen");
+        return(EXIT_FAILURE);
+    }
+
+    // both accepting paths must decrypt the same last block
+    if( memcmp(&plains[0], &plains[1], sizeof(otp_plain_t)) ) {
+        printf("MISMATCH between the paths\n");
+        return(EXIT_FAILURE);
+    }
+
+    return(EXIT_SUCCESS);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+/**
+ * the verification as cmd_loop() did it before the verifier
+ */
+static otp_verify_result_t bench_otp_verify_legacy(const uint8_t *otpAuth, time_t now, otp_plain_t *plain)
+{
+    esp_aes_context aes;
+    uint8_t aesKey[16];
+    uint8_t *plainText = (uint8_t *) plain;
+
+    if( !util_string_to_aes_key(OPEN_TLS_OTP_AES_KEY, aesKey) ) {
+        return(OTP_VERIFY_NO_KEY);
+    }
+
+    esp_aes_setkey(&aes, aesKey, 128);
+    esp_aes_crypt_ecb(&aes, ESP_AES_DECRYPT, otpAuth, plainText);
+
+    uint8_t checksum = 0;
+    for( uint8_t pIdx = 0; pIdx < 15; pIdx++ ) {
+        checksum += plainText[pIdx];
+    }
+
+    if( checksum != plain->checksum ) {
+        return(OTP_VERIFY_CHECKSUM);
+    }
+
+    if( (int32_t) now - (int32_t) plain->otpTime > OPEN_TLS_CMD_OTP_TOLERANCE ) {
+        return(OTP_VERIFY_TIME);
+    }
+
+    return(OTP_VERIFY_OK);
+}
+
+
+static void bench_otp_encrypt(const uint8_t *plainText, uint8_t *otpAuth)
+{
+    esp_aes_context aes;
+    uint8_t aesKey[16];
+
+    esp_aes_init(&aes);
+    util_string_to_aes_key(OPEN_TLS_OTP_AES_KEY, aesKey);
+    esp_aes_setkey(&aes, aesKey, 128);
+    esp_aes_crypt_ecb(&aes, ESP_AES_ENCRYPT, plainText, otpAuth);
+    esp_aes_free(&aes);
+}
@@ -0,0 +1,142 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "cJSON.h"
+
+#include "util.h"
+#include "cmd.h"
+#include "cmd_parser.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define BENCH_PARSER_ITERATIONS             200000
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef bool (*bench_parser_func_t)(const char *data, uint32_t len, cmd_parser_json_t *result);
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static const char *bench_parser_messages[] = {
+    "{\"command\":1,\"otp-auth\":\"60e78c9c37163eddce91798e71da61d3\"}",
+    "{\"command\":4,\"otp-auth\":\"5f01dd2c5f8fdca7d90b6e5308f0122e\",\"sender\":\"iPhone of Samson\"}",
+    "{\"command\":5}",
+    "{\"TT_ID\":\"TT-020000000001\",\"event_timestamp\":1760000000,\"firmware_version\":\"1.3.0203\"}",
+    "this is not a command",
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+// local functions
+static bool bench_parser_cjson(const char *data, uint32_t len, cmd_parser_json_t *result);
+
+///////////////////////////////////////////////////////////////////////////////////
+// MAIN
+int main(int argc, char *argv[])
+{
+    static const struct {
+        const char *name;
+        bench_parser_func_t parse;
+    } parsers[] = {
+        { "cJSON",      bench_parser_cjson },
+        { "in-place",   cmd_parser_json },
+    };
+    int mismatches = 0;
+
+    printf("%-8s %-10s %12s %12s %12s\n", "message", "parser", "msgs/s", "allocs/msg", "bytes/msg");
+
+    for( size_t mIdx = 0; mIdx < sizeof(bench_parser_messages) / sizeof(bench_parser_messages[0]); mIdx++ ) {
+
+        const char *msg = bench_parser_messages[mIdx];
+        uint32_t len = strlen(msg);
+        cmd_parser_json_t results[2];
+
+        for( size_t pIdx = 0; pIdx < sizeof(parsers) / sizeof(parsers[0]); pIdx++ ) {
+
+            bool valid = parsers[pIdx].parse(msg, len, &results[pIdx]);
+
+            bench_alloc_reset();
+            uint64_t start = bench_now_ns();
+
+            for( uint32_t iter = 0; iter < BENCH_PARSER_ITERATIONS; iter++ ) {
+                parsers[pIdx].parse(msg, len, &results[pIdx]);
+            }
+
+            uint64_t elapsed = bench_now_ns() - start;
+
+            printf("%-8zu %-10s %12.0f %12.2f %12.1f%s\n", mIdx, parsers[pIdx].name,
+                   BENCH_PARSER_ITERATIONS * 1e9 / elapsed,
+                   (double) bench_alloc_count() / BENCH_PARSER_ITERATIONS,
+                   (double) bench_alloc_bytes() / BENCH_PARSER_ITERATIONS,
+                   valid ? "" : "  (rejected)");
+        }
+
+        // both paths must extract the same command
+        if( results[0].command != results[1].command ||
+            results[0].otpAuthFound != results[1].otpAuthFound ||
+            (results[0].otpAuthFound && memcmp(results[0].otpAuth, results[1].otpAuth, 16)) ) {
+
+            printf("MISMATCH on message %zu\n", mIdx);
+            mismatches++;
+        }
+    }
+
+    return(mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+/**
+ * the previous mqtt_handle_received_control_message() path: copy, cJSON tree, lookup
+ */
+static bool bench_parser_cjson(const char *data, uint32_t len, cmd_parser_json_t *result)
+{
+    bool valid = false;
+
+    memset(result, 0, sizeof(cmd_parser_json_t));
+
+    char *msgBuf = (char *) malloc(len + 1);
+    if( msgBuf != NULL ) {
+
+        memcpy(msgBuf, data, len);
+        msgBuf[len] = 0;
+
+        cJSON *jsonRoot = cJSON_Parse(msgBuf);
+        if( jsonRoot != NULL ) {
+
+            valid = true;
+
+            cJSON *cmdIdJSON = cJSON_GetObjectItem(jsonRoot, "command");
+            if( cmdIdJSON != NULL && cJSON_IsNumber(cmdIdJSON) ) {
+                result->command = cmdIdJSON->valueint;
+            }
+
+            cJSON *otpAuthJSON = cJSON_GetObjectItem(jsonRoot, "otp-auth");
+            if( otpAuthJSON != NULL ) {
+
+                char *otpAuthStr = cJSON_GetStringValue(otpAuthJSON);
+                if( otpAuthStr != NULL && strlen(otpAuthStr) == 32 ) {
+                    result->otpAuthFound = util_string_to_aes_key(otpAuthStr, result->otpAuth);
+                }
+            }
+
+            cJSON_Delete(jsonRoot);
+        }
+
+        UTIL_FREE(msgBuf);
+    }
+
+    return(valid);
+}
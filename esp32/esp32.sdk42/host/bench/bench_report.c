@@ -0,0 +1,450 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "tcpip_adapter.h"
+#include "mbedtls/base64.h"
+
+#include "open_tls.h"
+#include "app_wifi.h"
+#include "util.h"
+#include "version.h"
+#include "cmd.h"
+#include "relay.h"
+#include "rate_limit.h"
+#include "latency.h"
+#include "tls_session.h"
+#include "boot.h"
+#include "t_gpio.h"
+#include "periodical.h"
+#include "sysmon.h"
+#include "netmon.h"
+#include "mqtt.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define BENCH_REPORT_ITERATIONS             100000
+#define BENCH_REPORT_BUF_SIZE               MQTT_REPORT_BUF_SIZE
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef size_t (*bench_report_func_t)(char *buf, size_t bufSize);
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+// the tasks of a running device, ESP-IDF v4.2 with WiFi
+static const char *const bench_report_tasks[] = {
+    "IDLE0", "IDLE1", "Tmr Svc", "ipc0", "ipc1", "esp_timer", "sys_evt", "tiT", "wifi",
+    "mqtt_task", "gpio_task", "cmd_task"
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+// local functions
+static size_t bench_report_legacy(char *buf, size_t bufSize);
+static void bench_report_job(void);
+static void bench_report_idle_task(void *arg);
+
+///////////////////////////////////////////////////////////////////////////////////
+// MAIN
+// one device report per iteration:
+//   sprintf  malloc, sprintf into a temporary string and strcat, as mqtt_proceed_device_report() used to
+//   writer   mqtt_build_device_report(), appended in place by json_writer
+int main(int argc, char *argv[])
+{
+    static const struct {
+        const char *name;
+        bench_report_func_t build;
+    } builders[] = {
+        { "sprintf",    bench_report_legacy },
+        { "writer",     mqtt_build_device_report },
+    };
+    static char reports[2][BENCH_REPORT_BUF_SIZE];
+    size_t reportLens[2];
+
+    strcpy(t_device_sn_str, "TT-020000000001");
+
+    // a report with every latency stage filled in, as on a device in use
+    latency_init();
+    for( uint32_t cmdIdx = 0; cmdIdx < 64; cmdIdx++ ) {
+
+        latency_stamps_t stamps = { .arrival = 1000000 };
+        stamps.parsed = stamps.arrival + 3 + cmdIdx % 7;
+        stamps.queued = stamps.parsed + 1;
+        stamps.dequeued = stamps.queued + 20 + cmdIdx * 3;
+        stamps.verified = stamps.dequeued + 2;
+        latency_record_command(&stamps, stamps.verified + 2 + (cmdIdx % 8 == 0 ? 750000 : 0));
+    }
+
+    // and the periodical jobs and the tasks of the device, the RSSI sample is registered by app_wifi
+    periodical_init();
+    periodical_register("rssi", 10000, 0, bench_report_job);
+    for( size_t tIdx = 0; tIdx < sizeof(bench_report_tasks) / sizeof(bench_report_tasks[0]); tIdx++ ) {
+        xTaskCreate(bench_report_idle_task, bench_report_tasks[tIdx], 4096, NULL, 1, NULL);
+    }
+    sysmon_init();
+
+    // a connection that dropped once and came back after a failed attempt
+    netmon_init();
+    netmon_mqtt_before_connect();
+    netmon_mqtt_connected();
+    for( uint32_t msgIdx = 0; msgIdx < 20; msgIdx++ ) {
+        netmon_topic_in(msgIdx % 4 == 0 ? NETMON_TOPIC_PHONE : NETMON_TOPIC_COMMAND, 90 + msgIdx, true);
+        netmon_topic_out(NETMON_TOPIC_STATUS, 180);
+    }
+    netmon_ping_sent();
+    netmon_ping_received();
+    netmon_mqtt_error(NETMON_REASON_SOCKET, 104);
+    netmon_mqtt_disconnected();
+    netmon_mqtt_before_connect();
+    netmon_mqtt_error(NETMON_REASON_TLS, 0x8008);
+    netmon_mqtt_before_connect();
+    netmon_mqtt_connected();
+    netmon_topic_out(NETMON_TOPIC_PRESENCE, 120);
+
+    printf("%-8s %12s %12s %14s %12s\n", "builder", "bytes", "allocs", "cycles/report", "reports/s");
+
+    for( size_t bIdx = 0; bIdx < sizeof(builders) / sizeof(builders[0]); bIdx++ ) {
+
+        reportLens[bIdx] = builders[bIdx].build(reports[bIdx], sizeof(reports[bIdx]));
+
+        bench_alloc_reset();
+        uint64_t start = bench_now_ns();
+        uint64_t startCycles = bench_cycles();
+
+        for( uint32_t iter = 0; iter < BENCH_REPORT_ITERATIONS; iter++ ) {
+            builders[bIdx].build(reports[bIdx], sizeof(reports[bIdx]));
+            __asm__ volatile("" : : "r"(reports[bIdx]) : "memory");
+        }
+
+        uint64_t cycles = bench_cycles() - startCycles;
+        uint64_t elapsed = bench_now_ns() - start;
+
+        printf("%-8s %12zu %12.2f %14.0f %12.0f\n", builders[bIdx].name, reportLens[bIdx],
+               (double) bench_alloc_count() / BENCH_REPORT_ITERATIONS,
+               (double) cycles / BENCH_REPORT_ITERATIONS,
+               BENCH_REPORT_ITERATIONS * 1e9 / elapsed);
+    }
+
+    // both must build the same JSON, the timestamp may have ticked in between
+    for( uint8_t retry = 0; retry < 3; retry++ ) {
+
+        if( reportLens[0] == reportLens[1] && !memcmp(reports[0], reports[1], reportLens[0]) ) {
+            printf("%s\n", reports[1]);
+            return(EXIT_SUCCESS);
+        }
+
+        reportLens[0] = bench_report_legacy(reports[0], sizeof(reports[0]));
+        reportLens[1] = mqtt_build_device_report(reports[1], sizeof(reports[1]));
+    }
+
+    printf("MISMATCH\n%s\n%s\n", reports[0], reports[1]);
+
+    return(EXIT_FAILURE);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+/**
+ * the device report as mqtt_proceed_device_report() built it before json_writer,
+ * copied out of the heap buffer so both builders fill the caller buffer
+ */
+static size_t bench_report_legacy(char *buf, size_t bufSize)
+{
+    size_t postLen = 0;
+    char *postBuf = malloc(BENCH_REPORT_BUF_SIZE);
+
+    if( postBuf != NULL ) {
+
+        char tempStr[256];
+
+        // get current time
+        time_t currentTime;
+        time(&currentTime);
+
+        sprintf(postBuf, "{\"TT_ID\":\"%s\",\"event_timestamp\":%ld,\"firmware_version\":\"%s\"", t_device_sn_str, currentTime, TT_VERSION_INFO);
+
+        tcpip_adapter_ip_info_t ipInfo;
+        tcpip_adapter_get_ip_info(TCPIP_ADAPTER_IF_STA, &ipInfo);
+
+        sprintf(tempStr, ",\"tt_net_info\":{\"ipv4\":\"%d.%d.%d.%d\"",
+                                        ipInfo.ip.addr & 0xff,
+                                        (ipInfo.ip.addr >> 8) & 0xff,
+                                        (ipInfo.ip.addr >> 16) & 0xff,
+                                        (ipInfo.ip.addr >> 24) & 0xff);
+        strcat(postBuf, tempStr);
+
+        unsigned char wifiSsidBase64[64];
+        size_t encLen = 0;
+        int result = mbedtls_base64_encode(wifiSsidBase64, sizeof(wifiSsidBase64) - 1, &encLen, (unsigned char *) t_device_wifi_ssid, strlen(t_device_wifi_ssid));
+        if( result == 0 ) {
+            wifiSsidBase64[encLen] = 0x00;
+
+            sprintf(tempStr, ",\"SSID\":\"%s\"", (char *) wifiSsidBase64);
+            strcat(postBuf, tempStr);
+        }
+
+        sprintf(tempStr, ",\"BSSID\":\"%02X:%02X:%02X:%02X:%02X:%02X\"",
+                                                            t_device_wifi_bssid[0],
+                                                            t_device_wifi_bssid[1],
+                                                            t_device_wifi_bssid[2],
+                                                            t_device_wifi_bssid[3],
+                                                            t_device_wifi_bssid[4],
+                                                            t_device_wifi_bssid[5]);
+        strcat(postBuf, tempStr);
+
+        sprintf(tempStr, ",\"rssi\":%d}", app_wifi_get_rssi());
+        strcat(postBuf, tempStr);
+
+        app_wifi_stats_t wifiStats;
+        app_wifi_get_stats(&wifiStats);
+        sprintf(tempStr, ",\"wifi\":{\"reconnects\":%u,\"fast\":%u,\"scanned\":%u,"
+                         "\"last_ms\":%u,\"fast_ms\":%u,\"scan_ms\":%u,"
+                         "\"roams\":%u,\"roam_scans\":%u,\"roam_ms\":%u,\"roam_fails\":%u,"
+                         "\"rssi_min\":%d,\"rssi_avg\":%d,\"rssi_max\":%d,\"rssi_hist\":[",
+                                                            wifiStats.reconnects,
+                                                            wifiStats.fast,
+                                                            wifiStats.scanned,
+                                                            wifiStats.lastTime,
+                                                            wifiStats.fastTime,
+                                                            wifiStats.scanTime,
+                                                            wifiStats.roams,
+                                                            wifiStats.roamScans,
+                                                            wifiStats.roamTime,
+                                                            wifiStats.roamFails,
+                                                            wifiStats.rssiMin,
+                                                            wifiStats.rssiAvg,
+                                                            wifiStats.rssiMax);
+        strcat(postBuf, tempStr);
+        for( uint8_t hIdx = 0; hIdx < wifiStats.rssiCount; hIdx++ ) {
+
+            sprintf(tempStr, "%s%d", hIdx > 0 ? "," : "", wifiStats.rssiHistory[hIdx]);
+            strcat(postBuf, tempStr);
+        }
+        strcat(postBuf, "]}");
+
+        relay_stats_t relayStats;
+        relay_get_stats(&relayStats);
+        sprintf(tempStr, ",\"relay\":{\"pulses\":%u,\"dropped\":%u,\"wait_last\":%u,\"wait_max\":%u}",
+                                                            relayStats.pulses,
+                                                            relayStats.dropped,
+                                                            (uint32_t) (relayStats.lastQueueWait / 1000),
+                                                            (uint32_t) (relayStats.maxQueueWait / 1000));
+        strcat(postBuf, tempStr);
+
+        otp_stats_t otpStats;
+        cmd_get_otp_stats(&otpStats);
+        sprintf(tempStr, ",\"otp\":{\"replay_hits\":%u,\"replay_misses\":%u,\"replay_full\":%u}",
+                                                            otpStats.replayHits,
+                                                            otpStats.replayMisses,
+                                                            otpStats.replayFull);
+        strcat(postBuf, tempStr);
+
+        rate_limit_stats_t rateStats;
+        rate_limit_get_stats(&rateStats);
+        sprintf(tempStr, ",\"rate_limit\":{\"admitted\":%u,\"drop_sender\":%u,\"drop_global\":%u,\"checked\":%u,"
+                         "\"verified\":%u}",
+                                                            rateStats.admitted,
+                                                            rateStats.droppedSender,
+                                                            rateStats.droppedGlobal,
+                                                            rateStats.checked,
+                                                            rateStats.verified);
+        strcat(postBuf, tempStr);
+
+        mqtt_reasm_stats_t reasmStats;
+        mqtt_get_reasm_stats(&reasmStats);
+        sprintf(tempStr, ",\"reasm\":{\"fragmented\":%u,\"oversized\":%u,\"broken\":%u}",
+                                                            reasmStats.fragmented,
+                                                            reasmStats.oversized,
+                                                            reasmStats.broken);
+        strcat(postBuf, tempStr);
+
+        tls_session_stats_t tlsStats;
+        tls_session_get_stats(&tlsStats);
+        sprintf(tempStr, ",\"tls\":{\"handshakes\":%u,\"resumed\":%u,\"hit_rate\":%u,\"failed\":%u,"
+                         "\"last_ms\":%u,\"full_ms\":%u,\"resumed_ms\":%u,\"suite\":\"%s\",\"key\":\"%s\"}",
+                                                            tlsStats.handshakes,
+                                                            tlsStats.resumed,
+                                                            tlsStats.handshakes > 0 ? tlsStats.resumed * 100 / tlsStats.handshakes : 0,
+                                                            tlsStats.failed,
+                                                            tlsStats.lastTime,
+                                                            tlsStats.fullTime,
+                                                            tlsStats.resumedTime,
+                                                            tlsStats.suite != NULL ? tlsStats.suite : "",
+                                                            tlsStats.key != NULL ? tlsStats.key : "");
+        strcat(postBuf, tempStr);
+
+        sprintf(tempStr, ",\"boot\":{\"time_src\":\"%s\",\"time_ok\":%s", boot_time_source_name(),
+                                                            app_wifi_time_confirmed() ? "true" : "false");
+        strcat(postBuf, tempStr);
+        for( uint8_t phase = 0; phase < BOOT_PHASE_COUNT; phase++ ) {
+
+            sprintf(tempStr, ",\"%s\":%d", boot_phase_name(phase), boot_get_phase(phase));
+            strcat(postBuf, tempStr);
+        }
+        strcat(postBuf, "}");
+
+        t_gpio_stats_t gpioStats;
+        t_gpio_get_stats(&gpioStats);
+        sprintf(tempStr, ",\"gpio\":{\"wakeups\":%u,\"per_min\":%u,\"late_avg\":%u,\"late_max\":%u}",
+                                                            gpioStats.wakeups,
+                                                            gpioStats.perMinute,
+                                                            gpioStats.lateAvg,
+                                                            gpioStats.lateMax);
+        strcat(postBuf, tempStr);
+
+        periodical_stats_t jobStats[PERIODICAL_MAX_JOBS];
+        uint8_t jobCount = periodical_get_stats(jobStats, PERIODICAL_MAX_JOBS);
+        strcat(postBuf, ",\"jobs\":{");
+        for( uint8_t jIdx = 0; jIdx < jobCount; jIdx++ ) {
+
+            sprintf(tempStr, "%s\"%s\":{\"n\":%u,\"run\":%u,\"run_max\":%u,\"late\":%u,\"late_max\":%u,\"over\":%u}",
+                                                            jIdx > 0 ? "," : "",
+                                                            jobStats[jIdx].name,
+                                                            jobStats[jIdx].runs,
+                                                            jobStats[jIdx].lastRuntime,
+                                                            jobStats[jIdx].maxRuntime,
+                                                            jobStats[jIdx].lastLateness,
+                                                            jobStats[jIdx].maxLateness,
+                                                            jobStats[jIdx].overruns);
+            strcat(postBuf, tempStr);
+        }
+        strcat(postBuf, "}");
+
+        sysmon_stats_t sysStats;
+        sysmon_get_stats(&sysStats);
+        sprintf(tempStr, ",\"heap\":{\"free\":%u,\"free_min\":%u,\"free_max\":%u,\"lowest\":%u,\"block\":%u,\"block_min\":%u,\"frag\":%u,\"frag_max\":%u}",
+                                                            sysStats.free,
+                                                            sysStats.freeMin,
+                                                            sysStats.freeMax,
+                                                            sysStats.lowest,
+                                                            sysStats.largest,
+                                                            sysStats.largestMin,
+                                                            sysStats.frag,
+                                                            sysStats.fragMax);
+        strcat(postBuf, tempStr);
+
+        static sysmon_task_stats_t taskStats[SYSMON_MAX_TASKS];
+        uint8_t taskCount = sysmon_get_task_stats(taskStats, SYSMON_MAX_TASKS);
+        strcat(postBuf, ",\"tasks\":{");
+        for( uint8_t tIdx = 0; tIdx < taskCount; tIdx++ ) {
+
+            sprintf(tempStr, "%s\"%.15s\":[%u,%u,%u]",
+                                                            tIdx > 0 ? "," : "",
+                                                            taskStats[tIdx].name,
+                                                            taskStats[tIdx].cpu,
+                                                            taskStats[tIdx].cpuMax,
+                                                            taskStats[tIdx].stackFree);
+            strcat(postBuf, tempStr);
+        }
+        strcat(postBuf, "}");
+
+        static netmon_stats_t netStats;
+        netmon_get_stats(&netStats);
+        sprintf(tempStr, ",\"net\":{\"connects\":%u,\"disconnects\":%u,\"failed\":%u,\"report_drops\":%u,"
+                         "\"ping\":{\"n\":%u,\"lost\":%u,\"last\":%u,\"min\":%u,\"avg\":%u,\"max\":%u},",
+                                                            netStats.connects,
+                                                            netStats.disconnects,
+                                                            netStats.failed,
+                                                            mqtt_get_report_drops(),
+                                                            netStats.ping.count,
+                                                            netStats.pingsLost,
+                                                            netStats.ping.last,
+                                                            netStats.ping.min,
+                                                            netStats.ping.avg,
+                                                            netStats.ping.max);
+        strcat(postBuf, tempStr);
+        sprintf(tempStr, "\"connect\":{\"n\":%u,\"last\":%u,\"min\":%u,\"avg\":%u,\"max\":%u},\"reasons\":{",
+                                                            netStats.connect.count,
+                                                            netStats.connect.last,
+                                                            netStats.connect.min,
+                                                            netStats.connect.avg,
+                                                            netStats.connect.max);
+        strcat(postBuf, tempStr);
+        for( uint8_t reason = 0; reason < NETMON_REASON_COUNT; reason++ ) {
+
+            sprintf(tempStr, "%s\"%s\":%u", reason > 0 ? "," : "", netmon_reason_name(reason), netStats.reasons[reason]);
+            strcat(postBuf, tempStr);
+        }
+        strcat(postBuf, "},\"outages\":[");
+        for( uint8_t oIdx = 0; oIdx < netStats.outageCount; oIdx++ ) {
+
+            sprintf(tempStr, "%s[%u,\"%s\",%d,%s]",
+                                                            oIdx > 0 ? "," : "",
+                                                            netStats.outages[oIdx].at,
+                                                            netmon_reason_name(netStats.outages[oIdx].reason),
+                                                            netStats.outages[oIdx].detail,
+                                                            netStats.outages[oIdx].failed ? "true" : "false");
+            strcat(postBuf, tempStr);
+        }
+        strcat(postBuf, "],\"topics\":{");
+        for( uint8_t topic = 0; topic < NETMON_TOPIC_COUNT; topic++ ) {
+
+            sprintf(tempStr, "%s\"%s\":[%u,%u,%u,%u]",
+                                                            topic > 0 ? "," : "",
+                                                            netmon_topic_name(topic),
+                                                            netStats.topics[topic].inMsgs,
+                                                            netStats.topics[topic].inBytes,
+                                                            netStats.topics[topic].outMsgs,
+                                                            netStats.topics[topic].outBytes);
+            strcat(postBuf, tempStr);
+        }
+        strcat(postBuf, "}}");
+
+        strcat(postBuf, ",\"latency\":{");
+        for( uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++ ) {
+
+            latency_summary_t summary;
+            latency_get_summary(stage, &summary);
+            sprintf(tempStr, "%s\"%s\":{\"n\":%u,\"p50\":%u,\"p95\":%u,\"p99\":%u,\"max\":%u}",
+                                                            stage > 0 ? "," : "",
+                                                            latency_stage_name(stage),
+                                                            summary.count,
+                                                            summary.p50,
+                                                            summary.p95,
+                                                            summary.p99,
+                                                            summary.max);
+            strcat(postBuf, tempStr);
+        }
+        strcat(postBuf, "}");
+
+        strcat(postBuf, "}");
+
+        postLen = strlen(postBuf);
+        if( postLen < bufSize ) {
+            memcpy(buf, postBuf, postLen + 1);
+        } else {
+            postLen = 0;
+        }
+
+        UTIL_FREE(postBuf);
+    }
+
+    return(postLen);
+}
+
+
+static void bench_report_job(void)
+{
+}
+
+
+static void bench_report_idle_task(void *arg)
+{
+    vTaskSuspend(NULL);
+}
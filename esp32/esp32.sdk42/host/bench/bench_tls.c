@@ -0,0 +1,391 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include "bench_common.h"
+
+// Note: mutual TLS 1.2 handshakes between a client with the settings of the firmware,
+//       the cipher suites of tls_session.c and P-256 first, and a local server thread
+//       playing the broker, over a socketpair. the keys and certificates are made at start.
+//
+//       the time and the heap are those of the client side only: its CPU time, which
+//       on the device is the time the handshake keeps the CPU busy, and the peak of
+//       the memory allocated by OpenSSL on the client thread. the host numbers are not
+//       the ESP32 ones, the ratio between RSA and ECDSA is what carries over
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define BENCH_TLS_ITERATIONS                50
+#define BENCH_TLS_ALLOC_HEADER              16      // keeps the size, and the malloc alignment
+
+// the same order as tls_session_ciphersuites[] in main/tls_session.c
+#define BENCH_TLS_CIPHERS                   "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-ECDSA-AES128-SHA256:" \
+                                            "ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES128-GCM-SHA256:" \
+                                            "ECDHE-RSA-AES128-SHA256:ECDHE-RSA-AES256-GCM-SHA384:" \
+                                            "AES128-GCM-SHA256:AES128-SHA256"
+#define BENCH_TLS_GROUPS                    "P-256:P-384"
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct {
+    EVP_PKEY *key;
+    X509 *cert;
+} bench_tls_identity_t;
+
+typedef struct {
+    SSL_CTX *ctx;
+    int sock;
+    bool passed;
+} bench_tls_server_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static __thread bool bench_tls_tracking = false;
+static int64_t bench_tls_live = 0;
+static int64_t bench_tls_peak = 0;
+static uint64_t bench_tls_allocs = 0;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local functions
+static void *bench_tls_malloc(size_t size, const char *file, int line);
+static void *bench_tls_realloc(void *ptr, size_t size, const char *file, int line);
+static void bench_tls_free(void *ptr, const char *file, int line);
+static void bench_tls_track(int64_t delta);
+static EVP_PKEY *bench_tls_keygen(bool ec);
+static X509 *bench_tls_cert(EVP_PKEY *key, const char *name, const bench_tls_identity_t *issuer);
+static SSL_CTX *bench_tls_ctx(bool server, const bench_tls_identity_t *identity, X509 *const *cas, int caCount);
+static void *bench_tls_server_task(void *arg);
+static uint64_t bench_tls_cpu_ns(void);
+
+///////////////////////////////////////////////////////////////////////////////////
+// MAIN
+// full handshakes with an RSA-2048 and an ECDSA P-256 client identity, against an RSA and an ECC broker
+int main(int argc, char *argv[])
+{
+    // before anything is allocated by OpenSSL
+    if( !CRYPTO_set_mem_functions(bench_tls_malloc, bench_tls_realloc, bench_tls_free) ) {
+        printf("unable to set the OpenSSL allocator\n");
+        return(EXIT_FAILURE);
+    }
+
+    // a side may still write its close_notify after the other one closed
+    signal(SIGPIPE, SIG_IGN);
+
+    // an RSA root for the RSA broker, as Amazon Root CA 1, and an ECC one, as Amazon Root CA 3
+    bench_tls_identity_t rsaCa = { bench_tls_keygen(false), NULL };
+    bench_tls_identity_t ecCa = { bench_tls_keygen(true), NULL };
+    rsaCa.cert = bench_tls_cert(rsaCa.key, "rsa root", NULL);
+    ecCa.cert = bench_tls_cert(ecCa.key, "ecc root", NULL);
+    X509 *cas[] = { rsaCa.cert, ecCa.cert };
+
+    bench_tls_identity_t rsaBroker = { bench_tls_keygen(false), NULL };
+    bench_tls_identity_t ecBroker = { bench_tls_keygen(true), NULL };
+    bench_tls_identity_t rsaClient = { bench_tls_keygen(false), NULL };
+    bench_tls_identity_t ecClient = { bench_tls_keygen(true), NULL };
+    rsaBroker.cert = bench_tls_cert(rsaBroker.key, "localhost", &rsaCa);
+    ecBroker.cert = bench_tls_cert(ecBroker.key, "localhost", &ecCa);
+    rsaClient.cert = bench_tls_cert(rsaClient.key, "TT-RSA", &rsaCa);
+    ecClient.cert = bench_tls_cert(ecClient.key, "TT-ECC", &rsaCa);
+
+    const struct {
+        const char *client;
+        const char *broker;
+        const bench_tls_identity_t *clientId;
+        const bench_tls_identity_t *brokerId;
+        const char *expected;           // the key exchange the suite must start with
+    } cases[] = {
+        { "RSA-2048",   "RSA",  &rsaClient, &rsaBroker, "ECDHE-RSA" },
+        { "P-256",      "RSA",  &ecClient,  &rsaBroker, "ECDHE-RSA" },
+        { "P-256",      "ECC",  &ecClient,  &ecBroker,  "ECDHE-ECDSA" },
+    };
+
+    int failures = 0;
+
+    printf("%-8s %-6s %-30s %8s %8s %10s %8s\n", "client", "broker", "suite", "ms", "cpu ms", "peak heap", "allocs");
+
+    for( size_t cIdx = 0; cIdx < sizeof(cases) / sizeof(cases[0]); cIdx++ ) {
+
+        SSL_CTX *clientCtx = bench_tls_ctx(false, cases[cIdx].clientId, cas, 2);
+        bench_tls_server_t server = { bench_tls_ctx(true, cases[cIdx].brokerId, cas, 2), -1, false };
+
+        uint64_t wallTotal = 0;
+        uint64_t cpuTotal = 0;
+        int64_t peak = 0;
+        uint64_t allocs = 0;
+        char suite[64] = "-";
+        bool passed = true;
+
+        for( uint32_t iter = 0; iter < BENCH_TLS_ITERATIONS && passed; iter++ ) {
+
+            int socks[2];
+            if( socketpair(AF_UNIX, SOCK_STREAM, 0, socks) != 0 ) {
+                passed = false;
+                break;
+            }
+
+            server.sock = socks[1];
+            pthread_t serverThread;
+            pthread_create(&serverThread, NULL, bench_tls_server_task, &server);
+
+            // the client side, from SSL_new() to the end of the handshake
+            __atomic_store_n(&bench_tls_live, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&bench_tls_peak, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&bench_tls_allocs, 0, __ATOMIC_RELAXED);
+            bench_tls_tracking = true;
+
+            uint64_t wallStart = bench_now_ns();
+            uint64_t cpuStart = bench_tls_cpu_ns();
+
+            SSL *ssl = SSL_new(clientCtx);
+            SSL_set_fd(ssl, socks[0]);
+            SSL_set_tlsext_host_name(ssl, "localhost");
+            SSL_set1_host(ssl, "localhost");
+            passed = SSL_connect(ssl) == 1;
+
+            cpuTotal += bench_tls_cpu_ns() - cpuStart;
+            wallTotal += bench_now_ns() - wallStart;
+
+            bench_tls_tracking = false;
+            allocs += __atomic_load_n(&bench_tls_allocs, __ATOMIC_RELAXED);
+            if( __atomic_load_n(&bench_tls_peak, __ATOMIC_RELAXED) > peak ) {
+                peak = __atomic_load_n(&bench_tls_peak, __ATOMIC_RELAXED);
+            }
+
+            if( passed ) {
+                snprintf(suite, sizeof(suite), "%s", SSL_get_cipher_name(ssl));
+                SSL_shutdown(ssl);
+            } else {
+                ERR_print_errors_fp(stdout);
+            }
+
+            SSL_free(ssl);
+            close(socks[0]);
+            pthread_join(serverThread, NULL);
+            close(socks[1]);
+
+            passed = passed && server.passed;
+        }
+
+        passed = passed && !strncmp(suite, cases[cIdx].expected, strlen(cases[cIdx].expected));
+
+        printf("%-8s %-6s %-30s %8.2f %8.2f %10lld %8.1f%s\n", cases[cIdx].client, cases[cIdx].broker, suite,
+               (double) wallTotal / BENCH_TLS_ITERATIONS / 1e6,
+               (double) cpuTotal / BENCH_TLS_ITERATIONS / 1e6,
+               (long long) peak,
+               (double) allocs / BENCH_TLS_ITERATIONS,
+               passed ? "" : "  FAIL");
+
+        if( !passed ) {
+            failures++;
+        }
+
+        SSL_CTX_free(clientCtx);
+        SSL_CTX_free(server.ctx);
+    }
+
+    const bench_tls_identity_t *identities[] = { &rsaCa, &ecCa, &rsaBroker, &ecBroker, &rsaClient, &ecClient };
+    for( size_t iIdx = 0; iIdx < sizeof(identities) / sizeof(identities[0]); iIdx++ ) {
+        X509_free(identities[iIdx]->cert);
+        EVP_PKEY_free(identities[iIdx]->key);
+    }
+
+    return(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+/**
+ * the OpenSSL allocator, the size is kept in front of the block so a free is accounted too
+ */
+static void *bench_tls_malloc(size_t size, const char *file, int line)
+{
+    uint8_t *block = malloc(BENCH_TLS_ALLOC_HEADER + size);
+    if( block == NULL ) {
+        return(NULL);
+    }
+
+    *(size_t *) block = size;
+    block[sizeof(size_t)] = bench_tls_tracking;
+    if( bench_tls_tracking ) {
+        __atomic_add_fetch(&bench_tls_allocs, 1, __ATOMIC_RELAXED);
+        bench_tls_track((int64_t) size);
+    }
+
+    return(block + BENCH_TLS_ALLOC_HEADER);
+}
+
+
+static void *bench_tls_realloc(void *ptr, size_t size, const char *file, int line)
+{
+    if( ptr == NULL ) {
+        return(bench_tls_malloc(size, file, line));
+    }
+
+    uint8_t *block = (uint8_t *) ptr - BENCH_TLS_ALLOC_HEADER;
+    size_t oldSize = *(size_t *) block;
+    bool tracked = block[sizeof(size_t)];
+
+    block = realloc(block, BENCH_TLS_ALLOC_HEADER + size);
+    if( block == NULL ) {
+        return(NULL);
+    }
+
+    *(size_t *) block = size;
+    if( tracked ) {
+        __atomic_add_fetch(&bench_tls_allocs, 1, __ATOMIC_RELAXED);
+        bench_tls_track((int64_t) size - (int64_t) oldSize);
+    }
+
+    return(block + BENCH_TLS_ALLOC_HEADER);
+}
+
+
+static void bench_tls_free(void *ptr, const char *file, int line)
+{
+    if( ptr == NULL ) {
+        return;
+    }
+
+    uint8_t *block = (uint8_t *) ptr - BENCH_TLS_ALLOC_HEADER;
+    if( block[sizeof(size_t)] ) {
+        bench_tls_track(-(int64_t) *(size_t *) block);
+    }
+
+    free(block);
+}
+
+
+static void bench_tls_track(int64_t delta)
+{
+    int64_t live = __atomic_add_fetch(&bench_tls_live, delta, __ATOMIC_RELAXED);
+    int64_t peak = __atomic_load_n(&bench_tls_peak, __ATOMIC_RELAXED);
+
+    while( live > peak && !__atomic_compare_exchange_n(&bench_tls_peak, &peak, live, false,
+                                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED) ) {
+    }
+}
+
+
+static EVP_PKEY *bench_tls_keygen(bool ec)
+{
+    if( ec ) {
+        return(EVP_PKEY_Q_keygen(NULL, NULL, "EC", "P-256"));
+    }
+
+    return(EVP_PKEY_Q_keygen(NULL, NULL, "RSA", (size_t) 2048));
+}
+
+
+/**
+ * a certificate for key, self-signed if there is no issuer
+ */
+static X509 *bench_tls_cert(EVP_PKEY *key, const char *name, const bench_tls_identity_t *issuer)
+{
+    X509 *cert = X509_new();
+
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), (long) time(NULL) ^ (long) (intptr_t) key);
+    X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME_add_entry_by_txt(X509_get_subject_name(cert), "CN", MBSTRING_ASC, (const unsigned char *) name, -1, -1, 0);
+
+    if( issuer == NULL ) {
+
+        X509_set_issuer_name(cert, X509_get_subject_name(cert));
+        X509_EXTENSION *ext = X509V3_EXT_conf_nid(NULL, NULL, NID_basic_constraints, "critical,CA:TRUE");
+        X509_add_ext(cert, ext, -1);
+        X509_EXTENSION_free(ext);
+        X509_sign(cert, key, EVP_sha256());
+
+    } else {
+
+        X509_set_issuer_name(cert, X509_get_subject_name(issuer->cert));
+        X509_sign(cert, issuer->key, EVP_sha256());
+    }
+
+    return(cert);
+}
+
+
+/**
+ * TLS 1.2 with a client certificate, the same as the device and AWS IoT
+ */
+static SSL_CTX *bench_tls_ctx(bool server, const bench_tls_identity_t *identity, X509 *const *cas, int caCount)
+{
+    SSL_CTX *ctx = SSL_CTX_new(server ? TLS_server_method() : TLS_client_method());
+
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_max_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+    SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+    SSL_CTX_use_certificate(ctx, identity->cert);
+    SSL_CTX_use_PrivateKey(ctx, identity->key);
+
+    X509_STORE *store = SSL_CTX_get_cert_store(ctx);
+    for( int caIdx = 0; caIdx < caCount; caIdx++ ) {
+        X509_STORE_add_cert(store, cas[caIdx]);
+    }
+
+    if( server ) {
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, NULL);
+    } else {
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, NULL);
+        SSL_CTX_set_cipher_list(ctx, BENCH_TLS_CIPHERS);
+        SSL_CTX_set1_groups_list(ctx, BENCH_TLS_GROUPS);
+    }
+
+    return(ctx);
+}
+
+
+static void *bench_tls_server_task(void *arg)
+{
+    bench_tls_server_t *server = arg;
+
+    SSL *ssl = SSL_new(server->ctx);
+    SSL_set_fd(ssl, server->sock);
+    server->passed = SSL_accept(ssl) == 1;
+
+    if( server->passed ) {
+        // the close_notify of the client
+        char byte;
+        SSL_read(ssl, &byte, 1);
+        SSL_shutdown(ssl);
+    }
+
+    SSL_free(ssl);
+
+    return(NULL);
+}
+
+
+static uint64_t bench_tls_cpu_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    return((uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
@@ -0,0 +1,1051 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mbedtls/aes.h"
+#include "driver/gpio.h"
+#include "mqtt_client.h"
+#include "host_shim.h"
+
+#include "open_tls.h"
+#include "util.h"
+#include "cmd.h"
+#include "cmd_parser.h"
+#include "relay.h"
+#include "cmd_sched.h"
+#include "rate_limit.h"
+#include "latency.h"
+#include "boot.h"
+#include "app_wifi.h"
+#include "mqtt.h"
+#include "t_gpio.h"
+#include "button.h"
+#include "periodical.h"
+#include "sysmon.h"
+#include "netmon.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define HOST_MAIN_EDGE_TIMEOUT              3000000     // in us
+#define HOST_MAIN_NO_EDGE_WAIT              1500000     // in us
+#define HOST_MAIN_STALE_OTP_AGE             60          // in seconds
+#define HOST_MAIN_DELAY_TOLERANCE           20000       // in us, one tick plus host scheduling
+#define HOST_MAIN_CLOCK_STEP                ((int64_t) 7200 * 1000000)  // in us, an SNTP step of the wall clock
+#define HOST_MAIN_FLOOD_INTERVAL            500         // in us, 2000 junk messages per second
+#define HOST_MAIN_FLOOD_CHECKED_INTERVAL    20000       // in us, 50 per second, every OTP over the limits is checked
+#define HOST_MAIN_FLOOD_SETTLE              2000        // in ms, the flood empties the buckets first
+#define HOST_MAIN_FLOOD_BUDGET              100000      // in us, publish to relay rising edge during the flood
+#define HOST_MAIN_PULSE_TOLERANCE           10000       // in us, pulse width error allowed for host scheduling
+#define HOST_MAIN_LARGE_PAD                 (5 * 1024)  // in bytes, three fragments of the 2 KB MQTT buffer
+#define HOST_MAIN_DROP_TIME                 500         // in ms, the device is away this long
+#define HOST_MAIN_PRESENCE_TIMEOUT          2000000     // in us
+#define HOST_MAIN_BUTTON_BUDGET             20000       // in us, button press to LED2 on
+#define HOST_MAIN_MAX_LATENESS              20000       // in us, from a job deadline to the job
+#define HOST_MAIN_IDLE_TIME                 10000       // in ms, the gpio task is left alone this long
+#define HOST_MAIN_MAX_IDLE_WAKEUPS          30          // per minute, the 250 ms poll was 240
+#define HOST_MAIN_JOB_PERIOD                100         // in ms, the test job
+#define HOST_MAIN_JOB_SLOW_RUN              3           // this run of the test job takes longer than a period
+#define HOST_MAIN_JOB_TIME                  1500        // in ms, the test job is watched this long
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+// where the junk of host_main_flood() is published
+typedef enum {
+    HOST_MAIN_FLOOD_OWN_TOPIC = 0,      // a sub-topic of its own, the phone on another one
+    HOST_MAIN_FLOOD_ROTATE,             // a new sub-topic for every message, the phone on the command topic
+    HOST_MAIN_FLOOD_SHARED,             // the command topic, the one the phone publishes on
+    HOST_MAIN_FLOOD_REPLAY              // a captured command with a valid OTP, again and again, there too
+} host_main_flood_mode_t;
+
+typedef struct {
+    const char *name;
+    cmd_action_code_t action;
+    int32_t otpAge;                     // in seconds, how old the OTP timestamp is
+    bool frame;                         // binary command frame instead of JSON
+    bool replay;                        // publish the previous message again
+    int expectedGpio;                   // -1 if no relay pulse is expected
+} host_main_step_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static const host_main_step_t host_main_script[] = {
+    { "OPEN",           CMD_ACTION_OPEN,            0,                          false,  false,  OPEN_TLS_HW_DOOR_OPEN },
+    { "STOP",           CMD_ACTION_STOP,            0,                          false,  false,  OPEN_TLS_HW_DOOR_STOP },
+    { "STOP (replay)",  CMD_ACTION_STOP,            0,                          false,  true,   -1 },
+    { "CLOSE",          CMD_ACTION_CLOSE,           0,                          false,  false,  OPEN_TLS_HW_DOOR_CLOSE },
+    { "OPEN (stale)",   CMD_ACTION_OPEN,            HOST_MAIN_STALE_OTP_AGE,    false,  false,  -1 },
+    { "OPEN (future)",  CMD_ACTION_OPEN,            -HOST_MAIN_STALE_OTP_AGE,   false,  false,  -1 },
+    { "FORCE_REPORT",   CMD_ACTION_FORCE_REPORT,    0,                          false,  false,  -1 },
+    { "LATENCY_REPORT", CMD_ACTION_LATENCY_REPORT,  0,                          true,   false,  -1 },
+    { "OPEN (frame)",   CMD_ACTION_OPEN,            0,                          true,   false,  OPEN_TLS_HW_DOOR_OPEN },
+    { "CLOSE (frame)",  CMD_ACTION_CLOSE,           0,                          true,   false,  OPEN_TLS_HW_DOOR_CLOSE },
+    { "CLOSE (replay)", CMD_ACTION_CLOSE,           0,                          true,   true,   -1 },
+    { "STALE (frame)",  CMD_ACTION_OPEN,            HOST_MAIN_STALE_OTP_AGE,    true,   false,  -1 },
+};
+
+static volatile bool host_main_phone_connected = false;
+static volatile uint32_t host_main_phone_reports = 0;
+static volatile uint32_t host_main_phone_online = 0;
+static volatile uint32_t host_main_phone_offline = 0;
+static volatile bool host_main_phone_online_retained = false;
+static volatile bool host_main_noisy_connected = false;
+static volatile bool host_main_flood_running = false;
+static volatile uint32_t host_main_flood_sent = 0;
+static volatile host_main_flood_mode_t host_main_flood_mode = HOST_MAIN_FLOOD_OWN_TOPIC;
+static volatile uint32_t host_main_flood_interval = HOST_MAIN_FLOOD_INTERVAL;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local functions
+static esp_err_t host_main_phone_event_handler(esp_mqtt_event_handle_t event);
+static void host_main_build_otp(uint8_t *otpAuth, int32_t otpAge);
+static int host_main_build_command(char *msg, size_t msgSize, cmd_action_code_t action, int32_t otpAge, bool frame);
+static bool host_main_wait_pulse(uint32_t edgesBefore, int gpio, int64_t timeout, int64_t *rise, int64_t *fall);
+static bool host_main_pulse_width_ok(int64_t rise, int64_t fall);
+static bool host_main_burst(esp_mqtt_client_handle_t phone);
+static bool host_main_delayed(esp_mqtt_client_handle_t phone);
+static bool host_main_flood(esp_mqtt_client_handle_t phone, host_main_flood_mode_t mode);
+static bool host_main_large(esp_mqtt_client_handle_t phone);
+static bool host_main_presence(esp_mqtt_client_handle_t phone);
+static bool host_main_gpio_task(void);
+static bool host_main_periodical(void);
+static bool host_main_sysmon(void);
+static bool host_main_netmon(void);
+static void host_main_test_job(void);
+static bool host_main_wait_count(volatile uint32_t *count, uint32_t target, int64_t *at);
+static esp_err_t host_main_noisy_event_handler(esp_mqtt_event_handle_t event);
+static void host_main_flood_task(void *arg);
+
+///////////////////////////////////////////////////////////////////////////////////
+// MAIN
+// drives mqtt_handle_received_control_message -> cmd_add -> cmd_loop -> cmd_perform
+// through the broker and checks the relay pulses on the recorded GPIO edges
+int main(int argc, char *argv[])
+{
+    if( getenv("OPEN_TLS_HOST_VERBOSE") == NULL ) {
+        esp_log_level_set("*", ESP_LOG_WARN);
+    }
+
+    esp_timer_get_time();
+    esp_read_mac(t_device_MAC, ESP_MAC_WIFI_STA);
+    sprintf(t_device_sn_str, "TT-%02X%02X%02X%02X%02X%02X", t_device_MAC[0],
+                                                            t_device_MAC[1],
+                                                            t_device_MAC[2],
+                                                            t_device_MAC[3],
+                                                            t_device_MAC[4],
+                                                            t_device_MAC[5]);
+
+    // the device side, the same order as app_main
+    TaskHandle_t gpioTask;
+    t_gpio_init();
+    button_init();
+    xTaskCreate(&t_gpio_task, "gpio_task", 4608, NULL, 1, &gpioTask);
+
+    app_wifi_time_restore();
+    app_wifi_initialise();
+    app_wifi_ntp_init();
+    if( !app_wifi_time_valid() ) {
+        app_wifi_preconnect(OPEN_TLS_MQTT_BROKER);
+        app_wifi_ntp_wait();
+    }
+    periodical_init();
+    sysmon_init();
+    cmd_init();
+    mqtt_init();
+
+    // the phone side, publishes the commands to the device
+    esp_mqtt_client_config_t phoneCfg = {
+        .event_handle = host_main_phone_event_handler,
+        .client_id = "host-phone",
+    };
+    esp_mqtt_client_handle_t phone = esp_mqtt_client_init(&phoneCfg);
+    esp_mqtt_client_start(phone);
+
+    while( !host_main_phone_connected ) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    printf("%-16s %12s %12s %12s\n", "command", "latency(us)", "pulse(us)", "result");
+
+    int failures = 0;
+    char msg[128];
+    int msgLen = 0;
+
+    for( size_t sIdx = 0; sIdx < sizeof(host_main_script) / sizeof(host_main_script[0]); sIdx++ ) {
+
+        const host_main_step_t *step = &host_main_script[sIdx];
+        host_gpio_edge_t edges[HOST_GPIO_EDGE_LOG_SIZE];
+
+        if( !step->replay ) {
+            msgLen = host_main_build_command(msg, sizeof(msg), step->action, step->otpAge, step->frame);
+        }
+
+        uint32_t edgesBefore = host_gpio_edge_get(edges, HOST_GPIO_EDGE_LOG_SIZE);
+        int64_t publishTime = esp_timer_get_time();
+        esp_mqtt_client_publish(phone, OPEN_TLS_MQTT_TOPIC, msg, msgLen, 0, 0);
+
+        int64_t rise = 0;
+        int64_t fall = 0;
+        bool pulsed = host_main_wait_pulse(edgesBefore, step->expectedGpio,
+                                           step->expectedGpio >= 0 ? HOST_MAIN_EDGE_TIMEOUT : HOST_MAIN_NO_EDGE_WAIT,
+                                           &rise, &fall);
+        bool passed = (step->expectedGpio >= 0) == pulsed;
+        if( pulsed && !host_main_pulse_width_ok(rise, fall) ) {
+            passed = false;
+        }
+
+        if( pulsed ) {
+            printf("%-16s %12lld %12lld %12s\n", step->name, (long long) (rise - publishTime),
+                                                 (long long) (fall - rise), passed ? "ok" : "FAIL");
+        } else {
+            printf("%-16s %12s %12s %12s\n", step->name, "-", "-", passed ? "ok" : "FAIL");
+        }
+
+        if( !passed ) {
+            failures++;
+        }
+    }
+
+    // FORCE_REPORT and LATENCY_REPORT are answered on the status topic
+    vTaskDelay(pdMS_TO_TICKS(100));
+    printf("reports: %u on the status topic\n", host_main_phone_reports);
+    if( host_main_phone_reports < 2 ) {
+        failures++;
+    }
+
+    // messages longer than the MQTT buffer arrive in fragments and are rebuilt
+    if( !host_main_large(phone) ) {
+        failures++;
+    }
+
+    // commands sent back to back are all taken at once, the pulses follow one another
+    if( !host_main_burst(phone) ) {
+        failures++;
+    }
+
+    // the delayed STOP is on time across a clock step, and a new command cancels the pending CLOSE
+    if( !host_main_delayed(phone) ) {
+        failures++;
+    }
+
+    // commands still get through while another sender floods the device, on its own
+    // topic, on a new topic for every message, and on the very topic of the phone,
+    // with junk or with a captured command replayed
+    for( host_main_flood_mode_t mode = HOST_MAIN_FLOOD_OWN_TOPIC; mode <= HOST_MAIN_FLOOD_REPLAY; mode++ ) {
+        if( !host_main_flood(phone, mode) ) {
+            failures++;
+        }
+    }
+
+    // the will tells the phone the device is gone, and it is back online after the reconnect
+    if( !host_main_presence(phone) ) {
+        failures++;
+    }
+
+    // the button is handled at once, and the gpio task sleeps when nothing happens
+    if( !host_main_gpio_task() ) {
+        failures++;
+    }
+
+    // a registered job runs on time, and a run longer than its period is counted as an overrun
+    if( !host_main_periodical() ) {
+        failures++;
+    }
+
+    // the task CPU and stack figures and the heap, as the device report sends them
+    if( !host_main_sysmon() ) {
+        failures++;
+    }
+
+    // the connections, the drop of the presence check and the traffic of every topic role
+    if( !host_main_netmon() ) {
+        failures++;
+    }
+
+    // the startup phases, the same figures as in the device report
+    printf("boot: time from %s", boot_time_source_name());
+    for( uint8_t phase = 0; phase < BOOT_PHASE_COUNT; phase++ ) {
+        printf(", %s %d ms", boot_phase_name(phase), boot_get_phase(phase));
+    }
+    printf("\n");
+    if( boot_get_phase(BOOT_PHASE_MQTT) < 0 ) {
+        failures++;
+    }
+
+    // where the time went, the same figures as in the device report
+    printf("\n%-16s %8s %8s %8s %8s %8s\n", "stage(us)", "n", "p50", "p95", "p99", "max");
+    for( uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++ ) {
+
+        latency_summary_t summary;
+        latency_get_summary(stage, &summary);
+        printf("%-16s %8u %8u %8u %8u %8u\n", latency_stage_name(stage), summary.count,
+                                             summary.p50, summary.p95, summary.p99, summary.max);
+    }
+
+    printf("\nrecorded GPIO edges\n");
+    host_gpio_edge_dump();
+
+    esp_mqtt_client_destroy(phone);
+
+    return(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+static esp_err_t host_main_phone_event_handler(esp_mqtt_event_handle_t event)
+{
+    if( event->event_id == MQTT_EVENT_CONNECTED ) {
+
+        // the reports and the presence of every device, as the app listens to them
+        esp_mqtt_client_subscribe(event->client, OPEN_TLS_MQTT_TOPIC "/status/+", 0);
+        esp_mqtt_client_subscribe(event->client, OPEN_TLS_MQTT_TOPIC "/presence/+", 1);
+        host_main_phone_connected = true;
+
+    } else if( event->event_id == MQTT_EVENT_DATA ) {
+
+        static const char presencePrefix[] = OPEN_TLS_MQTT_TOPIC "/presence/";
+        static const char online[] = "\"state\":\"online\"";
+        static const char offline[] = "\"state\":\"offline\"";
+        bool presence = event->topic_len >= (int) sizeof(presencePrefix) - 1 &&
+                        !memcmp(event->topic, presencePrefix, sizeof(presencePrefix) - 1);
+
+        if( presence ) {
+
+            if( memmem(event->data, event->data_len, online, sizeof(online) - 1) != NULL ) {
+                host_main_phone_online_retained = event->retain;
+                host_main_phone_online++;
+            } else if( memmem(event->data, event->data_len, offline, sizeof(offline) - 1) != NULL ) {
+                host_main_phone_offline++;
+            }
+
+        } else if( event->data_len >= 8 && !memcmp(event->data, "{\"TT_ID\"", 8) ) {
+            host_main_phone_reports++;
+        }
+    }
+
+    return(ESP_OK);
+}
+
+
+/**
+ * encrypt the OTP the same as the app does, with AES-128
+ */
+static void host_main_build_otp(uint8_t *otpAuth, int32_t otpAge)
+{
+    uint8_t plainText[16];
+    uint8_t aesKey[16];
+    uint32_t otpTime = (uint32_t) time(NULL) - otpAge;
+
+    // random1, otpTime, random3, random4[3], checksum
+    for( uint8_t pIdx = 0; pIdx < 15; pIdx++ ) {
+        plainText[pIdx] = (uint8_t) rand();
+    }
+    memcpy(plainText + 4, &otpTime, sizeof(otpTime));
+
+    plainText[15] = 0;
+    for( uint8_t pIdx = 0; pIdx < 15; pIdx++ ) {
+        plainText[15] += plainText[pIdx];
+    }
+
+    esp_aes_context aes;
+    esp_aes_init(&aes);
+    util_string_to_aes_key(OPEN_TLS_OTP_AES_KEY, aesKey);
+    esp_aes_setkey(&aes, aesKey, 128);
+    esp_aes_crypt_ecb(&aes, ESP_AES_ENCRYPT, plainText, otpAuth);
+    esp_aes_free(&aes);
+}
+
+
+/**
+ * build a JSON command or a binary command frame
+ *
+ * @return length of the message
+ */
+static int host_main_build_command(char *msg, size_t msgSize, cmd_action_code_t action, int32_t otpAge, bool frame)
+{
+    uint8_t otpAuth[16];
+    char otpStr[33];
+
+    host_main_build_otp(otpAuth, otpAge);
+
+    if( frame ) {
+        cmd_parser_frame_t *cmdFrame = (cmd_parser_frame_t *) msg;
+
+        cmdFrame->magic[0] = CMD_PARSER_FRAME_MAGIC_0;
+        cmdFrame->magic[1] = CMD_PARSER_FRAME_MAGIC_1;
+        cmdFrame->version = CMD_PARSER_FRAME_VERSION;
+        cmdFrame->action = action;
+        memcpy(cmdFrame->otpAuth, otpAuth, sizeof(otpAuth));
+
+        return(sizeof(cmd_parser_frame_t));
+    }
+
+    for( uint8_t cIdx = 0; cIdx < 16; cIdx++ ) {
+        sprintf(otpStr + cIdx * 2, "%02x", otpAuth[cIdx]);
+    }
+
+    return(snprintf(msg, msgSize, "{\"command\":%d,\"otp-auth\":\"%s\"}", action, otpStr));
+}
+
+
+/**
+ * wait for a complete pulse on the gpio after the given edge count
+ * if no pulse is expected (gpio < 0), make sure no edge shows up at all
+ *
+ * @return true if a pulse is found
+ */
+static bool host_main_wait_pulse(uint32_t edgesBefore, int gpio, int64_t timeout, int64_t *rise, int64_t *fall)
+{
+    static host_gpio_edge_t edges[HOST_GPIO_EDGE_LOG_SIZE];
+    int64_t deadline = esp_timer_get_time() + timeout;
+
+    while( esp_timer_get_time() < deadline ) {
+
+        uint32_t count = host_gpio_edge_get(edges, HOST_GPIO_EDGE_LOG_SIZE);
+
+        *rise = 0;
+        for( uint32_t eIdx = edgesBefore; eIdx < count; eIdx++ ) {
+            if( gpio >= 0 && edges[eIdx].gpio != gpio ) {
+                continue;
+            }
+
+            // LED2 blinks on every command, it is not a relay pulse
+            if( gpio < 0 && edges[eIdx].gpio == OPEN_TLS_HW_LED2 ) {
+                continue;
+            }
+
+            if( edges[eIdx].level ) {
+                *rise = edges[eIdx].timestamp;
+            } else if( *rise != 0 ) {
+                *fall = edges[eIdx].timestamp;
+                return(true);
+            }
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    return(false);
+}
+
+
+static bool host_main_pulse_width_ok(int64_t rise, int64_t fall)
+{
+    int64_t widthError = (fall - rise) - (int64_t) RELAY_PULSE_TIME * 1000;
+
+    return(widthError > -HOST_MAIN_PULSE_TOLERANCE && widthError < HOST_MAIN_PULSE_TOLERANCE);
+}
+
+
+/**
+ * publish OPEN and STOP without waiting in between
+ * both pulses must be complete and must not overlap
+ *
+ * @return true if passed
+ */
+static bool host_main_burst(esp_mqtt_client_handle_t phone)
+{
+    static host_gpio_edge_t edges[HOST_GPIO_EDGE_LOG_SIZE];
+    char msg[2][128];
+    int msgLen[2];
+
+    msgLen[0] = host_main_build_command(msg[0], sizeof(msg[0]), CMD_ACTION_OPEN, 0, false);
+    msgLen[1] = host_main_build_command(msg[1], sizeof(msg[1]), CMD_ACTION_STOP, 0, true);
+
+    uint32_t edgesBefore = host_gpio_edge_get(edges, HOST_GPIO_EDGE_LOG_SIZE);
+    int64_t publishTime = esp_timer_get_time();
+    esp_mqtt_client_publish(phone, OPEN_TLS_MQTT_TOPIC, msg[0], msgLen[0], 0, 0);
+    esp_mqtt_client_publish(phone, OPEN_TLS_MQTT_TOPIC, msg[1], msgLen[1], 0, 0);
+
+    int64_t openRise = 0, openFall = 0, stopRise = 0, stopFall = 0;
+    bool passed = host_main_wait_pulse(edgesBefore, OPEN_TLS_HW_DOOR_OPEN, HOST_MAIN_EDGE_TIMEOUT, &openRise, &openFall) &&
+                  host_main_wait_pulse(edgesBefore, OPEN_TLS_HW_DOOR_STOP, HOST_MAIN_EDGE_TIMEOUT, &stopRise, &stopFall);
+
+    if( passed ) {
+        passed = host_main_pulse_width_ok(openRise, openFall) &&
+                 host_main_pulse_width_ok(stopRise, stopFall) &&
+                 stopRise - openFall >= (int64_t) RELAY_PULSE_GAP_TIME * 1000;
+
+        printf("%-16s %12lld %12lld %12s\n", "OPEN+STOP", (long long) (openRise - publishTime),
+                                             (long long) (stopFall - openRise), passed ? "ok" : "FAIL");
+    } else {
+        printf("%-16s %12s %12s %12s\n", "OPEN+STOP", "-", "-", "FAIL");
+    }
+
+    return(passed);
+}
+
+
+/**
+ * publish OPEN_STOP_CLOSE and wait for the delayed STOP, with the wall clock stepped
+ * forward meanwhile and back after it, the CLOSE must not move either way
+ * then publish STOP, which must cancel the delayed CLOSE
+ * the latency of the delayed STOP is from its deadline
+ *
+ * @return true if passed
+ */
+static bool host_main_delayed(esp_mqtt_client_handle_t phone)
+{
+    static host_gpio_edge_t edges[HOST_GPIO_EDGE_LOG_SIZE];
+    const int64_t stopDelay = (int64_t) OPEN_TLS_DOOR_OPEN_STOP_CLOSE_TIMER_STOP * 1000000;
+    char msg[128];
+    int msgLen;
+
+    // let the relay layer go idle, the deadline is set when OPEN is performed, not when it pulses
+    vTaskDelay(pdMS_TO_TICKS(RELAY_PULSE_GAP_TIME * 2));
+
+    msgLen = host_main_build_command(msg, sizeof(msg), CMD_ACTION_OPEN_STOP_CLOSE, 0, false);
+
+    uint32_t edgesBefore = host_gpio_edge_get(edges, HOST_GPIO_EDGE_LOG_SIZE);
+    int64_t publishTime = esp_timer_get_time();
+    esp_mqtt_client_publish(phone, OPEN_TLS_MQTT_TOPIC, msg, msgLen, 0, 0);
+
+    int64_t openRise = 0, openFall = 0, stopRise = 0, stopFall = 0;
+    bool passed = host_main_wait_pulse(edgesBefore, OPEN_TLS_HW_DOOR_OPEN, HOST_MAIN_EDGE_TIMEOUT, &openRise, &openFall) &&
+                  host_main_pulse_width_ok(openRise, openFall);
+
+    printf("%-16s %12lld %12lld %12s\n", "OPEN_STOP_CLOSE", (long long) (openRise - publishTime),
+                                         (long long) (openFall - openRise), passed ? "ok" : "FAIL");
+    if( !passed ) {
+        return(false);
+    }
+
+    // SNTP steps the wall clock while STOP and CLOSE are pending, neither may move
+    host_clock_step(HOST_MAIN_CLOCK_STEP);
+
+    passed = host_main_wait_pulse(edgesBefore, OPEN_TLS_HW_DOOR_STOP, stopDelay + HOST_MAIN_EDGE_TIMEOUT, &stopRise, &stopFall);
+    if( passed ) {
+
+        int64_t lateness = stopRise - openRise - stopDelay;
+        passed = lateness > -HOST_MAIN_DELAY_TOLERANCE && lateness < HOST_MAIN_DELAY_TOLERANCE &&
+                 host_main_pulse_width_ok(stopRise, stopFall) && cmd_sched_pending() == 1;
+
+        printf("%-16s %12lld %12lld %12s\n", "delayed STOP", (long long) lateness,
+                                             (long long) (stopFall - stopRise), passed ? "ok" : "FAIL");
+    } else {
+        printf("%-16s %12s %12s %12s\n", "delayed STOP", "-", "-", "FAIL");
+    }
+
+    // and back, with the CLOSE still pending
+    host_clock_step(-HOST_MAIN_CLOCK_STEP);
+    if( host_main_wait_pulse(edgesBefore, OPEN_TLS_HW_DOOR_CLOSE, HOST_MAIN_NO_EDGE_WAIT, &stopRise, &stopFall) ||
+        cmd_sched_pending() != 1 ) {
+
+        printf("%-16s %12s %12s %12s\n", "clock step", "-", "-", "FAIL");
+        passed = false;
+    }
+
+    // the manual STOP cancels the delayed CLOSE
+    msgLen = host_main_build_command(msg, sizeof(msg), CMD_ACTION_STOP, 0, false);
+    edgesBefore = host_gpio_edge_get(edges, HOST_GPIO_EDGE_LOG_SIZE);
+    publishTime = esp_timer_get_time();
+    esp_mqtt_client_publish(phone, OPEN_TLS_MQTT_TOPIC, msg, msgLen, 0, 0);
+
+    bool cancelled = host_main_wait_pulse(edgesBefore, OPEN_TLS_HW_DOOR_STOP, HOST_MAIN_EDGE_TIMEOUT, &stopRise, &stopFall) &&
+                     cmd_sched_pending() == 0;
+
+    printf("%-16s %12lld %12lld %12s\n", "STOP (cancel)", (long long) (stopRise - publishTime),
+                                         (long long) (stopFall - stopRise), cancelled ? "ok" : "FAIL");
+
+    return(passed && cancelled);
+}
+
+
+/**
+ * a second client publishes junk at the interval of the mode, on a topic as the mode says,
+ * while the phone sends OPEN, STOP and CLOSE
+ * each command must reach its relay within HOST_MAIN_FLOOD_BUDGET, no more OTPs may be
+ * checked than the check bucket allows, and a replay must never be let through
+ *
+ * @return true if passed
+ */
+static bool host_main_flood(esp_mqtt_client_handle_t phone, host_main_flood_mode_t mode)
+{
+    static const struct {
+        const char *name;
+        cmd_action_code_t action;
+        int gpio;
+    } commands[] = {
+        { "OPEN",   CMD_ACTION_OPEN,    OPEN_TLS_HW_DOOR_OPEN },
+        { "STOP",   CMD_ACTION_STOP,    OPEN_TLS_HW_DOOR_STOP },
+        { "CLOSE",  CMD_ACTION_CLOSE,   OPEN_TLS_HW_DOOR_CLOSE },
+    };
+    static const struct {
+        const char *name;
+        const char *phoneTopic;
+        uint32_t interval;
+    } modes[] = {
+        { "flood",  OPEN_TLS_MQTT_TOPIC "/phone",   HOST_MAIN_FLOOD_INTERVAL },
+        { "rotate", OPEN_TLS_MQTT_TOPIC,            HOST_MAIN_FLOOD_CHECKED_INTERVAL },
+        { "shared", OPEN_TLS_MQTT_TOPIC,            HOST_MAIN_FLOOD_CHECKED_INTERVAL },
+        { "capture", OPEN_TLS_MQTT_TOPIC,           HOST_MAIN_FLOOD_CHECKED_INTERVAL },
+    };
+    static host_gpio_edge_t edges[HOST_GPIO_EDGE_LOG_SIZE];
+    bool passed = true;
+
+    esp_mqtt_client_config_t noisyCfg = {
+        .event_handle = host_main_noisy_event_handler,
+        .client_id = "host-noisy",
+    };
+    host_main_noisy_connected = false;
+    esp_mqtt_client_handle_t noisy = esp_mqtt_client_init(&noisyCfg);
+    esp_mqtt_client_start(noisy);
+
+    while( !host_main_noisy_connected ) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    rate_limit_stats_t before;
+    rate_limit_get_stats(&before);
+    uint32_t sentBefore = host_main_flood_sent;
+    int64_t floodStart = esp_timer_get_time();
+
+    host_main_flood_mode = mode;
+    host_main_flood_interval = modes[mode].interval;
+    host_main_flood_running = true;
+    xTaskCreate(&host_main_flood_task, "host_flood", 4096, noisy, 1, NULL);
+
+    // let the flood empty the buckets first, the captured command has its pulse then
+    vTaskDelay(pdMS_TO_TICKS(HOST_MAIN_FLOOD_SETTLE));
+
+    for( size_t cIdx = 0; cIdx < sizeof(commands) / sizeof(commands[0]); cIdx++ ) {
+
+        char name[32];
+        char msg[128];
+        int msgLen = host_main_build_command(msg, sizeof(msg), commands[cIdx].action, 0, false);
+
+        snprintf(name, sizeof(name), "%s (%s)", commands[cIdx].name, modes[mode].name);
+
+        uint32_t edgesBefore = host_gpio_edge_get(edges, HOST_GPIO_EDGE_LOG_SIZE);
+        int64_t publishTime = esp_timer_get_time();
+        esp_mqtt_client_publish(phone, modes[mode].phoneTopic, msg, msgLen, 0, 0);
+
+        int64_t rise = 0, fall = 0;
+        bool pulsed = host_main_wait_pulse(edgesBefore, commands[cIdx].gpio, HOST_MAIN_EDGE_TIMEOUT, &rise, &fall) &&
+                      rise - publishTime < HOST_MAIN_FLOOD_BUDGET &&
+                      host_main_pulse_width_ok(rise, fall);
+
+        if( rise != 0 && fall != 0 ) {
+            printf("%-16s %12lld %12lld %12s\n", name, (long long) (rise - publishTime),
+                                                 (long long) (fall - rise), pulsed ? "ok" : "FAIL");
+        } else {
+            printf("%-16s %12s %12s %12s\n", name, "-", "-", "FAIL");
+        }
+
+        passed = passed && pulsed;
+    }
+
+    host_main_flood_running = false;
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    rate_limit_stats_t after;
+    rate_limit_get_stats(&after);
+
+    // the drop path stays cheap, however fast the flood
+    int64_t floodTime = esp_timer_get_time() - floodStart;
+    uint32_t checks = after.checked - before.checked;
+    bool checksOk = checks <= RATE_LIMIT_CHECK_BURST + (uint32_t) (RATE_LIMIT_CHECK_RATE * floodTime / 1000000) + 1;
+
+    // the phone's commands and, if it did not get a token of its own, the captured one, no replay
+    uint32_t verified = after.verified - before.verified;
+    bool verifiedOk = verified <= sizeof(commands) / sizeof(commands[0]) + (mode == HOST_MAIN_FLOOD_REPLAY ? 1 : 0);
+
+    printf("%s: %u junk messages sent, %u admitted, %u dropped per sender, %u dropped globally, %u checked, "
+           "%u verified%s\n",
+           modes[mode].name,
+           host_main_flood_sent - sentBefore,
+           after.admitted - before.admitted,
+           after.droppedSender - before.droppedSender,
+           after.droppedGlobal - before.droppedGlobal,
+           checks,
+           verified,
+           checksOk && verifiedOk ? "" : ", FAIL");
+
+    passed = passed && checksOk && verifiedOk;
+
+    esp_mqtt_client_destroy(noisy);
+
+    return(passed);
+}
+
+
+static esp_err_t host_main_noisy_event_handler(esp_mqtt_event_handle_t event)
+{
+    if( event->event_id == MQTT_EVENT_CONNECTED ) {
+        host_main_noisy_connected = true;
+    }
+
+    return(ESP_OK);
+}
+
+
+/**
+ * junk that costs the most if it is let in: well-formed commands with a bad OTP,
+ * or a command with a valid OTP, captured once and published again and again
+ */
+static void host_main_flood_task(void *arg)
+{
+    esp_mqtt_client_handle_t noisy = (esp_mqtt_client_handle_t) arg;
+    char msg[128];
+    int msgLen = 0;
+
+    if( host_main_flood_mode == HOST_MAIN_FLOOD_REPLAY ) {
+        msgLen = host_main_build_command(msg, sizeof(msg), CMD_ACTION_OPEN, 0, false);
+    }
+
+    while( host_main_flood_running ) {
+
+        if( host_main_flood_mode != HOST_MAIN_FLOOD_REPLAY ) {
+
+            bool frame = (host_main_flood_sent & 1) != 0;
+            msgLen = host_main_build_command(msg, sizeof(msg), CMD_ACTION_OPEN, 0, frame);
+
+            // break the OTP, the checksum no longer matches after decryption
+            if( frame ) {
+                msg[msgLen - 1] ^= 0x01;
+            } else {
+                msg[msgLen - 3] = msg[msgLen - 3] == '0' ? '1' : '0';
+            }
+        }
+
+        char topic[64];
+        if( host_main_flood_mode == HOST_MAIN_FLOOD_OWN_TOPIC ) {
+            snprintf(topic, sizeof(topic), "%s", OPEN_TLS_MQTT_TOPIC "/noisy");
+        } else if( host_main_flood_mode == HOST_MAIN_FLOOD_ROTATE ) {
+            snprintf(topic, sizeof(topic), "%s/noisy%u", OPEN_TLS_MQTT_TOPIC, host_main_flood_sent);
+        } else {
+            snprintf(topic, sizeof(topic), "%s", OPEN_TLS_MQTT_TOPIC);
+        }
+
+        esp_mqtt_client_publish(noisy, topic, msg, msgLen, 0, 0);
+        host_main_flood_sent++;
+
+        usleep(host_main_flood_interval);
+    }
+
+    vTaskDelete(NULL);
+}
+
+
+/**
+ * a JSON command behind a long "config" value, over several MQTT_EVENT_DATA fragments,
+ * then the same longer than OPEN_TLS_MQTT_MAX_MSG_SIZE, which must be dropped
+ *
+ * @return true if passed
+ */
+static bool host_main_large(esp_mqtt_client_handle_t phone)
+{
+    static host_gpio_edge_t edges[HOST_GPIO_EDGE_LOG_SIZE];
+    static char msg[OPEN_TLS_MQTT_MAX_MSG_SIZE + HOST_MAIN_LARGE_PAD];
+    const struct {
+        const char *name;
+        size_t padLen;
+        int expectedGpio;
+    } steps[] = {
+        { "OPEN (5 KB)",        HOST_MAIN_LARGE_PAD,            OPEN_TLS_HW_DOOR_OPEN },
+        { "OPEN (oversize)",    OPEN_TLS_MQTT_MAX_MSG_SIZE,     -1 },
+    };
+    bool passed = true;
+
+    mqtt_reasm_stats_t before;
+    mqtt_get_reasm_stats(&before);
+
+    for( size_t sIdx = 0; sIdx < sizeof(steps) / sizeof(steps[0]); sIdx++ ) {
+
+        char cmd[128];
+        int cmdLen = host_main_build_command(cmd, sizeof(cmd), CMD_ACTION_OPEN, 0, false);
+
+        // {"config":"xxx...","command":..} with the command object opened by cmd
+        int msgLen = sprintf(msg, "{\"config\":\"");
+        memset(msg + msgLen, 'x', steps[sIdx].padLen);
+        msgLen += steps[sIdx].padLen;
+        msgLen += sprintf(msg + msgLen, "\",%.*s", cmdLen - 1, cmd + 1);
+
+        uint32_t edgesBefore = host_gpio_edge_get(edges, HOST_GPIO_EDGE_LOG_SIZE);
+        int64_t publishTime = esp_timer_get_time();
+        esp_mqtt_client_publish(phone, OPEN_TLS_MQTT_TOPIC, msg, msgLen, 0, 0);
+
+        int64_t rise = 0, fall = 0;
+        bool pulsed = host_main_wait_pulse(edgesBefore, steps[sIdx].expectedGpio,
+                                           steps[sIdx].expectedGpio >= 0 ? HOST_MAIN_EDGE_TIMEOUT : HOST_MAIN_NO_EDGE_WAIT,
+                                           &rise, &fall);
+        bool stepPassed = (steps[sIdx].expectedGpio >= 0) == pulsed && (!pulsed || host_main_pulse_width_ok(rise, fall));
+
+        if( pulsed ) {
+            printf("%-16s %12lld %12lld %12s\n", steps[sIdx].name, (long long) (rise - publishTime),
+                                                 (long long) (fall - rise), stepPassed ? "ok" : "FAIL");
+        } else {
+            printf("%-16s %12s %12s %12s\n", steps[sIdx].name, "-", "-", stepPassed ? "ok" : "FAIL");
+        }
+
+        passed = passed && stepPassed;
+    }
+
+    // one message rebuilt and one dropped, nothing broken
+    mqtt_reasm_stats_t after;
+    mqtt_get_reasm_stats(&after);
+    printf("reasm: %u rebuilt from fragments, %u oversized, %u broken\n",
+           after.fragmented - before.fragmented,
+           after.oversized - before.oversized,
+           after.broken - before.broken);
+
+    return(passed &&
+           after.fragmented - before.fragmented == 1 &&
+           after.oversized - before.oversized == 1 &&
+           after.broken == before.broken);
+}
+
+
+/**
+ * the phone saw the retained online state when it subscribed.
+ * the connection of the device is then cut, the broker publishes the offline will,
+ * and the device is back online and takes commands after the reconnect
+ */
+static bool host_main_presence(esp_mqtt_client_handle_t phone)
+{
+    static host_gpio_edge_t edges[HOST_GPIO_EDGE_LOG_SIZE];
+
+    // only the loopback broker can cut a connection on request
+    if( getenv("OPEN_TLS_HOST_BROKER") != NULL ) {
+        printf("presence: skipped, loopback broker only\n");
+        return(true);
+    }
+
+    if( !host_main_wait_count(&host_main_phone_online, 1, NULL) || !host_main_phone_online_retained ) {
+        printf("presence: no retained online state\n");
+        return(false);
+    }
+
+    uint32_t online = host_main_phone_online;
+    uint32_t offline = host_main_phone_offline;
+    int64_t dropTime = esp_timer_get_time();
+    int64_t offlineAt = 0, onlineAt = 0;
+
+    host_mqtt_drop(t_device_sn_str, HOST_MAIN_DROP_TIME);
+
+    bool passed = host_main_wait_count(&host_main_phone_offline, offline + 1, &offlineAt) &&
+                  host_main_wait_count(&host_main_phone_online, online + 1, &onlineAt) &&
+                  !host_main_phone_online_retained;
+
+    printf("presence: offline after %lld us, online again after %lld us\n",
+           (long long) (offlineAt - dropTime), (long long) (onlineAt - dropTime));
+
+    if( !passed ) {
+        return(false);
+    }
+
+    // subscribed again, commands still get through
+    char cmd[128];
+    int cmdLen = host_main_build_command(cmd, sizeof(cmd), CMD_ACTION_OPEN, 0, false);
+    uint32_t edgesBefore = host_gpio_edge_get(edges, HOST_GPIO_EDGE_LOG_SIZE);
+    int64_t publishTime = esp_timer_get_time();
+    esp_mqtt_client_publish(phone, OPEN_TLS_MQTT_TOPIC, cmd, cmdLen, 0, 0);
+
+    int64_t rise = 0, fall = 0;
+    passed = host_main_wait_pulse(edgesBefore, OPEN_TLS_HW_DOOR_OPEN, HOST_MAIN_EDGE_TIMEOUT, &rise, &fall) &&
+             host_main_pulse_width_ok(rise, fall);
+
+    if( passed ) {
+        printf("%-16s %12lld %12lld %12s\n", "OPEN (reconnect)", (long long) (rise - publishTime),
+                                             (long long) (fall - rise), "ok");
+    } else {
+        printf("%-16s %12s %12s %12s\n", "OPEN (reconnect)", "-", "-", "FAIL");
+    }
+
+    return(passed);
+}
+
+
+static bool host_main_wait_count(volatile uint32_t *count, uint32_t target, int64_t *at)
+{
+    int64_t deadline = esp_timer_get_time() + HOST_MAIN_PRESENCE_TIMEOUT;
+
+    while( *count < target ) {
+
+        if( esp_timer_get_time() > deadline ) {
+            return(false);
+        }
+        vTaskDelay(1);
+    }
+
+    if( at != NULL ) {
+        *at = esp_timer_get_time();
+    }
+
+    return(true);
+}
+
+
+/**
+ * press the button, LED2 must be on within HOST_MAIN_BUTTON_BUDGET
+ * then leave the gpio task alone and count its wakeups
+ *
+ * @return true if passed
+ */
+static bool host_main_gpio_task(void)
+{
+    static host_gpio_edge_t edges[HOST_GPIO_EDGE_LOG_SIZE];
+    t_gpio_stats_t before;
+    t_gpio_stats_t after;
+    int64_t rise = 0;
+    int64_t fall = 0;
+
+    uint32_t edgesBefore = host_gpio_edge_get(edges, HOST_GPIO_EDGE_LOG_SIZE);
+    int64_t pressTime = esp_timer_get_time();
+    host_gpio_input(OPEN_TLS_HW_BUTTON, 1);
+
+    bool passed = host_main_wait_pulse(edgesBefore, OPEN_TLS_HW_LED2, HOST_MAIN_EDGE_TIMEOUT, &rise, &fall) &&
+                  rise - pressTime < HOST_MAIN_BUTTON_BUDGET;
+    host_gpio_input(OPEN_TLS_HW_BUTTON, 0);
+
+    printf("button: LED2 on after %lld us, for %lld us\n", (long long) (rise - pressTime), (long long) (fall - rise));
+
+    t_gpio_get_stats(&before);
+    int64_t idleStart = esp_timer_get_time();
+    vTaskDelay(pdMS_TO_TICKS(HOST_MAIN_IDLE_TIME));
+    t_gpio_get_stats(&after);
+
+    uint32_t idlePerMinute = (uint32_t) ((int64_t) (after.wakeups - before.wakeups) * 60000000 /
+                                         (esp_timer_get_time() - idleStart));
+    printf("gpio task: %u wakeups, %u per minute over the run, %u per minute when idle (250 ms poll: 240)\n",
+           after.wakeups, after.perMinute, idlePerMinute);
+    printf("gpio task: %u jobs on deadline, late by %u us on average, %u us at most\n",
+           after.jobs, after.lateAvg, after.lateMax);
+
+    return(passed && idlePerMinute <= HOST_MAIN_MAX_IDLE_WAKEUPS && after.lateMax < HOST_MAIN_MAX_LATENESS);
+}
+
+
+/**
+ * register a job which is slow once, then print the figures of all jobs
+ * as they go into the device report
+ *
+ * @return true if passed
+ */
+static bool host_main_periodical(void)
+{
+    if( periodical_register("host", HOST_MAIN_JOB_PERIOD, 0, host_main_test_job) < 0 ) {
+        printf("periodical: unable to register the test job\n");
+        return(false);
+    }
+    vTaskDelay(pdMS_TO_TICKS(HOST_MAIN_JOB_TIME));
+
+    periodical_stats_t stats[PERIODICAL_MAX_JOBS];
+    uint8_t count = periodical_get_stats(stats, PERIODICAL_MAX_JOBS);
+    bool passed = true;
+
+    printf("\n%-8s %10s %6s %8s %8s %8s %8s %6s\n", "job", "period(ms)", "n", "run", "run_max", "late", "late_max", "over");
+    for( uint8_t jIdx = 0; jIdx < count; jIdx++ ) {
+
+        printf("%-8s %10u %6u %8u %8u %8u %8u %6u\n", stats[jIdx].name, stats[jIdx].period, stats[jIdx].runs,
+                                                    stats[jIdx].lastRuntime, stats[jIdx].maxRuntime,
+                                                    stats[jIdx].lastLateness, stats[jIdx].maxLateness,
+                                                    stats[jIdx].overruns);
+
+        // the report job is run once on connect, long before its period
+        if( !strcmp(stats[jIdx].name, "report") ) {
+            passed = passed && stats[jIdx].runs >= 1;
+        }
+
+        // one slow run, one overrun, the missed period is skipped and the rest are on time
+        if( !strcmp(stats[jIdx].name, "host") ) {
+            passed = passed && stats[jIdx].overruns == 1 &&
+                     stats[jIdx].runs >= HOST_MAIN_JOB_TIME / HOST_MAIN_JOB_PERIOD - 5 &&
+                     stats[jIdx].maxLateness < HOST_MAIN_MAX_LATENESS;
+        }
+    }
+    printf("\n");
+
+    return(passed);
+}
+
+
+static void host_main_test_job(void)
+{
+    static uint32_t runs = 0;
+
+    if( ++runs == HOST_MAIN_JOB_SLOW_RUN ) {
+        vTaskDelay(pdMS_TO_TICKS(HOST_MAIN_JOB_PERIOD * 5 / 2));
+    }
+}
+
+
+/**
+ * take a sample now and print it, the device tasks must be tracked
+ *
+ * @return true if passed
+ */
+static bool host_main_sysmon(void)
+{
+    static sysmon_task_stats_t tasks[SYSMON_MAX_TASKS];
+    sysmon_stats_t stats;
+    bool gpioTask = false;
+    bool cmdTask = false;
+
+    sysmon_sample();
+    sysmon_get_stats(&stats);
+    uint8_t count = sysmon_get_task_stats(tasks, SYSMON_MAX_TASKS);
+
+    printf("%-16s %8s %8s %10s\n", "task", "cpu(.1%)", "cpu_max", "stack_free");
+    for( uint8_t tIdx = 0; tIdx < count; tIdx++ ) {
+
+        printf("%-16s %8u %8u %10u\n", tasks[tIdx].name, tasks[tIdx].cpu, tasks[tIdx].cpuMax, tasks[tIdx].stackFree);
+
+        gpioTask = gpioTask || !strcmp(tasks[tIdx].name, "gpio_task");
+        cmdTask = cmdTask || !strcmp(tasks[tIdx].name, "cmd_task");
+    }
+    printf("heap: %u free, %u to %u over %u samples, %u at the lowest, largest block %u, %u%% fragmented\n\n",
+           stats.free, stats.freeMin, stats.freeMax, stats.samples, stats.lowest, stats.largest, stats.frag);
+
+    return(gpioTask && cmdTask && stats.samples >= 2);
+}
+
+
+static bool host_main_netmon(void)
+{
+    static netmon_stats_t stats;
+
+    netmon_get_stats(&stats);
+
+    printf("net: %u connects, %u disconnects, %u failed, connect %u/%u/%u ms, ping %u/%u/%u ms over %u, %u lost\n",
+           stats.connects, stats.disconnects, stats.failed,
+           stats.connect.min, stats.connect.avg, stats.connect.max,
+           stats.ping.min, stats.ping.avg, stats.ping.max, stats.ping.count, stats.pingsLost);
+    for( uint8_t oIdx = 0; oIdx < stats.outageCount; oIdx++ ) {
+        printf("outage at %u s: %s %d%s\n", stats.outages[oIdx].at, netmon_reason_name(stats.outages[oIdx].reason),
+                                           stats.outages[oIdx].detail, stats.outages[oIdx].failed ? ", failed" : "");
+    }
+
+    printf("%-16s %8s %8s %8s %8s\n", "topic", "in", "in_b", "out", "out_b");
+    for( uint8_t topic = 0; topic < NETMON_TOPIC_COUNT; topic++ ) {
+        printf("%-16s %8u %8u %8u %8u\n", netmon_topic_name(topic),
+                                         stats.topics[topic].inMsgs, stats.topics[topic].inBytes,
+                                         stats.topics[topic].outMsgs, stats.topics[topic].outBytes);
+    }
+    printf("\n");
+
+    // the first connection and the one after the drop of the presence check, loopback broker only
+    bool dropped = getenv("OPEN_TLS_HOST_BROKER") != NULL ||
+                   (stats.connects >= 2 && stats.connect.count >= 2 &&
+                    stats.disconnects >= 1 && stats.reasons[NETMON_REASON_CLOSED] >= 1 &&
+                    stats.topics[NETMON_TOPIC_PRESENCE].outMsgs >= 2);
+
+    return(dropped && stats.connects >= 1 &&
+           stats.topics[NETMON_TOPIC_COMMAND].inMsgs > 0 && stats.topics[NETMON_TOPIC_COMMAND].inBytes > 0 &&
+           stats.topics[NETMON_TOPIC_STATUS].outMsgs > 0 && stats.topics[NETMON_TOPIC_PRESENCE].outMsgs > 0);
+}
@@ -0,0 +1,146 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "esp_log.h"
+
+#include "open_tls.h"
+#include "app_wifi.h"
+#include "tls_session.h"
+#include "tls_certs.h"
+#include "boot.h"
+
+static const char *TAG = "HOST_STUB";
+
+///////////////////////////////////////////////////////////////////////////////////
+// Global Variables
+// Note: owned by open_tls_main.c on the device
+char t_device_sn_str[24];
+uint8_t t_device_MAC[6];
+char t_device_wifi_ssid[20] = "host";
+uint8_t t_device_wifi_bssid[6];
+
+///////////////////////////////////////////////////////////////////////////////////
+// embedded files
+// the host transport is plain MQTT, the certificates are empty placeholders
+const uint8_t host_aws_root_ca_pem[] asm("_binary_aws_root_ca_pem_start") = "";
+const uint8_t host_aws_root_ca_pem_end[] asm("_binary_aws_root_ca_pem_end") = "";
+const uint8_t host_certificate_pem_crt[] asm("_binary_my_tls_certificate_pem_crt_start") = "";
+const uint8_t host_certificate_pem_crt_end[] asm("_binary_my_tls_certificate_pem_crt_end") = "";
+const uint8_t host_private_key_pem[] asm("_binary_my_tls_private_pem_key_start") = "";
+const uint8_t host_private_key_pem_end[] asm("_binary_my_tls_private_pem_key_end") = "";
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+// Note: app_wifi.c, tls_certs.c and tls_session.c are not part of the host build,
+//       the functions used by the command path are stubbed here
+
+void app_wifi_initialise(void)
+{
+    boot_mark(BOOT_PHASE_WIFI);
+}
+
+
+void app_wifi_wait_connected(void)
+{
+}
+
+
+// the host clock is always set
+void app_wifi_time_restore(void)
+{
+    boot_set_time_source(BOOT_TIME_RTC);
+}
+
+
+bool app_wifi_time_valid(void)
+{
+    return(true);
+}
+
+
+bool app_wifi_time_confirmed(void)
+{
+    return(true);
+}
+
+
+bool app_wifi_is_connected(void)
+{
+    return(true);
+}
+
+
+void app_wifi_ntp_request(void)
+{
+    ESP_LOGI(TAG, "NTP request (host clock is used)");
+}
+
+
+void app_wifi_ntp_init(void)
+{
+    boot_set_time_source(BOOT_TIME_NTP);
+    boot_mark(BOOT_PHASE_NTP);
+}
+
+
+void app_wifi_ntp_wait(void)
+{
+}
+
+
+void app_wifi_preconnect(const char *uri)
+{
+}
+
+
+int8_t app_wifi_get_rssi(void)
+{
+    return(-50);
+}
+
+
+// a steady link, one AP and no outage
+void app_wifi_get_stats(app_wifi_stats_t *stats)
+{
+    memset(stats, 0, sizeof(app_wifi_stats_t));
+
+    stats->rssiCount = APP_WIFI_RSSI_HISTORY_SIZE;
+    memset(stats->rssiHistory, -50, sizeof(stats->rssiHistory));
+    stats->rssiMin = -50;
+    stats->rssiAvg = -50;
+    stats->rssiMax = -50;
+}
+
+
+// the host transport is plain TCP, there is no TLS handshake
+void tls_session_init(void)
+{
+}
+
+
+void tls_session_get_stats(tls_session_stats_t *stats)
+{
+    memset(stats, 0, sizeof(tls_session_stats_t));
+}
+
+
+// the embedded placeholders, the host transport does not use them
+const tls_certs_t *tls_certs_init(void)
+{
+    static tls_certs_t certs;
+
+    certs.data[TLS_CERTS_ROOT_CA] = (const char *) host_aws_root_ca_pem;
+    certs.data[TLS_CERTS_CLIENT_CERT] = (const char *) host_certificate_pem_crt;
+    certs.data[TLS_CERTS_CLIENT_KEY] = (const char *) host_private_key_pem;
+
+    return(&certs);
+}
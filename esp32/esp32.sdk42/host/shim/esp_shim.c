@@ -0,0 +1,467 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+#include <pthread.h>
+#include <openssl/evp.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_task_wdt.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "driver/periph_ctrl.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/base64.h"
+#include "tcpip_adapter.h"
+#include "esp32/rom/crc.h"
+#include "host_shim.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static esp_log_level_t host_log_level = ESP_LOG_INFO;
+static pthread_mutex_t host_log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_mutex_t host_gpio_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t host_gpio_levels[GPIO_NUM_MAX];
+static host_gpio_edge_t host_gpio_edges[HOST_GPIO_EDGE_LOG_SIZE];
+static uint32_t host_gpio_edge_count = 0;
+static gpio_isr_t host_gpio_isr[GPIO_NUM_MAX];
+static void *host_gpio_isr_arg[GPIO_NUM_MAX];
+
+static volatile int64_t host_clock_offset = 0;  // in us, added to the wall clock by host_clock_step()
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+// the real ones, renamed by the linker, see the Makefile
+int __real_gettimeofday(struct timeval *tv, void *tz);
+int __wrap_gettimeofday(struct timeval *tv, void *tz);
+time_t __wrap_time(time_t *t);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+int64_t esp_timer_get_time(void)
+{
+    static struct timespec start = { 0 };
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if( start.tv_sec == 0 && start.tv_nsec == 0 ) {
+        start = now;
+    }
+
+    return((int64_t) (now.tv_sec - start.tv_sec) * 1000000 + (now.tv_nsec - start.tv_nsec) / 1000);
+}
+
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    host_log_level = level;
+}
+
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    if( level > host_log_level ) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+
+    pthread_mutex_lock(&host_log_lock);
+    vprintf(format, args);
+    fflush(stdout);
+    pthread_mutex_unlock(&host_log_lock);
+
+    va_end(args);
+}
+
+
+uint32_t esp_log_timestamp(void)
+{
+    return((uint32_t) (esp_timer_get_time() / 1000));
+}
+
+
+void esp_restart(void)
+{
+    ESP_LOGE("HOST", "esp_restart() called, terminating the host process");
+    exit(EXIT_FAILURE);
+}
+
+
+/**
+ * the host heap is not bounded, report a value close to a running device
+ */
+uint32_t esp_get_free_heap_size(void)
+{
+    return(160 * 1024);
+}
+
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+    return(esp_get_free_heap_size());
+}
+
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return(esp_get_free_heap_size());
+}
+
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    return(esp_get_minimum_free_heap_size());
+}
+
+
+/**
+ * the largest block of a device some time after boot
+ */
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return(112 * 1024);
+}
+
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type)
+{
+    static const uint8_t hostMac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+
+    memcpy(mac, hostMac, sizeof(hostMac));
+
+    return(ESP_OK);
+}
+
+
+/**
+ * every host run is a fresh start
+ */
+esp_reset_reason_t esp_reset_reason(void)
+{
+    return(ESP_RST_POWERON);
+}
+
+
+uint32_t crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    for( uint32_t bIdx = 0; bIdx < len; bIdx++ ) {
+
+        crc ^= buf[bIdx];
+        for( uint8_t bit = 0; bit < 8; bit++ ) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+
+    return(~crc);
+}
+
+
+esp_err_t esp_task_wdt_init(uint32_t timeout, bool panic)
+{
+    return(ESP_OK);
+}
+
+
+esp_err_t esp_task_wdt_add(TaskHandle_t handle)
+{
+    return(ESP_OK);
+}
+
+
+esp_err_t esp_task_wdt_reset(void)
+{
+    return(ESP_OK);
+}
+
+
+esp_err_t esp_task_wdt_delete(TaskHandle_t handle)
+{
+    return(ESP_OK);
+}
+
+
+/**
+ * set the output level and record the edge if the level is changed
+ */
+esp_err_t gpio_set_level(gpio_num_t gpioNum, uint32_t level)
+{
+    if( gpioNum < 0 || gpioNum >= GPIO_NUM_MAX ) {
+        return(ESP_ERR_INVALID_ARG);
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    pthread_mutex_lock(&host_gpio_lock);
+
+    level = level ? 1 : 0;
+    if( host_gpio_levels[gpioNum] != level ) {
+
+        host_gpio_levels[gpioNum] = level;
+
+        if( host_gpio_edge_count < HOST_GPIO_EDGE_LOG_SIZE ) {
+            host_gpio_edges[host_gpio_edge_count].timestamp = now;
+            host_gpio_edges[host_gpio_edge_count].gpio = gpioNum;
+            host_gpio_edges[host_gpio_edge_count].level = level;
+            host_gpio_edge_count++;
+        }
+    }
+
+    pthread_mutex_unlock(&host_gpio_lock);
+
+    return(ESP_OK);
+}
+
+
+int gpio_get_level(gpio_num_t gpioNum)
+{
+    if( gpioNum < 0 || gpioNum >= GPIO_NUM_MAX ) {
+        return(0);
+    }
+
+    return(host_gpio_levels[gpioNum]);
+}
+
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    return(ESP_OK);
+}
+
+
+esp_err_t gpio_install_isr_service(int intrAllocFlags)
+{
+    return(ESP_OK);
+}
+
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpioNum, gpio_isr_t isrHandler, void *args)
+{
+    if( gpioNum < 0 || gpioNum >= GPIO_NUM_MAX ) {
+        return(ESP_ERR_INVALID_ARG);
+    }
+
+    pthread_mutex_lock(&host_gpio_lock);
+    host_gpio_isr[gpioNum] = isrHandler;
+    host_gpio_isr_arg[gpioNum] = args;
+    pthread_mutex_unlock(&host_gpio_lock);
+
+    return(ESP_OK);
+}
+
+
+/**
+ * drive an input, its ISR handler is called in the calling thread if the level is changed
+ * input levels are not recorded as edges
+ */
+void host_gpio_input(int gpio, uint32_t level)
+{
+    if( gpio < 0 || gpio >= GPIO_NUM_MAX ) {
+        return;
+    }
+
+    pthread_mutex_lock(&host_gpio_lock);
+
+    level = level ? 1 : 0;
+    bool changed = (host_gpio_levels[gpio] != level);
+    host_gpio_levels[gpio] = level;
+    gpio_isr_t isrHandler = host_gpio_isr[gpio];
+    void *isrArg = host_gpio_isr_arg[gpio];
+
+    pthread_mutex_unlock(&host_gpio_lock);
+
+    if( changed && isrHandler != NULL ) {
+        isrHandler(isrArg);
+    }
+}
+
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timerConf)
+{
+    return(ESP_OK);
+}
+
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledcConf)
+{
+    return(ESP_OK);
+}
+
+
+esp_err_t ledc_fade_func_install(int intrAllocFlags)
+{
+    return(ESP_OK);
+}
+
+
+esp_err_t ledc_set_fade_time_and_start(ledc_mode_t speedMode, ledc_channel_t channel, uint32_t targetDuty,
+                                       uint32_t maxFadeTimeMs, ledc_fade_mode_t fadeMode)
+{
+    return(ESP_OK);
+}
+
+
+void periph_module_reset(periph_module_t periph)
+{
+}
+
+
+void host_gpio_edge_reset(void)
+{
+    pthread_mutex_lock(&host_gpio_lock);
+    host_gpio_edge_count = 0;
+    pthread_mutex_unlock(&host_gpio_lock);
+}
+
+
+/**
+ * copy the recorded edges
+ *
+ * @return number of edges copied
+ */
+uint32_t host_gpio_edge_get(host_gpio_edge_t *edges, uint32_t maxEdges)
+{
+    pthread_mutex_lock(&host_gpio_lock);
+    uint32_t count = (host_gpio_edge_count < maxEdges ? host_gpio_edge_count : maxEdges);
+    memcpy(edges, host_gpio_edges, count * sizeof(host_gpio_edge_t));
+    pthread_mutex_unlock(&host_gpio_lock);
+
+    return(count);
+}
+
+
+void host_gpio_edge_dump(void)
+{
+    pthread_mutex_lock(&host_gpio_lock);
+    for( uint32_t eIdx = 0; eIdx < host_gpio_edge_count; eIdx++ ) {
+        printf("GPIO %2d -> %d at %lld us\n", host_gpio_edges[eIdx].gpio,
+                                              host_gpio_edges[eIdx].level,
+                                              (long long) host_gpio_edges[eIdx].timestamp);
+    }
+    pthread_mutex_unlock(&host_gpio_lock);
+}
+
+
+/**
+ * step the wall clock seen by the firmware, time() and gettimeofday(), as SNTP does
+ * esp_timer is not moved
+ */
+void host_clock_step(int64_t stepUs)
+{
+    host_clock_offset += stepUs;
+}
+
+
+int __wrap_gettimeofday(struct timeval *tv, void *tz)
+{
+    int ret = __real_gettimeofday(tv, tz);
+
+    if( ret == 0 && tv != NULL ) {
+
+        int64_t now = (int64_t) tv->tv_sec * 1000000 + tv->tv_usec + host_clock_offset;
+        tv->tv_sec = (time_t) (now / 1000000);
+        tv->tv_usec = (suseconds_t) (now % 1000000);
+    }
+
+    return(ret);
+}
+
+
+time_t __wrap_time(time_t *t)
+{
+    struct timeval tv;
+
+    __wrap_gettimeofday(&tv, NULL);
+    if( t != NULL ) {
+        *t = tv.tv_sec;
+    }
+
+    return(tv.tv_sec);
+}
+
+void esp_aes_init(esp_aes_context *ctx)
+{
+    memset(ctx, 0, sizeof(esp_aes_context));
+}
+
+
+void esp_aes_free(esp_aes_context *ctx)
+{
+    if( ctx != NULL ) {
+        memset(ctx, 0, sizeof(esp_aes_context));
+    }
+}
+
+
+int esp_aes_setkey(esp_aes_context *ctx, const unsigned char *key, unsigned int keybits)
+{
+    if( keybits != 128 && keybits != 192 && keybits != 256 ) {
+        return(-1);
+    }
+
+    memcpy(ctx->key, key, keybits / 8);
+    ctx->key_bits = keybits;
+    AES_set_encrypt_key(key, keybits, &ctx->enc);
+    AES_set_decrypt_key(key, keybits, &ctx->dec);
+
+    return(0);
+}
+
+
+int esp_aes_crypt_ecb(esp_aes_context *ctx, int mode, const unsigned char input[16], unsigned char output[16])
+{
+    if( mode == ESP_AES_ENCRYPT ) {
+        AES_encrypt(input, output, &ctx->enc);
+    } else {
+        AES_decrypt(input, output, &ctx->dec);
+    }
+
+    return(0);
+}
+
+
+int mbedtls_base64_encode(unsigned char *dst, size_t dlen, size_t *olen,
+                          const unsigned char *src, size_t slen)
+{
+    size_t needed = ((slen + 2) / 3) * 4 + 1;
+
+    if( dst == NULL || dlen < needed ) {
+        *olen = needed;
+        return(MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL);
+    }
+
+    *olen = EVP_EncodeBlock(dst, src, slen);
+
+    return(0);
+}
+
+
+esp_err_t tcpip_adapter_get_ip_info(tcpip_adapter_if_t tcpipIf, tcpip_adapter_ip_info_t *ipInfo)
+{
+    // 127.0.0.1 in the lwIP byte order
+    ipInfo->ip.addr = 0x0100007f;
+    ipInfo->netmask.addr = 0x000000ff;
+    ipInfo->gw.addr = 0;
+
+    return(ESP_OK);
+}
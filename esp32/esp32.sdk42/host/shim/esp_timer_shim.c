@@ -0,0 +1,247 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "esp_err.h"
+#include "esp_timer.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    const char *name;
+    int64_t expiry;                     // in us, esp_timer_get_time() base
+    uint64_t period;                    // in us, 0 for one-shot
+    bool armed;
+    struct esp_timer *next;             // armed list, sorted by expiry
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static pthread_mutex_t host_timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t host_timer_changed;
+static pthread_once_t host_timer_once = PTHREAD_ONCE_INIT;
+static struct esp_timer *host_timer_armed = NULL;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local functions
+static void host_timer_start_thread(void);
+static void *host_timer_thread(void *arg);
+static void host_timer_insert(struct esp_timer *timer);
+static void host_timer_remove(struct esp_timer *timer);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *outHandle)
+{
+    if( args == NULL || args->callback == NULL || outHandle == NULL ) {
+        return(ESP_ERR_INVALID_ARG);
+    }
+
+    pthread_once(&host_timer_once, host_timer_start_thread);
+
+    struct esp_timer *timer = calloc(1, sizeof(struct esp_timer));
+    if( timer == NULL ) {
+        return(ESP_ERR_NO_MEM);
+    }
+
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    timer->name = args->name;
+
+    *outHandle = timer;
+    return(ESP_OK);
+}
+
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs)
+{
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&host_timer_lock);
+    if( timer->armed ) {
+
+        err = ESP_ERR_INVALID_STATE;
+
+    } else {
+
+        timer->expiry = esp_timer_get_time() + (int64_t) timeoutUs;
+        timer->period = 0;
+        host_timer_insert(timer);
+        pthread_cond_signal(&host_timer_changed);
+    }
+    pthread_mutex_unlock(&host_timer_lock);
+
+    return(err);
+}
+
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs)
+{
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&host_timer_lock);
+    if( timer->armed ) {
+
+        err = ESP_ERR_INVALID_STATE;
+
+    } else {
+
+        timer->expiry = esp_timer_get_time() + (int64_t) periodUs;
+        timer->period = periodUs;
+        host_timer_insert(timer);
+        pthread_cond_signal(&host_timer_changed);
+    }
+    pthread_mutex_unlock(&host_timer_lock);
+
+    return(err);
+}
+
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&host_timer_lock);
+    if( !timer->armed ) {
+        err = ESP_ERR_INVALID_STATE;
+    } else {
+        host_timer_remove(timer);
+    }
+    pthread_mutex_unlock(&host_timer_lock);
+
+    return(err);
+}
+
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&host_timer_lock);
+    if( timer->armed ) {
+
+        pthread_mutex_unlock(&host_timer_lock);
+        return(ESP_ERR_INVALID_STATE);
+    }
+    pthread_mutex_unlock(&host_timer_lock);
+
+    free(timer);
+    return(ESP_OK);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+static void host_timer_start_thread(void)
+{
+    pthread_condattr_t attr;
+    pthread_t thread;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&host_timer_changed, &attr);
+    pthread_condattr_destroy(&attr);
+
+    // make sure the time base is set before the first expiry is computed
+    esp_timer_get_time();
+
+    pthread_create(&thread, NULL, host_timer_thread, NULL);
+    pthread_detach(thread);
+}
+
+
+/**
+ * the esp_timer task, the callbacks run without holding the lock
+ * so they can start or stop timers themselves
+ */
+static void *host_timer_thread(void *arg)
+{
+    pthread_mutex_lock(&host_timer_lock);
+
+    while( true ) {
+
+        if( host_timer_armed == NULL ) {
+
+            pthread_cond_wait(&host_timer_changed, &host_timer_lock);
+            continue;
+        }
+
+        struct esp_timer *timer = host_timer_armed;
+        int64_t now = esp_timer_get_time();
+
+        if( timer->expiry > now ) {
+
+            // esp_timer_get_time() and CLOCK_MONOTONIC only differ by the start offset
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            int64_t waitUs = timer->expiry - now;
+            deadline.tv_sec += waitUs / 1000000;
+            deadline.tv_nsec += (waitUs % 1000000) * 1000;
+            if( deadline.tv_nsec >= 1000000000 ) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000;
+            }
+
+            pthread_cond_timedwait(&host_timer_changed, &host_timer_lock, &deadline);
+            continue;
+        }
+
+        host_timer_remove(timer);
+        if( timer->period > 0 ) {
+            timer->expiry += (int64_t) timer->period;
+            host_timer_insert(timer);
+        }
+
+        esp_timer_cb_t callback = timer->callback;
+        void *callbackArg = timer->arg;
+
+        pthread_mutex_unlock(&host_timer_lock);
+        callback(callbackArg);
+        pthread_mutex_lock(&host_timer_lock);
+    }
+
+    return(NULL);
+}
+
+
+static void host_timer_insert(struct esp_timer *timer)
+{
+    struct esp_timer **link = &host_timer_armed;
+
+    while( *link != NULL && (*link)->expiry <= timer->expiry ) {
+        link = &(*link)->next;
+    }
+
+    timer->next = *link;
+    *link = timer;
+    timer->armed = true;
+}
+
+
+static void host_timer_remove(struct esp_timer *timer)
+{
+    struct esp_timer **link = &host_timer_armed;
+
+    while( *link != NULL && *link != timer ) {
+        link = &(*link)->next;
+    }
+
+    if( *link != NULL ) {
+        *link = timer->next;
+    }
+
+    timer->next = NULL;
+    timer->armed = false;
+}
@@ -0,0 +1,567 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t taskCode;
+    void *arg;
+    char name[16];
+    uint32_t stackDepth;
+    UBaseType_t priority;
+    pthread_mutex_t notifyLock;
+    pthread_cond_t notifyCond;
+    uint32_t notifyValue;
+    bool notifyPending;
+    UBaseType_t number;
+    struct host_task *next;             // in host_tasks
+};
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static pthread_mutex_t host_critical_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread struct host_task *host_current_task = NULL;
+
+// the created tasks, for uxTaskGetSystemState()
+static pthread_mutex_t host_tasks_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct host_task *host_tasks = NULL;
+static UBaseType_t host_task_count = 0;
+static UBaseType_t host_task_number = 0;
+static uint32_t host_tasks_start = 0;      // in us, the total run time counts from the first task
+
+///////////////////////////////////////////////////////////////////////////////////
+// local functions
+static void *host_task_entry(void *arg);
+static void host_deadline_from_ticks(struct timespec *deadline, TickType_t ticks);
+static void host_cond_init(pthread_cond_t *cond);
+static void host_task_unlink(struct host_task *task);
+static uint32_t host_us(clockid_t clock);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+void host_enter_critical(void)
+{
+    pthread_mutex_lock(&host_critical_lock);
+}
+
+
+void host_exit_critical(void)
+{
+    pthread_mutex_unlock(&host_critical_lock);
+}
+
+
+/**
+ * tasks are detached pthreads, the priority and the stack depth are only recorded
+ */
+BaseType_t xTaskCreate(TaskFunction_t taskCode, const char *name, uint32_t stackDepth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *createdTask)
+{
+    struct host_task *task = calloc(1, sizeof(struct host_task));
+    if( task == NULL ) {
+        return(pdFAIL);
+    }
+
+    task->taskCode = taskCode;
+    task->arg = arg;
+    task->stackDepth = stackDepth;
+    task->priority = priority;
+    strncpy(task->name, name, sizeof(task->name) - 1);
+
+    pthread_mutex_init(&task->notifyLock, NULL);
+    host_cond_init(&task->notifyCond);
+
+    // listed before it runs, so it can delete itself at once
+    pthread_mutex_lock(&host_tasks_lock);
+    if( host_task_number == 0 ) {
+        host_tasks_start = host_us(CLOCK_MONOTONIC);
+    }
+    task->number = ++host_task_number;
+    task->next = host_tasks;
+    host_tasks = task;
+    host_task_count++;
+
+    if( pthread_create(&task->thread, NULL, host_task_entry, task) != 0 ) {
+        host_task_unlink(task);
+        pthread_mutex_unlock(&host_tasks_lock);
+        pthread_mutex_destroy(&task->notifyLock);
+        pthread_cond_destroy(&task->notifyCond);
+        free(task);
+        return(pdFAIL);
+    }
+    pthread_detach(task->thread);
+    pthread_mutex_unlock(&host_tasks_lock);
+
+    if( createdTask != NULL ) {
+        *createdTask = task;
+    }
+
+    return(pdPASS);
+}
+
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t taskCode, const char *name, uint32_t stackDepth,
+                                   void *arg, UBaseType_t priority, TaskHandle_t *createdTask, BaseType_t coreId)
+{
+    return(xTaskCreate(taskCode, name, stackDepth, arg, priority, createdTask));
+}
+
+
+/**
+ * only the calling task can be deleted on the host
+ */
+void vTaskDelete(TaskHandle_t task)
+{
+    if( task == NULL || task == host_current_task ) {
+        pthread_mutex_lock(&host_tasks_lock);
+        host_task_unlink(host_current_task);
+        pthread_mutex_unlock(&host_tasks_lock);
+
+        pthread_mutex_destroy(&host_current_task->notifyLock);
+        pthread_cond_destroy(&host_current_task->notifyCond);
+        free(host_current_task);
+        host_current_task = NULL;
+        pthread_exit(NULL);
+    }
+}
+
+
+/**
+ * only the calling task can be suspended on the host, it never resumes
+ */
+void vTaskSuspend(TaskHandle_t task)
+{
+    while( task == NULL || task == host_current_task ) {
+        pause();
+    }
+}
+
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec delay;
+
+    delay.tv_sec = ticks / configTICK_RATE_HZ;
+    delay.tv_nsec = (long) (ticks % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ);
+
+    while( nanosleep(&delay, &delay) != 0 && errno == EINTR ) {
+        // continue the remaining delay
+    }
+}
+
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return((TickType_t) (now.tv_sec * configTICK_RATE_HZ + now.tv_nsec / (1000000000L / configTICK_RATE_HZ)));
+}
+
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return(host_current_task);
+}
+
+
+/**
+ * there is no stack painting on the host, the configured depth is returned
+ */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    if( task == NULL ) {
+        task = host_current_task;
+    }
+
+    return(task != NULL ? task->stackDepth : 0);
+}
+
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+    pthread_mutex_lock(&host_tasks_lock);
+    UBaseType_t count = host_task_count;
+    pthread_mutex_unlock(&host_tasks_lock);
+
+    return(count);
+}
+
+
+/**
+ * the created tasks, the main thread is not one; the run-time counters are
+ * the CPU time of the threads, the total the time since the first task, in us
+ *
+ * @return number of tasks filled in, 0 if they do not all fit
+ */
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *taskStatusArray, UBaseType_t arraySize, uint32_t *totalRunTime)
+{
+    UBaseType_t count = 0;
+
+    pthread_mutex_lock(&host_tasks_lock);
+
+    if( host_task_count <= arraySize ) {
+
+        for( struct host_task *task = host_tasks; task != NULL; task = task->next ) {
+
+            clockid_t cpuClock;
+            TaskStatus_t *status = &taskStatusArray[count++];
+
+            status->xHandle = task;
+            status->pcTaskName = task->name;
+            status->xTaskNumber = task->number;
+            status->eCurrentState = task == host_current_task ? eRunning : eBlocked;
+            status->uxCurrentPriority = task->priority;
+            status->ulRunTimeCounter = pthread_getcpuclockid(task->thread, &cpuClock) == 0 ? host_us(cpuClock) : 0;
+            status->usStackHighWaterMark = task->stackDepth;
+        }
+
+        if( totalRunTime != NULL ) {
+            *totalRunTime = host_us(CLOCK_MONOTONIC) - host_tasks_start;
+        }
+    }
+
+    pthread_mutex_unlock(&host_tasks_lock);
+
+    return(count);
+}
+
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    BaseType_t result = pdPASS;
+
+    pthread_mutex_lock(&task->notifyLock);
+
+    switch( action ) {
+        case eSetBits:
+            task->notifyValue |= value;
+            break;
+
+        case eIncrement:
+            task->notifyValue++;
+            break;
+
+        case eSetValueWithoutOverwrite:
+            if( task->notifyPending ) {
+                result = pdFAIL;
+                break;
+            }
+            task->notifyValue = value;
+            break;
+
+        case eSetValueWithOverwrite:
+            task->notifyValue = value;
+            break;
+
+        default:
+            break;
+    }
+
+    if( result == pdPASS ) {
+        task->notifyPending = true;
+        pthread_cond_signal(&task->notifyCond);
+    }
+
+    pthread_mutex_unlock(&task->notifyLock);
+
+    return(result);
+}
+
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              BaseType_t *higherPriorityTaskWoken)
+{
+    if( higherPriorityTaskWoken != NULL ) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+
+    return(xTaskNotify(task, value, action));
+}
+
+
+BaseType_t xTaskNotifyWait(uint32_t bitsToClearOnEntry, uint32_t bitsToClearOnExit,
+                           uint32_t *notificationValue, TickType_t ticksToWait)
+{
+    struct host_task *task = host_current_task;
+    struct timespec deadline;
+    BaseType_t result = pdFAIL;
+
+    host_deadline_from_ticks(&deadline, ticksToWait);
+
+    pthread_mutex_lock(&task->notifyLock);
+
+    if( !task->notifyPending ) {
+        task->notifyValue &= ~bitsToClearOnEntry;
+    }
+
+    while( !task->notifyPending && ticksToWait > 0 ) {
+        if( ticksToWait == portMAX_DELAY ) {
+            pthread_cond_wait(&task->notifyCond, &task->notifyLock);
+        } else if( pthread_cond_timedwait(&task->notifyCond, &task->notifyLock, &deadline) == ETIMEDOUT ) {
+            break;
+        }
+    }
+
+    if( notificationValue != NULL ) {
+        *notificationValue = task->notifyValue;
+    }
+
+    if( task->notifyPending ) {
+        task->notifyValue &= ~bitsToClearOnExit;
+        task->notifyPending = false;
+        result = pdPASS;
+    }
+
+    pthread_mutex_unlock(&task->notifyLock);
+
+    return(result);
+}
+
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    struct host_queue *queue = calloc(1, sizeof(struct host_queue));
+    if( queue == NULL ) {
+        return(NULL);
+    }
+
+    queue->items = calloc(length, itemSize > 0 ? itemSize : 1);
+    if( queue->items == NULL ) {
+        free(queue);
+        return(NULL);
+    }
+
+    queue->length = length;
+    queue->itemSize = itemSize;
+
+    pthread_mutex_init(&queue->lock, NULL);
+    host_cond_init(&queue->notEmpty);
+    host_cond_init(&queue->notFull);
+
+    return(queue);
+}
+
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    if( queue != NULL ) {
+        pthread_mutex_destroy(&queue->lock);
+        pthread_cond_destroy(&queue->notEmpty);
+        pthread_cond_destroy(&queue->notFull);
+        free(queue->items);
+        free(queue);
+    }
+}
+
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait)
+{
+    struct timespec deadline;
+    BaseType_t result = pdFAIL;
+
+    host_deadline_from_ticks(&deadline, ticksToWait);
+
+    pthread_mutex_lock(&queue->lock);
+
+    while( queue->count >= queue->length && ticksToWait > 0 ) {
+        if( ticksToWait == portMAX_DELAY ) {
+            pthread_cond_wait(&queue->notFull, &queue->lock);
+        } else if( pthread_cond_timedwait(&queue->notFull, &queue->lock, &deadline) == ETIMEDOUT ) {
+            break;
+        }
+    }
+
+    if( queue->count < queue->length ) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+
+        if( queue->itemSize > 0 && item != NULL ) {
+            memcpy(queue->items + tail * queue->itemSize, item, queue->itemSize);
+        }
+        queue->count++;
+        pthread_cond_signal(&queue->notEmpty);
+
+        result = pdPASS;
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return(result);
+}
+
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higherPriorityTaskWoken)
+{
+    if( higherPriorityTaskWoken != NULL ) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+
+    return(xQueueSend(queue, item, 0));
+}
+
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticksToWait)
+{
+    struct timespec deadline;
+    BaseType_t result = pdFAIL;
+
+    host_deadline_from_ticks(&deadline, ticksToWait);
+
+    pthread_mutex_lock(&queue->lock);
+
+    while( queue->count == 0 && ticksToWait > 0 ) {
+        if( ticksToWait == portMAX_DELAY ) {
+            pthread_cond_wait(&queue->notEmpty, &queue->lock);
+        } else if( pthread_cond_timedwait(&queue->notEmpty, &queue->lock, &deadline) == ETIMEDOUT ) {
+            break;
+        }
+    }
+
+    if( queue->count > 0 ) {
+        if( queue->itemSize > 0 && buffer != NULL ) {
+            memcpy(buffer, queue->items + queue->head * queue->itemSize, queue->itemSize);
+        }
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_signal(&queue->notFull);
+
+        result = pdPASS;
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return(result);
+}
+
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->head = 0;
+    queue->count = 0;
+    pthread_cond_broadcast(&queue->notFull);
+    pthread_mutex_unlock(&queue->lock);
+
+    return(pdPASS);
+}
+
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+
+    return(count);
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    // created empty, the same as FreeRTOS
+    return(xQueueCreate(1, 0));
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    // created available
+    SemaphoreHandle_t sem = xQueueCreate(1, 0);
+    if( sem != NULL ) {
+        xSemaphoreGive(sem);
+    }
+
+    return(sem);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+static void *host_task_entry(void *arg)
+{
+    host_current_task = (struct host_task *) arg;
+
+    host_current_task->taskCode(host_current_task->arg);
+
+    return(NULL);
+}
+
+
+static void host_deadline_from_ticks(struct timespec *deadline, TickType_t ticks)
+{
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+
+    if( ticks == portMAX_DELAY || ticks == 0 ) {
+        return;
+    }
+
+    uint64_t nsec = (uint64_t) ticks * (1000000000ULL / configTICK_RATE_HZ) + deadline->tv_nsec;
+    deadline->tv_sec += nsec / 1000000000ULL;
+    deadline->tv_nsec = nsec % 1000000000ULL;
+}
+
+
+// with host_tasks_lock held
+static void host_task_unlink(struct host_task *task)
+{
+    for( struct host_task **link = &host_tasks; *link != NULL; link = &(*link)->next ) {
+        if( *link == task ) {
+            *link = task->next;
+            host_task_count--;
+            return;
+        }
+    }
+}
+
+
+static uint32_t host_us(clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+
+    return((uint32_t) ((uint64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000));
+}
+
+
+// the deadlines are on the monotonic clock
+static void host_cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t condAttr;
+
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+}
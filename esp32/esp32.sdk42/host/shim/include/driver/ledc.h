@@ -0,0 +1,69 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_DRIVER_LEDC_H_
+#define _HOST_DRIVER_LEDC_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef enum {
+    LEDC_HIGH_SPEED_MODE = 0,
+    LEDC_LOW_SPEED_MODE,
+    LEDC_SPEED_MODE_MAX
+} ledc_mode_t;
+
+typedef enum {
+    LEDC_CHANNEL_0 = 0, LEDC_CHANNEL_1, LEDC_CHANNEL_2, LEDC_CHANNEL_3,
+    LEDC_CHANNEL_4, LEDC_CHANNEL_5, LEDC_CHANNEL_6, LEDC_CHANNEL_7,
+    LEDC_CHANNEL_MAX
+} ledc_channel_t;
+
+typedef enum {
+    LEDC_TIMER_0 = 0, LEDC_TIMER_1, LEDC_TIMER_2, LEDC_TIMER_3,
+    LEDC_TIMER_MAX
+} ledc_timer_t;
+
+typedef enum {
+    LEDC_TIMER_13_BIT = 13
+} ledc_timer_bit_t;
+
+typedef enum {
+    LEDC_FADE_NO_WAIT = 0,
+    LEDC_FADE_WAIT_DONE
+} ledc_fade_mode_t;
+
+typedef struct {
+    ledc_mode_t speed_mode;
+    ledc_timer_bit_t duty_resolution;
+    ledc_timer_t timer_num;
+    uint32_t freq_hz;
+} ledc_timer_config_t;
+
+typedef struct {
+    int gpio_num;
+    ledc_mode_t speed_mode;
+    ledc_channel_t channel;
+    ledc_timer_t timer_sel;
+    uint32_t duty;
+} ledc_channel_config_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+// Note: there is no PWM on the host, the fades end at once
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timerConf);
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledcConf);
+esp_err_t ledc_fade_func_install(int intrAllocFlags);
+esp_err_t ledc_set_fade_time_and_start(ledc_mode_t speedMode, ledc_channel_t channel, uint32_t targetDuty,
+                                       uint32_t maxFadeTimeMs, ledc_fade_mode_t fadeMode);
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_DRIVER_PERIPH_CTRL_H_
+#define _HOST_DRIVER_PERIPH_CTRL_H_
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef enum {
+    PERIPH_WIFI_MODULE = 0,
+    PERIPH_WIFI_BT_COMMON_MODULE
+} periph_module_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+// Note: a no-op on the host
+void periph_module_reset(periph_module_t periph);
+
+#endif
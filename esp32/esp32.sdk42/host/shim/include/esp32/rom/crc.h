@@ -0,0 +1,20 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_ESP32_ROM_CRC_H_
+#define _HOST_ESP32_ROM_CRC_H_
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+// the same little-endian CRC-32 as the ROM, crc32_le(0, ...) matches zlib crc32()
+uint32_t crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+#endif
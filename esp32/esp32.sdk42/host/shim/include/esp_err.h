@@ -0,0 +1,42 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_ESP_ERR_H_
+#define _HOST_ESP_ERR_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define ESP_OK                              0
+#define ESP_FAIL                            -1
+
+#define ESP_ERR_NO_MEM                      0x101
+#define ESP_ERR_INVALID_ARG                 0x102
+#define ESP_ERR_INVALID_STATE               0x103
+#define ESP_ERR_INVALID_SIZE                0x104
+#define ESP_ERR_NOT_FOUND                   0x105
+#define ESP_ERR_NOT_SUPPORTED               0x106
+#define ESP_ERR_TIMEOUT                     0x107
+
+#define ESP_ERROR_CHECK(x) do {                                                 \
+            esp_err_t __err_rc = (x);                                           \
+            if( __err_rc != ESP_OK ) {                                          \
+                fprintf(stderr, "ESP_ERROR_CHECK failed: 0x%x at %s:%d\n",      \
+                        __err_rc, __FILE__, __LINE__);                          \
+                abort();                                                        \
+            }                                                                   \
+        } while(0)
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef int esp_err_t;
+
+#endif
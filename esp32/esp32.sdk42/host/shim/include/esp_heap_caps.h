@@ -0,0 +1,31 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_ESP_HEAP_CAPS_H_
+#define _HOST_ESP_HEAP_CAPS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define MALLOC_CAP_EXEC                     (1 << 0)
+#define MALLOC_CAP_32BIT                    (1 << 1)
+#define MALLOC_CAP_8BIT                     (1 << 2)
+#define MALLOC_CAP_DMA                      (1 << 3)
+#define MALLOC_CAP_INTERNAL                 (1 << 11)
+#define MALLOC_CAP_DEFAULT                  (1 << 12)
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+#endif
@@ -0,0 +1,15 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_ESP_INT_WDT_H_
+#define _HOST_ESP_INT_WDT_H_
+
+// Note: included by the firmware sources, nothing is used by the host build
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_ESP_TASK_WDT_H_
+#define _HOST_ESP_TASK_WDT_H_
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/task.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+// Note: the host build has no task watchdog, these are no-ops
+esp_err_t esp_task_wdt_init(uint32_t timeout, bool panic);
+esp_err_t esp_task_wdt_add(TaskHandle_t handle);
+esp_err_t esp_task_wdt_reset(void);
+esp_err_t esp_task_wdt_delete(TaskHandle_t handle);
+
+#endif
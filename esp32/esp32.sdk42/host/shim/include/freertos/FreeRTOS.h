@@ -0,0 +1,63 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_FREERTOS_H_
+#define _HOST_FREERTOS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "esp_attr.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+// Note: the tick rate follows CONFIG_FREERTOS_HZ in sdkconfig
+#define configTICK_RATE_HZ                  100
+
+// the run-time stats are on, CONFIG_FREERTOS_USE_TRACE_FACILITY and
+// CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS in sdkconfig, counted in us as esp_timer does
+#define configUSE_TRACE_FACILITY            1
+#define configGENERATE_RUN_TIME_STATS       1
+#define portNUM_PROCESSORS                  2
+
+#define pdTRUE                              1
+#define pdFALSE                             0
+#define pdPASS                              pdTRUE
+#define pdFAIL                              pdFALSE
+
+#define portTICK_PERIOD_MS                  (1000 / configTICK_RATE_HZ)
+#define portTICK_RATE_MS                    portTICK_PERIOD_MS
+#define portMAX_DELAY                       ((TickType_t) 0xffffffffUL)
+#define pdMS_TO_TICKS(ms)                   ((TickType_t) (((TickType_t) (ms) * configTICK_RATE_HZ) / 1000))
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+// critical sections are mapped to a single process-wide recursive lock
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED        0
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+void host_enter_critical(void);
+void host_exit_critical(void);
+
+#define portENTER_CRITICAL(mux)             do { (void) (mux); host_enter_critical(); } while( 0 )
+#define portEXIT_CRITICAL(mux)              do { (void) (mux); host_exit_critical(); } while( 0 )
+#define portENTER_CRITICAL_ISR(mux)         do { (void) (mux); host_enter_critical(); } while( 0 )
+#define portEXIT_CRITICAL_ISR(mux)          do { (void) (mux); host_exit_critical(); } while( 0 )
+
+// the host "ISR" runs in the calling thread, there is nothing to switch to
+#define portYIELD_FROM_ISR()                do { } while( 0 )
+
+#endif
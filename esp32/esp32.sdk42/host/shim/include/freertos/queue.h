@@ -0,0 +1,31 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_FREERTOS_QUEUE_H_
+#define _HOST_FREERTOS_QUEUE_H_
+
+#include "freertos/FreeRTOS.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct host_queue *QueueHandle_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higherPriorityTaskWoken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticksToWait);
+BaseType_t xQueueReset(QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#define xQueueSendToBack(q, item, ticks)    xQueueSend(q, item, ticks)
+
+#endif
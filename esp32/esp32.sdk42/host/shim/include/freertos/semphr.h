@@ -0,0 +1,31 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_FREERTOS_SEMPHR_H_
+#define _HOST_FREERTOS_SEMPHR_H_
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+// semaphores are zero-sized queues, the same as FreeRTOS does it
+typedef QueueHandle_t SemaphoreHandle_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+
+#define xSemaphoreTake(sem, ticks)          xQueueReceive(sem, NULL, ticks)
+#define xSemaphoreGive(sem)                 xQueueSend(sem, NULL, 0)
+#define xSemaphoreGiveFromISR(sem, woken)   xQueueSendFromISR(sem, NULL, woken)
+#define vSemaphoreDelete(sem)               vQueueDelete(sem)
+
+#endif
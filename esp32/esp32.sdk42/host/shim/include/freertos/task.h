@@ -0,0 +1,70 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_FREERTOS_TASK_H_
+#define _HOST_FREERTOS_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+
+typedef enum {
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+
+// the fields the firmware reads, the run-time counter is the CPU time of the thread in us
+typedef struct {
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber;
+    eTaskState eCurrentState;
+    UBaseType_t uxCurrentPriority;
+    uint32_t ulRunTimeCounter;
+    uint32_t usStackHighWaterMark;
+} TaskStatus_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+BaseType_t xTaskCreate(TaskFunction_t taskCode, const char *name, uint32_t stackDepth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *createdTask);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t taskCode, const char *name, uint32_t stackDepth,
+                                   void *arg, UBaseType_t priority, TaskHandle_t *createdTask, BaseType_t coreId);
+void vTaskDelete(TaskHandle_t task);
+void vTaskSuspend(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+UBaseType_t uxTaskGetNumberOfTasks(void);
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *taskStatusArray, UBaseType_t arraySize, uint32_t *totalRunTime);
+
+// Note: only created tasks have a notification value, not the main thread
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              BaseType_t *higherPriorityTaskWoken);
+BaseType_t xTaskNotifyWait(uint32_t bitsToClearOnEntry, uint32_t bitsToClearOnExit,
+                           uint32_t *notificationValue, TickType_t ticksToWait);
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_SHIM_H_
+#define _HOST_SHIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define HOST_GPIO_EDGE_LOG_SIZE             1024
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct {
+    int64_t timestamp;                  // esp_timer_get_time() of the level change
+    uint8_t gpio;
+    uint8_t level;
+} host_gpio_edge_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+// host-only helpers of the shim, never called by the firmware sources
+void host_gpio_edge_reset(void);
+uint32_t host_gpio_edge_get(host_gpio_edge_t *edges, uint32_t maxEdges);
+void host_gpio_edge_dump(void);
+void host_gpio_input(int gpio, uint32_t level);
+void host_mqtt_drop(const char *clientId, uint32_t downMs);
+void host_clock_step(int64_t stepUs);
+
+#endif
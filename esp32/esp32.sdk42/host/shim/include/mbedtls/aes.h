@@ -0,0 +1,38 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_MBEDTLS_AES_H_
+#define _HOST_MBEDTLS_AES_H_
+
+#include <stdint.h>
+#include <openssl/aes.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define ESP_AES_ENCRYPT                     1
+#define ESP_AES_DECRYPT                     0
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+// the ESP32 hardware AES API, backed by OpenSSL libcrypto on the host
+typedef struct {
+    uint8_t key[32];
+    unsigned int key_bits;
+    AES_KEY enc;
+    AES_KEY dec;
+} esp_aes_context;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+void esp_aes_init(esp_aes_context *ctx);
+void esp_aes_free(esp_aes_context *ctx);
+int esp_aes_setkey(esp_aes_context *ctx, const unsigned char *key, unsigned int keybits);
+int esp_aes_crypt_ecb(esp_aes_context *ctx, int mode, const unsigned char input[16], unsigned char output[16]);
+
+#endif
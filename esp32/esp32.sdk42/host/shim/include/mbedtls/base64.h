@@ -0,0 +1,24 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_MBEDTLS_BASE64_H_
+#define _HOST_MBEDTLS_BASE64_H_
+
+#include <stddef.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL     -0x002A
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+int mbedtls_base64_encode(unsigned char *dst, size_t dlen, size_t *olen,
+                          const unsigned char *src, size_t slen);
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_MQTT_CLIENT_H_
+#define _HOST_MQTT_CLIENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "tcpip_adapter.h"     // the ESP-IDF header pulls it in through the transport layer
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct esp_mqtt_client *esp_mqtt_client_handle_t;
+
+typedef enum {
+    MQTT_EVENT_ANY = -1,
+    MQTT_EVENT_ERROR = 0,
+    MQTT_EVENT_CONNECTED,
+    MQTT_EVENT_DISCONNECTED,
+    MQTT_EVENT_SUBSCRIBED,
+    MQTT_EVENT_UNSUBSCRIBED,
+    MQTT_EVENT_PUBLISHED,
+    MQTT_EVENT_DATA,
+    MQTT_EVENT_BEFORE_CONNECT,
+    MQTT_EVENT_DELETED
+} esp_mqtt_event_id_t;
+
+typedef enum {
+    MQTT_CONNECTION_ACCEPTED = 0,
+    MQTT_CONNECTION_REFUSE_PROTOCOL,
+    MQTT_CONNECTION_REFUSE_ID_REJECTED,
+    MQTT_CONNECTION_REFUSE_SERVER_UNAVAILABLE,
+    MQTT_CONNECTION_REFUSE_BAD_USERNAME,
+    MQTT_CONNECTION_REFUSE_NOT_AUTHORIZED
+} esp_mqtt_connect_return_code_t;
+
+typedef enum {
+    MQTT_ERROR_TYPE_NONE = 0,
+    MQTT_ERROR_TYPE_ESP_TLS,
+    MQTT_ERROR_TYPE_CONNECTION_REFUSED
+} esp_mqtt_error_type_t;
+
+typedef struct {
+    esp_err_t esp_tls_last_esp_err;
+    int esp_tls_stack_err;
+    int esp_tls_cert_verify_flags;
+    esp_mqtt_error_type_t error_type;
+    esp_mqtt_connect_return_code_t connect_return_code;
+    int esp_transport_sock_errno;
+} esp_mqtt_error_codes_t;
+
+typedef struct {
+    esp_mqtt_event_id_t event_id;
+    esp_mqtt_client_handle_t client;
+    void *user_context;
+    char *data;                         // not null-terminated, the same as ESP-IDF
+    int data_len;
+    int total_data_len;
+    int current_data_offset;
+    char *topic;                        // not null-terminated, NULL on the following fragments
+    int topic_len;
+    int msg_id;
+    int session_present;
+    esp_mqtt_error_codes_t *error_handle;
+    bool retain;
+} esp_mqtt_event_t;
+
+typedef esp_mqtt_event_t *esp_mqtt_event_handle_t;
+
+typedef esp_err_t (*mqtt_event_callback_t)(esp_mqtt_event_handle_t event);
+
+typedef enum {
+    MQTT_TRANSPORT_UNKNOWN = 0x0,
+    MQTT_TRANSPORT_OVER_TCP,
+    MQTT_TRANSPORT_OVER_SSL,
+    MQTT_TRANSPORT_OVER_WS,
+    MQTT_TRANSPORT_OVER_WSS
+} esp_mqtt_transport_t;
+
+typedef struct {
+    mqtt_event_callback_t event_handle;
+    const char *host;
+    const char *uri;
+    uint32_t port;
+    const char *client_id;
+    const char *username;
+    const char *password;
+    const char *lwt_topic;
+    const char *lwt_msg;
+    int lwt_qos;
+    int lwt_retain;
+    int lwt_msg_len;
+    int disable_clean_session;
+    int keepalive;
+    bool disable_auto_reconnect;
+    void *user_context;
+    int task_prio;
+    int task_stack;
+    int buffer_size;
+    const char *cert_pem;
+    size_t cert_len;
+    const char *client_cert_pem;
+    size_t client_cert_len;
+    const char *client_key_pem;
+    size_t client_key_len;
+    bool use_global_ca_store;
+    esp_mqtt_transport_t transport;
+    int refresh_connection_after_ms;
+    int reconnect_timeout_ms;
+    int out_buffer_size;
+    bool skip_cert_common_name_check;
+    int network_timeout_ms;
+    bool disable_keepalive;
+} esp_mqtt_client_config_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+// Note: the host client talks plain MQTT 3.1.1 to the broker given by the
+//       OPEN_TLS_HOST_BROKER environment variable ("mqtt://127.0.0.1:1883"),
+//       or to the in-process loopback broker if it is not set.
+//       The uri and the certificates in the config are ignored.
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config);
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client);
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char *topic, int qos);
+int esp_mqtt_client_unsubscribe(esp_mqtt_client_handle_t client, const char *topic);
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic, const char *data,
+                            int len, int qos, int retain);
+
+#endif
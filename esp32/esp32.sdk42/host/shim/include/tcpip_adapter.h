@@ -0,0 +1,39 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _HOST_TCPIP_ADAPTER_H_
+#define _HOST_TCPIP_ADAPTER_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef enum {
+    TCPIP_ADAPTER_IF_STA = 0,
+    TCPIP_ADAPTER_IF_AP,
+    TCPIP_ADAPTER_IF_ETH,
+    TCPIP_ADAPTER_IF_MAX
+} tcpip_adapter_if_t;
+
+typedef struct {
+    uint32_t addr;
+} esp_ip4_addr_t;
+
+typedef struct {
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gw;
+} tcpip_adapter_ip_info_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function
+esp_err_t tcpip_adapter_get_ip_info(tcpip_adapter_if_t tcpipIf, tcpip_adapter_ip_info_t *ipInfo);
+
+#endif
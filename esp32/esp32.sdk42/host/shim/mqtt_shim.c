@@ -0,0 +1,1052 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mqtt_client.h"
+#include "host_shim.h"
+
+#include "util.h"
+
+static const char *TAG = "HOST_MQTT";
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define HOST_MQTT_BROKER_ENV                "OPEN_TLS_HOST_BROKER"
+#define HOST_MQTT_MAX_CLIENTS               8
+#define HOST_MQTT_MAX_SUBSCRIPTIONS         8
+#define HOST_MQTT_MAX_RETAINED              8
+#define HOST_MQTT_MAX_WILL_SIZE             128     // will topic and will message each
+#define HOST_MQTT_DEFAULT_BUFFER_SIZE       1024
+#define HOST_MQTT_DEFAULT_KEEPALIVE         120         // in seconds
+#define HOST_MQTT_DEFAULT_RECONNECT_TIME    10000       // in ms
+#define HOST_MQTT_POLL_TIME                 100         // in ms
+
+// MQTT 3.1.1 control packet types
+#define HOST_MQTT_CONNECT                   0x10
+#define HOST_MQTT_CONNACK                   0x20
+#define HOST_MQTT_PUBLISH                   0x30
+#define HOST_MQTT_PUBACK                    0x40
+#define HOST_MQTT_SUBSCRIBE                 0x82
+#define HOST_MQTT_SUBACK                    0x90
+#define HOST_MQTT_UNSUBSCRIBE               0xA2
+#define HOST_MQTT_UNSUBACK                  0xB0
+#define HOST_MQTT_PINGREQ                   0xC0
+#define HOST_MQTT_PINGRESP                  0xD0
+#define HOST_MQTT_DISCONNECT                0xE0
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef enum {
+    HOST_MQTT_ITEM_DATA = 0,
+    HOST_MQTT_ITEM_SUBACK,
+    HOST_MQTT_ITEM_UNSUBACK,
+    HOST_MQTT_ITEM_PUBACK,
+    HOST_MQTT_ITEM_DROP,
+    HOST_MQTT_ITEM_STOP
+} host_mqtt_item_type_t;
+
+// a pending event of the loopback broker
+typedef struct host_mqtt_item {
+    struct host_mqtt_item *next;
+    host_mqtt_item_type_t type;
+    int msgId;
+    bool retain;
+    char *topic;
+    int topicLen;
+    char *data;
+    int dataLen;
+} host_mqtt_item_t;
+
+// a retained message of the loopback broker
+typedef struct {
+    char *topic;
+    int topicLen;
+    char *data;
+    int dataLen;
+} host_mqtt_retained_t;
+
+struct esp_mqtt_client {
+    esp_mqtt_client_config_t config;
+    char clientId[64];
+
+    // broker selection
+    bool useTcp;
+    char brokerHost[64];
+    char brokerPort[8];
+
+    // task state
+    pthread_t task;
+    volatile bool running;
+    volatile bool connected;
+
+    // loopback inbox
+    pthread_mutex_t lock;
+    pthread_cond_t inboxReady;
+    host_mqtt_item_t *inboxHead;
+    host_mqtt_item_t *inboxTail;
+    char *subscriptions[HOST_MQTT_MAX_SUBSCRIPTIONS];
+
+    // tcp transport
+    int sock;
+    pthread_mutex_t sendLock;
+    int64_t lastSendTime;
+
+    int nextMsgId;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static pthread_mutex_t host_mqtt_broker_lock = PTHREAD_MUTEX_INITIALIZER;
+static esp_mqtt_client_handle_t host_mqtt_broker_clients[HOST_MQTT_MAX_CLIENTS];
+static host_mqtt_retained_t host_mqtt_broker_retained[HOST_MQTT_MAX_RETAINED];
+
+///////////////////////////////////////////////////////////////////////////////////
+// local functions
+static void *host_mqtt_task(void *arg);
+static void host_mqtt_loopback_run(esp_mqtt_client_handle_t client);
+static void host_mqtt_tcp_run(esp_mqtt_client_handle_t client);
+static void host_mqtt_dispatch(esp_mqtt_client_handle_t client, esp_mqtt_event_t *event);
+static void host_mqtt_dispatch_simple(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t eventId, int msgId);
+static void host_mqtt_deliver_data(esp_mqtt_client_handle_t client, const char *topic, int topicLen,
+                                   const char *data, int dataLen, bool retain);
+static void host_mqtt_inbox_push(esp_mqtt_client_handle_t client, host_mqtt_item_type_t type, int msgId,
+                                 const char *topic, int topicLen, const char *data, int dataLen, bool retain);
+static bool host_mqtt_topic_match(const char *filter, const char *topic, int topicLen);
+static void host_mqtt_broker_join(esp_mqtt_client_handle_t client);
+static void host_mqtt_broker_leave(esp_mqtt_client_handle_t client);
+static void host_mqtt_broker_route(const char *topic, int topicLen, const char *data, int dataLen, bool retain);
+static void host_mqtt_broker_retain(const char *topic, int topicLen, const char *data, int dataLen);
+static int host_mqtt_next_msg_id(esp_mqtt_client_handle_t client);
+static int host_mqtt_tcp_send_packet(esp_mqtt_client_handle_t client, uint8_t type,
+                                     const uint8_t *body, uint32_t bodyLen);
+static int host_mqtt_tcp_read_packet(int sock, uint8_t *type, uint8_t **body, uint32_t *bodyLen);
+static uint32_t host_mqtt_put_string(uint8_t *buf, const char *str, uint32_t len);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+/**
+ * create a client, the config strings are duplicated the same as ESP-IDF
+ */
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config)
+{
+    esp_mqtt_client_handle_t client = calloc(1, sizeof(struct esp_mqtt_client));
+    if( client == NULL ) {
+        return(NULL);
+    }
+
+    client->config = *config;
+    if( client->config.buffer_size <= 0 ) {
+        client->config.buffer_size = HOST_MQTT_DEFAULT_BUFFER_SIZE;
+    }
+    if( client->config.keepalive <= 0 ) {
+        client->config.keepalive = HOST_MQTT_DEFAULT_KEEPALIVE;
+    }
+    if( client->config.reconnect_timeout_ms <= 0 ) {
+        client->config.reconnect_timeout_ms = HOST_MQTT_DEFAULT_RECONNECT_TIME;
+    }
+
+    if( config->client_id != NULL ) {
+        strncpy(client->clientId, config->client_id, sizeof(client->clientId) - 1);
+    } else {
+        snprintf(client->clientId, sizeof(client->clientId), "host_%p", (void *) client);
+    }
+    client->config.client_id = client->clientId;
+
+    // "mqtt://host:port" selects a real broker, otherwise use the loopback one
+    const char *broker = getenv(HOST_MQTT_BROKER_ENV);
+    if( broker != NULL && !strncmp(broker, "mqtt://", 7) ) {
+
+        const char *hostStart = broker + 7;
+        const char *portStart = strchr(hostStart, ':');
+        size_t hostLen = portStart != NULL ? (size_t) (portStart - hostStart) : strlen(hostStart);
+
+        if( hostLen >= sizeof(client->brokerHost) ) {
+            hostLen = sizeof(client->brokerHost) - 1;
+        }
+        memcpy(client->brokerHost, hostStart, hostLen);
+        snprintf(client->brokerPort, sizeof(client->brokerPort), "%s", portStart != NULL ? portStart + 1 : "1883");
+        client->useTcp = true;
+    }
+
+    client->sock = -1;
+    pthread_mutex_init(&client->lock, NULL);
+    pthread_mutex_init(&client->sendLock, NULL);
+    pthread_cond_init(&client->inboxReady, NULL);
+
+    return(client);
+}
+
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client)
+{
+    if( client == NULL || client->running ) {
+        return(ESP_ERR_INVALID_STATE);
+    }
+
+    client->running = true;
+    if( pthread_create(&client->task, NULL, host_mqtt_task, client) != 0 ) {
+        client->running = false;
+        return(ESP_FAIL);
+    }
+
+    return(ESP_OK);
+}
+
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client)
+{
+    if( client == NULL || !client->running ) {
+        return(ESP_ERR_INVALID_STATE);
+    }
+
+    client->running = false;
+
+    if( client->useTcp ) {
+        pthread_mutex_lock(&client->sendLock);
+        if( client->sock >= 0 ) {
+            uint8_t disconnect[2] = { HOST_MQTT_DISCONNECT, 0 };
+            send(client->sock, disconnect, sizeof(disconnect), MSG_NOSIGNAL);
+            shutdown(client->sock, SHUT_RDWR);
+        }
+        pthread_mutex_unlock(&client->sendLock);
+    } else {
+        host_mqtt_inbox_push(client, HOST_MQTT_ITEM_STOP, 0, NULL, 0, NULL, 0, false);
+    }
+
+    pthread_join(client->task, NULL);
+
+    return(ESP_OK);
+}
+
+
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client)
+{
+    if( client == NULL ) {
+        return(ESP_ERR_INVALID_ARG);
+    }
+
+    if( client->running ) {
+        esp_mqtt_client_stop(client);
+    }
+
+    for( int sIdx = 0; sIdx < HOST_MQTT_MAX_SUBSCRIPTIONS; sIdx++ ) {
+        free(client->subscriptions[sIdx]);
+    }
+
+    pthread_mutex_destroy(&client->lock);
+    pthread_mutex_destroy(&client->sendLock);
+    pthread_cond_destroy(&client->inboxReady);
+    free(client);
+
+    return(ESP_OK);
+}
+
+
+/**
+ * @return message id of the subscribe message, -1 on failure
+ */
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char *topic, int qos)
+{
+    if( client == NULL || !client->connected ) {
+        return(-1);
+    }
+
+    int msgId = host_mqtt_next_msg_id(client);
+
+    if( client->useTcp ) {
+
+        uint32_t topicLen = strlen(topic);
+        uint8_t *body = malloc(2 + 2 + topicLen + 1);
+        if( body == NULL ) {
+            return(-1);
+        }
+
+        body[0] = UTIL_HI_UINT16(msgId);
+        body[1] = UTIL_LO_UINT16(msgId);
+        uint32_t bodyLen = 2 + host_mqtt_put_string(body + 2, topic, topicLen);
+        body[bodyLen++] = (uint8_t) qos;
+
+        int result = host_mqtt_tcp_send_packet(client, HOST_MQTT_SUBSCRIBE, body, bodyLen);
+        free(body);
+
+        return(result == 0 ? msgId : -1);
+    }
+
+    // loopback broker
+    pthread_mutex_lock(&host_mqtt_broker_lock);
+
+    int freeIdx = -1;
+    bool exists = false;
+    for( int sIdx = 0; sIdx < HOST_MQTT_MAX_SUBSCRIPTIONS; sIdx++ ) {
+        if( client->subscriptions[sIdx] == NULL ) {
+            if( freeIdx < 0 ) {
+                freeIdx = sIdx;
+            }
+        } else if( !strcmp(client->subscriptions[sIdx], topic) ) {
+            exists = true;
+        }
+    }
+
+    if( !exists && freeIdx >= 0 ) {
+        client->subscriptions[freeIdx] = strdup(topic);
+    }
+
+    pthread_mutex_unlock(&host_mqtt_broker_lock);
+
+    if( !exists && freeIdx < 0 ) {
+        return(-1);
+    }
+
+    host_mqtt_inbox_push(client, HOST_MQTT_ITEM_SUBACK, msgId, NULL, 0, NULL, 0, false);
+
+    // the retained messages matching the new filter follow the SUBACK
+    pthread_mutex_lock(&host_mqtt_broker_lock);
+    for( int rIdx = 0; rIdx < HOST_MQTT_MAX_RETAINED; rIdx++ ) {
+
+        host_mqtt_retained_t *retained = &host_mqtt_broker_retained[rIdx];
+        if( retained->topic != NULL && host_mqtt_topic_match(topic, retained->topic, retained->topicLen) ) {
+            host_mqtt_inbox_push(client, HOST_MQTT_ITEM_DATA, 0, retained->topic, retained->topicLen,
+                                 retained->data, retained->dataLen, true);
+        }
+    }
+    pthread_mutex_unlock(&host_mqtt_broker_lock);
+
+    return(msgId);
+}
+
+
+int esp_mqtt_client_unsubscribe(esp_mqtt_client_handle_t client, const char *topic)
+{
+    if( client == NULL || !client->connected ) {
+        return(-1);
+    }
+
+    int msgId = host_mqtt_next_msg_id(client);
+
+    if( client->useTcp ) {
+
+        uint32_t topicLen = strlen(topic);
+        uint8_t *body = malloc(2 + 2 + topicLen);
+        if( body == NULL ) {
+            return(-1);
+        }
+
+        body[0] = UTIL_HI_UINT16(msgId);
+        body[1] = UTIL_LO_UINT16(msgId);
+        uint32_t bodyLen = 2 + host_mqtt_put_string(body + 2, topic, topicLen);
+
+        int result = host_mqtt_tcp_send_packet(client, HOST_MQTT_UNSUBSCRIBE, body, bodyLen);
+        free(body);
+
+        return(result == 0 ? msgId : -1);
+    }
+
+    // loopback broker
+    pthread_mutex_lock(&host_mqtt_broker_lock);
+    for( int sIdx = 0; sIdx < HOST_MQTT_MAX_SUBSCRIPTIONS; sIdx++ ) {
+        if( client->subscriptions[sIdx] != NULL && !strcmp(client->subscriptions[sIdx], topic) ) {
+            free(client->subscriptions[sIdx]);
+            client->subscriptions[sIdx] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&host_mqtt_broker_lock);
+
+    host_mqtt_inbox_push(client, HOST_MQTT_ITEM_UNSUBACK, msgId, NULL, 0, NULL, 0, false);
+
+    return(msgId);
+}
+
+
+/**
+ * @return message id of the publish message (0 for QoS 0), -1 on failure
+ */
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic, const char *data,
+                            int len, int qos, int retain)
+{
+    if( client == NULL || !client->connected ) {
+        return(-1);
+    }
+
+    if( len <= 0 && data != NULL ) {
+        len = strlen(data);
+    }
+
+    int msgId = qos > 0 ? host_mqtt_next_msg_id(client) : 0;
+    uint32_t topicLen = strlen(topic);
+
+    if( client->useTcp ) {
+
+        uint8_t *body = malloc(2 + topicLen + 2 + len);
+        if( body == NULL ) {
+            return(-1);
+        }
+
+        uint32_t bodyLen = host_mqtt_put_string(body, topic, topicLen);
+        if( qos > 0 ) {
+            body[bodyLen++] = UTIL_HI_UINT16(msgId);
+            body[bodyLen++] = UTIL_LO_UINT16(msgId);
+        }
+        memcpy(body + bodyLen, data, len);
+        bodyLen += len;
+
+        uint8_t type = HOST_MQTT_PUBLISH | ((qos > 0 ? 1 : 0) << 1) | (retain ? 1 : 0);
+        int result = host_mqtt_tcp_send_packet(client, type, body, bodyLen);
+        free(body);
+
+        return(result == 0 ? msgId : -1);
+    }
+
+    // loopback broker, including the publisher itself if it subscribed the topic
+    host_mqtt_broker_route(topic, topicLen, data, len, retain);
+
+    if( qos > 0 ) {
+        host_mqtt_inbox_push(client, HOST_MQTT_ITEM_PUBACK, msgId, NULL, 0, NULL, 0, false);
+    }
+
+    return(msgId);
+}
+
+/**
+ * cut the connection of a loopback client without a DISCONNECT, as a lost network does.
+ * the broker publishes its will, and the client connects again after downMs.
+ * clients of a real broker are not affected
+ */
+void host_mqtt_drop(const char *clientId, uint32_t downMs)
+{
+    pthread_mutex_lock(&host_mqtt_broker_lock);
+    for( int cIdx = 0; cIdx < HOST_MQTT_MAX_CLIENTS; cIdx++ ) {
+
+        esp_mqtt_client_handle_t target = host_mqtt_broker_clients[cIdx];
+        if( target != NULL && !strcmp(target->clientId, clientId) ) {
+            host_mqtt_inbox_push(target, HOST_MQTT_ITEM_DROP, (int) downMs, NULL, 0, NULL, 0, false);
+        }
+    }
+    pthread_mutex_unlock(&host_mqtt_broker_lock);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+/**
+ * the MQTT task of a client, all the events are dispatched from here
+ */
+static void *host_mqtt_task(void *arg)
+{
+    esp_mqtt_client_handle_t client = (esp_mqtt_client_handle_t) arg;
+
+    if( client->useTcp ) {
+        host_mqtt_tcp_run(client);
+    } else {
+        host_mqtt_loopback_run(client);
+    }
+
+    return(NULL);
+}
+
+
+static void host_mqtt_loopback_run(esp_mqtt_client_handle_t client)
+{
+    host_mqtt_dispatch_simple(client, MQTT_EVENT_BEFORE_CONNECT, 0);
+    host_mqtt_broker_join(client);
+
+    client->connected = true;
+    host_mqtt_dispatch_simple(client, MQTT_EVENT_CONNECTED, 0);
+
+    while( client->running ) {
+
+        // wait for the next item
+        pthread_mutex_lock(&client->lock);
+        while( client->inboxHead == NULL ) {
+            pthread_cond_wait(&client->inboxReady, &client->lock);
+        }
+        host_mqtt_item_t *item = client->inboxHead;
+        client->inboxHead = item->next;
+        if( client->inboxHead == NULL ) {
+            client->inboxTail = NULL;
+        }
+        pthread_mutex_unlock(&client->lock);
+
+        switch( item->type ) {
+            case HOST_MQTT_ITEM_DATA:
+                host_mqtt_deliver_data(client, item->topic, item->topicLen, item->data, item->dataLen, item->retain);
+                break;
+
+            case HOST_MQTT_ITEM_SUBACK:
+                host_mqtt_dispatch_simple(client, MQTT_EVENT_SUBSCRIBED, item->msgId);
+                break;
+
+            case HOST_MQTT_ITEM_UNSUBACK:
+                host_mqtt_dispatch_simple(client, MQTT_EVENT_UNSUBSCRIBED, item->msgId);
+                break;
+
+            case HOST_MQTT_ITEM_PUBACK:
+                host_mqtt_dispatch_simple(client, MQTT_EVENT_PUBLISHED, item->msgId);
+                break;
+
+            case HOST_MQTT_ITEM_DROP:
+                // a clean session, the subscriptions are gone with the connection
+                host_mqtt_broker_leave(client);
+                client->connected = false;
+
+                if( client->config.lwt_topic != NULL ) {
+
+                    const char *willMsg = client->config.lwt_msg != NULL ? client->config.lwt_msg : "";
+                    int willLen = client->config.lwt_msg_len > 0 ? client->config.lwt_msg_len : (int) strlen(willMsg);
+
+                    host_mqtt_broker_route(client->config.lwt_topic, strlen(client->config.lwt_topic),
+                                           willMsg, willLen, client->config.lwt_retain != 0);
+                }
+
+                host_mqtt_dispatch_simple(client, MQTT_EVENT_DISCONNECTED, 0);
+                vTaskDelay(pdMS_TO_TICKS(item->msgId));
+
+                host_mqtt_dispatch_simple(client, MQTT_EVENT_BEFORE_CONNECT, 0);
+                host_mqtt_broker_join(client);
+                client->connected = true;
+                host_mqtt_dispatch_simple(client, MQTT_EVENT_CONNECTED, 0);
+                break;
+
+            case HOST_MQTT_ITEM_STOP:
+            default:
+                break;
+        }
+
+        free(item->topic);
+        free(item->data);
+        free(item);
+    }
+
+    host_mqtt_broker_leave(client);
+
+    client->connected = false;
+}
+
+
+static void host_mqtt_tcp_run(esp_mqtt_client_handle_t client)
+{
+    while( client->running ) {
+
+        struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+        struct addrinfo *addrList = NULL;
+        int sock = -1;
+
+        host_mqtt_dispatch_simple(client, MQTT_EVENT_BEFORE_CONNECT, 0);
+
+        if( getaddrinfo(client->brokerHost, client->brokerPort, &hints, &addrList) == 0 ) {
+            for( struct addrinfo *addr = addrList; addr != NULL; addr = addr->ai_next ) {
+                sock = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+                if( sock >= 0 && connect(sock, addr->ai_addr, addr->ai_addrlen) == 0 ) {
+                    break;
+                }
+                if( sock >= 0 ) {
+                    close(sock);
+                    sock = -1;
+                }
+            }
+            freeaddrinfo(addrList);
+        }
+
+        bool accepted = false;
+        esp_mqtt_error_codes_t errorCodes = { 0 };
+
+        if( sock >= 0 ) {
+
+            int noDelay = 1;
+            setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+            pthread_mutex_lock(&client->sendLock);
+            client->sock = sock;
+            pthread_mutex_unlock(&client->sendLock);
+
+            // CONNECT, MQTT 3.1.1 with clean session and the will if one is set
+            uint32_t idLen = strlen(client->clientId);
+            const char *willTopic = client->config.lwt_topic;
+            const char *willMsg = client->config.lwt_msg != NULL ? client->config.lwt_msg : "";
+            uint32_t willTopicLen = willTopic != NULL ? strlen(willTopic) : 0;
+            uint32_t willLen = client->config.lwt_msg_len > 0 ? (uint32_t) client->config.lwt_msg_len : strlen(willMsg);
+
+            bool withWill = willTopic != NULL && willTopicLen <= HOST_MQTT_MAX_WILL_SIZE && willLen <= HOST_MQTT_MAX_WILL_SIZE;
+
+            uint8_t flags = client->config.disable_clean_session ? 0x00 : 0x02;
+            if( withWill ) {
+                flags |= 0x04 | ((client->config.lwt_qos & 0x03) << 3) | (client->config.lwt_retain ? 0x20 : 0x00);
+            }
+
+            uint8_t connectBody[10 + 2 + sizeof(client->clientId) + 2 + HOST_MQTT_MAX_WILL_SIZE + 2 + HOST_MQTT_MAX_WILL_SIZE];
+            uint32_t bodyLen = host_mqtt_put_string(connectBody, "MQTT", 4);
+            connectBody[bodyLen++] = 4;                         // protocol level
+            connectBody[bodyLen++] = flags;
+            connectBody[bodyLen++] = UTIL_HI_UINT16(client->config.keepalive);
+            connectBody[bodyLen++] = UTIL_LO_UINT16(client->config.keepalive);
+            bodyLen += host_mqtt_put_string(connectBody + bodyLen, client->clientId, idLen);
+            if( withWill ) {
+                bodyLen += host_mqtt_put_string(connectBody + bodyLen, willTopic, willTopicLen);
+                bodyLen += host_mqtt_put_string(connectBody + bodyLen, willMsg, willLen);
+            }
+
+            uint8_t type;
+            uint8_t *body = NULL;
+            uint32_t respLen = 0;
+
+            if( host_mqtt_tcp_send_packet(client, HOST_MQTT_CONNECT, connectBody, bodyLen) == 0 &&
+                host_mqtt_tcp_read_packet(sock, &type, &body, &respLen) == 0 &&
+                type == HOST_MQTT_CONNACK && respLen >= 2 ) {
+
+                if( body[1] == MQTT_CONNECTION_ACCEPTED ) {
+                    accepted = true;
+                } else {
+                    errorCodes.error_type = MQTT_ERROR_TYPE_CONNECTION_REFUSED;
+                    errorCodes.connect_return_code = body[1];
+                }
+            } else {
+                errorCodes.error_type = MQTT_ERROR_TYPE_ESP_TLS;
+                errorCodes.esp_transport_sock_errno = errno;
+            }
+
+            if( accepted ) {
+                esp_mqtt_event_t event = { 0 };
+                event.event_id = MQTT_EVENT_CONNECTED;
+                event.session_present = body[0] & 0x01;
+
+                client->connected = true;
+                host_mqtt_dispatch(client, &event);
+            }
+
+            free(body);
+
+        } else {
+            errorCodes.error_type = MQTT_ERROR_TYPE_ESP_TLS;
+            errorCodes.esp_transport_sock_errno = errno;
+        }
+
+        if( !accepted ) {
+            esp_mqtt_event_t event = { 0 };
+            event.event_id = MQTT_EVENT_ERROR;
+            event.error_handle = &errorCodes;
+            host_mqtt_dispatch(client, &event);
+        }
+
+        // receiving loop
+        while( accepted && client->running ) {
+
+            struct pollfd pfd = { .fd = sock, .events = POLLIN };
+            int ready = poll(&pfd, 1, HOST_MQTT_POLL_TIME);
+
+            if( ready < 0 && errno != EINTR ) {
+                break;
+            }
+
+            if( ready > 0 ) {
+
+                uint8_t type;
+                uint8_t *body = NULL;
+                uint32_t bodyLen = 0;
+
+                if( host_mqtt_tcp_read_packet(sock, &type, &body, &bodyLen) != 0 ) {
+                    break;
+                }
+
+                if( (type & 0xF0) == HOST_MQTT_PUBLISH && bodyLen >= 2 ) {
+
+                    int qos = (type >> 1) & 0x03;
+                    uint32_t topicLen = (body[0] << 8) | body[1];
+                    uint32_t offset = 2 + topicLen + (qos > 0 ? 2 : 0);
+
+                    if( offset <= bodyLen ) {
+
+                        if( qos > 0 ) {
+                            uint8_t ack[2] = { body[2 + topicLen], body[3 + topicLen] };
+                            host_mqtt_tcp_send_packet(client, HOST_MQTT_PUBACK, ack, sizeof(ack));
+                        }
+
+                        host_mqtt_deliver_data(client, (char *) body + 2, topicLen,
+                                               (char *) body + offset, bodyLen - offset, type & 0x01);
+                    }
+
+                } else if( type == HOST_MQTT_SUBACK && bodyLen >= 2 ) {
+                    host_mqtt_dispatch_simple(client, MQTT_EVENT_SUBSCRIBED, (body[0] << 8) | body[1]);
+
+                } else if( type == HOST_MQTT_UNSUBACK && bodyLen >= 2 ) {
+                    host_mqtt_dispatch_simple(client, MQTT_EVENT_UNSUBSCRIBED, (body[0] << 8) | body[1]);
+
+                } else if( type == HOST_MQTT_PUBACK && bodyLen >= 2 ) {
+                    host_mqtt_dispatch_simple(client, MQTT_EVENT_PUBLISHED, (body[0] << 8) | body[1]);
+                }
+
+                free(body);
+            }
+
+            // keep the connection alive
+            if( esp_timer_get_time() - client->lastSendTime > (int64_t) client->config.keepalive * 1000000 / 2 ) {
+                host_mqtt_tcp_send_packet(client, HOST_MQTT_PINGREQ, NULL, 0);
+            }
+        }
+
+        pthread_mutex_lock(&client->sendLock);
+        client->sock = -1;
+        pthread_mutex_unlock(&client->sendLock);
+
+        if( sock >= 0 ) {
+            close(sock);
+        }
+
+        if( client->connected ) {
+            client->connected = false;
+            host_mqtt_dispatch_simple(client, MQTT_EVENT_DISCONNECTED, 0);
+        }
+
+        // wait before reconnecting
+        for( int waitMs = 0; client->running && waitMs < client->config.reconnect_timeout_ms; waitMs += HOST_MQTT_POLL_TIME ) {
+            vTaskDelay(pdMS_TO_TICKS(HOST_MQTT_POLL_TIME));
+        }
+    }
+}
+
+
+static void host_mqtt_dispatch(esp_mqtt_client_handle_t client, esp_mqtt_event_t *event)
+{
+    event->client = client;
+    event->user_context = client->config.user_context;
+
+    if( client->config.event_handle != NULL ) {
+        client->config.event_handle(event);
+    }
+}
+
+
+static void host_mqtt_dispatch_simple(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t eventId, int msgId)
+{
+    esp_mqtt_event_t event = { 0 };
+
+    event.event_id = eventId;
+    event.msg_id = msgId;
+
+    host_mqtt_dispatch(client, &event);
+}
+
+
+/**
+ * deliver MQTT_EVENT_DATA in fragments of the client buffer size, the same as ESP-IDF.
+ * each fragment is copied into its own exactly-sized buffer, so reading beyond
+ * data_len or topic_len is caught by the sanitizers.
+ */
+static void host_mqtt_deliver_data(esp_mqtt_client_handle_t client, const char *topic, int topicLen,
+                                   const char *data, int dataLen, bool retain)
+{
+    int offset = 0;
+
+    do {
+        esp_mqtt_event_t event = { 0 };
+        int fragmentLen = dataLen - offset;
+
+        if( fragmentLen > client->config.buffer_size ) {
+            fragmentLen = client->config.buffer_size;
+        }
+
+        event.event_id = MQTT_EVENT_DATA;
+        event.data = malloc(fragmentLen > 0 ? fragmentLen : 1);
+        event.data_len = fragmentLen;
+        event.total_data_len = dataLen;
+        event.current_data_offset = offset;
+        event.retain = retain;
+        memcpy(event.data, data + offset, fragmentLen);
+
+        if( offset == 0 ) {
+            event.topic = malloc(topicLen > 0 ? topicLen : 1);
+            event.topic_len = topicLen;
+            memcpy(event.topic, topic, topicLen);
+        }
+
+        host_mqtt_dispatch(client, &event);
+
+        free(event.data);
+        free(event.topic);
+
+        offset += fragmentLen;
+    } while( offset < dataLen );
+}
+
+
+static void host_mqtt_inbox_push(esp_mqtt_client_handle_t client, host_mqtt_item_type_t type, int msgId,
+                                 const char *topic, int topicLen, const char *data, int dataLen, bool retain)
+{
+    host_mqtt_item_t *item = calloc(1, sizeof(host_mqtt_item_t));
+    if( item == NULL ) {
+        ESP_LOGE(TAG, "unable to malloc memory");
+        return;
+    }
+
+    item->type = type;
+    item->msgId = msgId;
+    item->retain = retain;
+
+    if( topic != NULL ) {
+        item->topic = malloc(topicLen > 0 ? topicLen : 1);
+        item->topicLen = topicLen;
+        memcpy(item->topic, topic, topicLen);
+    }
+
+    if( data != NULL ) {
+        item->data = malloc(dataLen > 0 ? dataLen : 1);
+        item->dataLen = dataLen;
+        memcpy(item->data, data, dataLen);
+    }
+
+    pthread_mutex_lock(&client->lock);
+    if( client->inboxTail != NULL ) {
+        client->inboxTail->next = item;
+    } else {
+        client->inboxHead = item;
+    }
+    client->inboxTail = item;
+    pthread_cond_signal(&client->inboxReady);
+    pthread_mutex_unlock(&client->lock);
+}
+
+
+/**
+ * MQTT topic filter matching with the '+' and '#' wildcards
+ */
+static bool host_mqtt_topic_match(const char *filter, const char *topic, int topicLen)
+{
+    int tIdx = 0;
+
+    while( *filter ) {
+
+        if( *filter == '#' ) {
+            return(true);
+        }
+
+        if( *filter == '+' ) {
+            // skip one level
+            while( tIdx < topicLen && topic[tIdx] != '/' ) {
+                tIdx++;
+            }
+            filter++;
+            continue;
+        }
+
+        if( tIdx >= topicLen || *filter != topic[tIdx] ) {
+            // "a/#" also matches "a"
+            return(tIdx >= topicLen && !strcmp(filter, "/#"));
+        }
+
+        filter++;
+        tIdx++;
+    }
+
+    return(tIdx == topicLen);
+}
+
+
+static void host_mqtt_broker_join(esp_mqtt_client_handle_t client)
+{
+    pthread_mutex_lock(&host_mqtt_broker_lock);
+    for( int cIdx = 0; cIdx < HOST_MQTT_MAX_CLIENTS; cIdx++ ) {
+        if( host_mqtt_broker_clients[cIdx] == NULL ) {
+            host_mqtt_broker_clients[cIdx] = client;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&host_mqtt_broker_lock);
+}
+
+
+static void host_mqtt_broker_leave(esp_mqtt_client_handle_t client)
+{
+    pthread_mutex_lock(&host_mqtt_broker_lock);
+    for( int cIdx = 0; cIdx < HOST_MQTT_MAX_CLIENTS; cIdx++ ) {
+        if( host_mqtt_broker_clients[cIdx] == client ) {
+            host_mqtt_broker_clients[cIdx] = NULL;
+        }
+    }
+
+    for( int sIdx = 0; sIdx < HOST_MQTT_MAX_SUBSCRIPTIONS; sIdx++ ) {
+        free(client->subscriptions[sIdx]);
+        client->subscriptions[sIdx] = NULL;
+    }
+    pthread_mutex_unlock(&host_mqtt_broker_lock);
+}
+
+
+/**
+ * deliver a publish to every matching subscriber, live deliveries are never flagged retained
+ */
+static void host_mqtt_broker_route(const char *topic, int topicLen, const char *data, int dataLen, bool retain)
+{
+    pthread_mutex_lock(&host_mqtt_broker_lock);
+
+    if( retain ) {
+        host_mqtt_broker_retain(topic, topicLen, data, dataLen);
+    }
+
+    for( int cIdx = 0; cIdx < HOST_MQTT_MAX_CLIENTS; cIdx++ ) {
+
+        esp_mqtt_client_handle_t target = host_mqtt_broker_clients[cIdx];
+        if( target == NULL ) {
+            continue;
+        }
+
+        for( int sIdx = 0; sIdx < HOST_MQTT_MAX_SUBSCRIPTIONS; sIdx++ ) {
+            if( target->subscriptions[sIdx] != NULL &&
+                host_mqtt_topic_match(target->subscriptions[sIdx], topic, topicLen) ) {
+
+                host_mqtt_inbox_push(target, HOST_MQTT_ITEM_DATA, 0, topic, topicLen, data, dataLen, false);
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&host_mqtt_broker_lock);
+}
+
+
+/**
+ * keep the last retained message of a topic, an empty one clears it
+ * called with host_mqtt_broker_lock held
+ */
+static void host_mqtt_broker_retain(const char *topic, int topicLen, const char *data, int dataLen)
+{
+    host_mqtt_retained_t *slot = NULL;
+
+    for( int rIdx = 0; rIdx < HOST_MQTT_MAX_RETAINED; rIdx++ ) {
+
+        host_mqtt_retained_t *retained = &host_mqtt_broker_retained[rIdx];
+        if( retained->topic != NULL && retained->topicLen == topicLen && !memcmp(retained->topic, topic, topicLen) ) {
+            slot = retained;
+            break;
+        }
+        if( retained->topic == NULL && slot == NULL ) {
+            slot = retained;
+        }
+    }
+
+    if( slot == NULL ) {
+        ESP_LOGE(TAG, "retained store full");
+        return;
+    }
+
+    free(slot->topic);
+    free(slot->data);
+    memset(slot, 0, sizeof(host_mqtt_retained_t));
+
+    if( dataLen > 0 ) {
+        slot->topic = malloc(topicLen);
+        slot->data = malloc(dataLen);
+        memcpy(slot->topic, topic, topicLen);
+        memcpy(slot->data, data, dataLen);
+        slot->topicLen = topicLen;
+        slot->dataLen = dataLen;
+    }
+}
+
+
+static int host_mqtt_next_msg_id(esp_mqtt_client_handle_t client)
+{
+    pthread_mutex_lock(&client->lock);
+    client->nextMsgId = (client->nextMsgId % 0xFFFF) + 1;
+    int msgId = client->nextMsgId;
+    pthread_mutex_unlock(&client->lock);
+
+    return(msgId);
+}
+
+
+static int host_mqtt_tcp_send_packet(esp_mqtt_client_handle_t client, uint8_t type,
+                                     const uint8_t *body, uint32_t bodyLen)
+{
+    uint8_t header[5];
+    uint32_t headerLen = 0;
+    uint32_t remaining = bodyLen;
+    int result = -1;
+
+    header[headerLen++] = type;
+    do {
+        uint8_t digit = remaining & 0x7F;
+        remaining >>= 7;
+        header[headerLen++] = digit | (remaining > 0 ? 0x80 : 0x00);
+    } while( remaining > 0 );
+
+    pthread_mutex_lock(&client->sendLock);
+    if( client->sock >= 0 &&
+        send(client->sock, header, headerLen, MSG_NOSIGNAL | (bodyLen > 0 ? MSG_MORE : 0)) == (ssize_t) headerLen &&
+        (bodyLen == 0 || send(client->sock, body, bodyLen, MSG_NOSIGNAL) == (ssize_t) bodyLen) ) {
+
+        client->lastSendTime = esp_timer_get_time();
+        result = 0;
+    }
+    pthread_mutex_unlock(&client->sendLock);
+
+    return(result);
+}
+
+
+/**
+ * read one control packet, the body is malloc'ed and released by the caller
+ */
+static int host_mqtt_tcp_read_packet(int sock, uint8_t *type, uint8_t **body, uint32_t *bodyLen)
+{
+    uint8_t byte;
+    uint32_t remaining = 0;
+    uint32_t multiplier = 1;
+
+    if( recv(sock, type, 1, MSG_WAITALL) != 1 ) {
+        return(-1);
+    }
+
+    do {
+        if( recv(sock, &byte, 1, MSG_WAITALL) != 1 || multiplier > 128 * 128 * 128 ) {
+            return(-1);
+        }
+        remaining += (byte & 0x7F) * multiplier;
+        multiplier *= 128;
+    } while( byte & 0x80 );
+
+    *body = malloc(remaining > 0 ? remaining : 1);
+    if( *body == NULL ) {
+        return(-1);
+    }
+
+    if( remaining > 0 && recv(sock, *body, remaining, MSG_WAITALL) != (ssize_t) remaining ) {
+        free(*body);
+        *body = NULL;
+        return(-1);
+    }
+
+    *bodyLen = remaining;
+
+    return(0);
+}
+
+
+static uint32_t host_mqtt_put_string(uint8_t *buf, const char *str, uint32_t len)
+{
+    buf[0] = UTIL_HI_UINT16(len);
+    buf[1] = UTIL_LO_UINT16(len);
+    memcpy(buf + 2, str, len);
+
+    return(2 + len);
+}
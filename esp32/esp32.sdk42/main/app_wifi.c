@@ -8,28 +8,112 @@
  */
 
 #include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/time.h>
 #include <lwip/sockets.h>
+#include <lwip/netdb.h>
 
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_task_wdt.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
 #include "freertos/event_groups.h"
 #include "esp_log.h"
+#include "nvs.h"
+#include "esp32/rom/crc.h"
 #include "app_wifi.h"
 #include "lwip/err.h"
 #include "lwip/apps/sntp.h"
+#include "esp_sntp.h"
+#ifdef CONFIG_WPA_11KV_SUPPORT
+#include "esp_rrm.h"
+#endif
 
 #include "open_tls.h"
 #include "t_gpio.h"
-#include "util.h"
+#include "periodical.h"
+#include "boot.h"
 
 static const char *TAG = "WIFI";
 
+// Note: the time is needed before the broker certificate can be checked. the last good
+//       time is restored at boot, so the MQTT connection does not wait for SNTP: after
+//       a software reset the RTC timer still holds the time, after a power cut the time
+//       saved in NVS is used, older than the real one but within the validity of the
+//       certificates. SNTP runs in the background and corrects it. the OTP check of the
+//       commands needs the real time, a command sent before the first sync is rejected.
+//
+//       with no time at all, the first boot, the broker is resolved and reached over TCP
+//       while SNTP is in flight. esp-mqtt opens its own socket, but it then finds the
+//       broker address in the lwIP DNS cache and the gateway in the ARP table
+//
+//       the channel and the BSSID of the last AP with an IP address are kept in RTC
+//       memory and NVS. a connection first goes straight to that AP on that channel,
+//       with no scan, which is all a short AP hiccup needs. if that fails, the SSID
+//       alone is scanned on every channel and the strongest AP taken, as before
+//
+//       the AP is not kept forever. the RSSI is sampled every APP_WIFI_RSSI_SAMPLE_INTERVAL,
+//       below APP_WIFI_ROAM_RSSI_LOW the SSID is scanned in the background, and the device
+//       moves to an AP at least APP_WIFI_ROAM_RSSI_GAIN stronger, through the same fast
+//       connection. when the AP supports 802.11k, only the channels of its neighbor
+//       report are scanned. the sampling is a periodical job of the gpio task, the scans
+//       and the roaming are done by the event task, as the connection itself
+
 ///////////////////////////////////////////////////////////////////////////////////
 // defines
 #define APP_WIFI_MAX_NTP_RETRY_TIME             600     // in seconds
+#define APP_WIFI_VALID_YEAR                     2016    // an earlier time was never set
+#define APP_WIFI_TIME_MAGIC                     0x454d4954  // "TIME"
+#define APP_WIFI_TIME_NVS_NAMESPACE             "app_wifi"
+#define APP_WIFI_TIME_NVS_KEY                   "last_time"
+#define APP_WIFI_TIME_NVS_INTERVAL              86400   // in seconds, at most one flash write a day
+#define APP_WIFI_PRECONNECT_TIMEOUT             5       // in seconds
+#define APP_WIFI_HOST_SIZE                      96
+#define APP_WIFI_AP_MAGIC                       0x50415041  // "APAP"
+#define APP_WIFI_AP_NVS_KEY                     "last_ap"
+#define APP_WIFI_SCAN_SIZE                      4       // the strongest APs of the SSID kept from a scan
+#define APP_WIFI_RSSI_SAMPLE_INTERVAL           10      // in seconds
+#define APP_WIFI_RSSI_PRIORITY                  0       // of the periodical job, after the NTP request and the report
+#define APP_WIFI_RSSI_HISTORY_SAMPLES           6       // samples averaged into one history entry, a minute
+#define APP_WIFI_ROAM_RSSI_LOW                  -75     // in dBm, below it a better AP is looked for
+#define APP_WIFI_ROAM_RSSI_GAIN                 10      // in dB, how much stronger the new AP must be
+#define APP_WIFI_ROAM_SCAN_INTERVAL             60      // in seconds, between two background scans
+#define APP_WIFI_NEIGHBOR_REPORT_ID             52      // the 802.11k neighbor report element
+#define APP_WIFI_NEIGHBOR_REPORT_CHANNEL        11      // BSSID, BSSID information, operating class, channel
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct {
+    uint32_t magic;
+    int64_t time;                       // in seconds, the last SNTP sync
+    int64_t check;                      // ~time
+} app_wifi_time_store_t;
+
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t channel;                    // 0 if there is no AP to go back to
+} app_wifi_ap_t;
+
+typedef struct {
+    uint32_t magic;
+    app_wifi_ap_t ap;
+    uint32_t crc;
+} app_wifi_ap_store_t;
+
+// the events of this module, on the default event loop
+typedef enum {
+    APP_WIFI_EVENT_RSSI_LOW = 0,        // int8_t, the RSSI sampled
+    APP_WIFI_EVENT_NEIGHBORS            // uint16_t, bit n set for channel n
+} app_wifi_event_t;
+
+typedef enum {
+    APP_WIFI_ATTEMPT_FAST = 0,          // the cached AP on its channel
+    APP_WIFI_ATTEMPT_SCAN               // the strongest AP of a scan of the SSID
+} app_wifi_attempt_t;
 
 ///////////////////////////////////////////////////////////////////////////////////
 // local variables
@@ -42,6 +126,44 @@ static EventGroupHandle_t wifi_event_group = NULL;
    to the AP with an IP? */
 static const int APP_WIFI_CONNECTED_BIT = BIT0;
 
+// the last good time, kept across a software reset
+static RTC_NOINIT_ATTR app_wifi_time_store_t app_wifi_time_store;
+static int64_t app_wifi_time_nvs = 0;   // the one in NVS
+static volatile bool app_wifi_time_synced = false;      // the clock is from SNTP, not restored
+
+// the last AP with an IP address, kept across a software reset, and the one in NVS
+static RTC_NOINIT_ATTR app_wifi_ap_store_t app_wifi_ap_store;
+static app_wifi_ap_t app_wifi_ap_nvs;
+
+// the connection in progress, only the event task changes them
+static app_wifi_attempt_t app_wifi_attempt = APP_WIFI_ATTEMPT_FAST;
+static int64_t app_wifi_disconnected_at = 0;    // in us, 0 while connected and at boot
+static uint64_t app_wifi_fast_total = 0;        // in us
+static uint64_t app_wifi_scan_total = 0;        // in us
+static app_wifi_stats_t app_wifi_stats;
+
+// the RSSI history, written by the gpio task
+ESP_EVENT_DEFINE_BASE(APP_WIFI_EVENT);
+static portMUX_TYPE app_wifi_rssi_mux = portMUX_INITIALIZER_UNLOCKED;
+static int8_t app_wifi_rssi_history[APP_WIFI_RSSI_HISTORY_SIZE];
+static int8_t app_wifi_rssi_min_history[APP_WIFI_RSSI_HISTORY_SIZE];
+static int8_t app_wifi_rssi_max_history[APP_WIFI_RSSI_HISTORY_SIZE];
+static uint8_t app_wifi_rssi_head = 0;
+static uint8_t app_wifi_rssi_count = 0;
+static int32_t app_wifi_rssi_sum = 0;
+static int8_t app_wifi_rssi_min = 0;            // of the minute in progress
+static int8_t app_wifi_rssi_max = 0;
+static uint8_t app_wifi_rssi_samples = 0;
+
+// the roaming in progress, only the event task changes them
+static bool app_wifi_roam_scanning = false;    // until its scan done, or app_wifi_roam_stop()
+static bool app_wifi_roaming = false;
+static uint16_t app_wifi_roam_channels = 0;     // still to scan, bit n for channel n
+static int64_t app_wifi_roam_last_scan = 0;     // in us
+static int8_t app_wifi_roam_rssi = 0;           // of the current AP
+static app_wifi_ap_t app_wifi_roam_best;
+static int8_t app_wifi_roam_best_rssi = 0;
+
 ///////////////////////////////////////////////////////////////////////////////////
 // local functions
 static void app_wifi_start_event_handle(void *arg, esp_event_base_t event_base,
@@ -52,6 +174,26 @@ static void app_wifi_disconnect_event_handle(void *arg, esp_event_base_t event_b
                                             int32_t event_id, void *event_data);
 static void app_wifi_connect_ap(void);
 static wifi_config_t app_wifi_get_config(void);
+static bool app_wifi_time_is_valid(time_t now);
+static void app_wifi_ntp_synced(struct timeval *tv);
+static void app_wifi_time_save(time_t now);
+static bool app_wifi_ap_is_valid(void);
+static void app_wifi_ap_load(void);
+static void app_wifi_ap_save(const wifi_ap_record_t *apInfo);
+static void app_wifi_ap_keep(const app_wifi_ap_t *ap);
+static void app_wifi_connected(const uint8_t *bssid);
+static void app_wifi_rssi_sample(void);
+static void app_wifi_rssi_low_event_handle(void *arg, esp_event_base_t event_base,
+                                          int32_t event_id, void *event_data);
+static void app_wifi_neighbors_event_handle(void *arg, esp_event_base_t event_base,
+                                           int32_t event_id, void *event_data);
+static void app_wifi_scan_done_event_handle(void *arg, esp_event_base_t event_base,
+                                           int32_t event_id, void *event_data);
+static void app_wifi_roam_scan_next(void);
+static void app_wifi_roam_stop(void);
+#ifdef CONFIG_WPA_11KV_SUPPORT
+static void app_wifi_neighbor_report(void *ctx, const uint8_t *report, size_t reportLen);
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////////
 // public function implementations
@@ -74,6 +216,9 @@ void app_wifi_initialise(void)
     ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_START, &app_wifi_start_event_handle, NULL));
     ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &app_wifi_disconnect_event_handle, NULL));
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &app_wifi_got_ip_event_handle, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &app_wifi_scan_done_event_handle, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(APP_WIFI_EVENT, APP_WIFI_EVENT_RSSI_LOW, &app_wifi_rssi_low_event_handle, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(APP_WIFI_EVENT, APP_WIFI_EVENT_NEIGHBORS, &app_wifi_neighbors_event_handle, NULL));
 
     ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
 
@@ -168,6 +313,9 @@ void app_wifi_initialise(void)
         ESP_ERROR_CHECK(esp_wifi_set_country(&wifiBand));
     }
 
+    // the AP to go back to
+    app_wifi_ap_load();
+
     // process SSID/PASSWORD
     wifi_config_t wifiConfig = app_wifi_get_config();
 
@@ -176,6 +324,9 @@ void app_wifi_initialise(void)
     ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifiConfig));
     ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_NONE));
     ESP_ERROR_CHECK(esp_wifi_start());
+
+    // the RSSI monitor
+    periodical_register("rssi", APP_WIFI_RSSI_SAMPLE_INTERVAL * 1000, APP_WIFI_RSSI_PRIORITY, app_wifi_rssi_sample);
 }
 
 
@@ -221,8 +372,86 @@ void app_wifi_ntp_request(void)
 }
 
 
+/**
+ * Restore the last good time, before the WiFi is up
+ * Note: NVS must be initialized
+ */
+void app_wifi_time_restore(void)
+{
+    // the time is logged and checked in GMT
+    setenv("TZ", "GMT", 1);
+    tzset();
+
+    nvs_handle_t handle;
+    if( nvs_open(APP_WIFI_TIME_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK ) {
+        nvs_get_i64(handle, APP_WIFI_TIME_NVS_KEY, &app_wifi_time_nvs);
+        nvs_close(handle);
+    }
+
+    // the RTC timer keeps the system time across a software reset, it is still the
+    // SNTP time if there was a sync since the power-on
+    if( app_wifi_time_valid() ) {
+        app_wifi_time_synced = app_wifi_time_store.magic == APP_WIFI_TIME_MAGIC &&
+                               app_wifi_time_store.check == ~app_wifi_time_store.time;
+        boot_set_time_source(BOOT_TIME_RTC);
+        return;
+    }
+
+    time_t restored = 0;
+    boot_time_source_t source = BOOT_TIME_NONE;
+
+    if( app_wifi_time_store.magic == APP_WIFI_TIME_MAGIC && app_wifi_time_store.check == ~app_wifi_time_store.time &&
+        app_wifi_time_is_valid(app_wifi_time_store.time) ) {
+
+        restored = app_wifi_time_store.time;
+        source = BOOT_TIME_RTC;
+
+    } else if( app_wifi_time_is_valid(app_wifi_time_nvs) ) {
+
+        restored = app_wifi_time_nvs;
+        source = BOOT_TIME_NVS;
+    }
+
+    if( source == BOOT_TIME_NONE ) {
+        ESP_LOGI(TAG, "no time to restore, waiting for SNTP");
+        return;
+    }
+
+    struct timeval tv = { .tv_sec = restored };
+    settimeofday(&tv, NULL);
+    boot_set_time_source(source);
+
+    ESP_LOGI(TAG, "restored %ld from %s", (long) restored, boot_time_source_name());
+}
+
+
+/**
+ * Check if the time is set, restored or from SNTP
+ *
+ * @return true if the time is past APP_WIFI_VALID_YEAR
+ */
+bool app_wifi_time_valid(void)
+{
+    return(app_wifi_time_is_valid(time(NULL)));
+}
+
+
+/**
+ * Check if the time is confirmed by SNTP, a restored time may be hours or days behind
+ * Note: the OTP check and the restore of the delayed actions need this, the certificate
+ *       check only needs a valid time
+ *
+ * @return true after the first SNTP sync, or if the clock ran on from a synced one across a reset
+ */
+bool app_wifi_time_confirmed(void)
+{
+    return(app_wifi_time_synced);
+}
+
+
 /**
  * Initialize NTP Client
+ * this waits for an IP address, the time is then set in the background
  */
 void app_wifi_ntp_init(void)
 {
@@ -233,9 +462,17 @@ void app_wifi_ntp_init(void)
     ESP_LOGI(TAG, "Initializing SNTP");
     sntp_setoperatingmode(SNTP_OPMODE_POLL);
     sntp_setservername(0, "pool.ntp.org");
+    sntp_set_time_sync_notification_cb(app_wifi_ntp_synced);
     sntp_init();
+}
 
-    // wait for time to be set
+
+/**
+ * Wait for the first SNTP sync, when there was no time to restore
+ * the system restarts after APP_WIFI_MAX_NTP_RETRY_TIME
+ */
+void app_wifi_ntp_wait(void)
+{
     time_t now = 0;
     struct tm timeinfo = { 0 };
     char strftime_buf[64];
@@ -243,20 +480,15 @@ void app_wifi_ntp_init(void)
     // keep led blinking until time is obtained
     t_gpio_led_mode(T_GPIO_LED_MODE_ERROR_BLINKING);
 
-    // attempt to get MAYBE the already configured
-    time(&now);
-    localtime_r(&now, &timeinfo);
-
-    // whatsoever, still request at least one NTP
-    app_wifi_ntp_request();
-
     // time is critical, stay here until time is obtained
     uint32_t retryCounter = 0;
-    while( timeinfo.tm_year < (2016 - 1900) ) {
+    while( !app_wifi_time_valid() ) {
         ESP_LOGI(TAG, "Waiting for system time to be set... (Attempt %d)", ++retryCounter);
         vTaskDelay(2000 / portTICK_PERIOD_MS);
-        time(&now);
-        localtime_r(&now, &timeinfo);
+
+        if( app_wifi_time_valid() ) {
+            break;
+        }
 
         app_wifi_ntp_request();
         ESP_LOGI(TAG, "Resending NTP request");
@@ -279,14 +511,78 @@ void app_wifi_ntp_init(void)
     t_gpio_led_mode(T_GPIO_LED_MODE_CLEAR_ERROR);
 
     // output the obtained GMT
-    setenv("TZ", "GMT", 1);
-    tzset();
+    time(&now);
     localtime_r(&now, &timeinfo);
     strftime(strftime_buf, sizeof(strftime_buf), "%c", &timeinfo);
     ESP_LOGI(TAG, "Obtained %ld GMT date/time: %s", now, strftime_buf);
 }
 
 
+/**
+ * Resolve the broker of uri and open a TCP connection to it, then close it
+ * this returns after APP_WIFI_PRECONNECT_TIMEOUT at most
+ *
+ * @param uri the MQTT broker, "mqtts://host:port"
+ */
+void app_wifi_preconnect(const char *uri)
+{
+    char host[APP_WIFI_HOST_SIZE];
+    char port[8];
+
+    // the host, then the port or the default one of the scheme
+    const char *hostStart = strstr(uri, "://");
+    hostStart = hostStart != NULL ? hostStart + 3 : uri;
+    size_t hostLen = strcspn(hostStart, ":/");
+    if( hostLen == 0 || hostLen >= sizeof(host) ) {
+        return;
+    }
+
+    memcpy(host, hostStart, hostLen);
+    host[hostLen] = 0;
+
+    if( hostStart[hostLen] == ':' ) {
+        snprintf(port, sizeof(port), "%d", atoi(hostStart + hostLen + 1));
+    } else {
+        strcpy(port, !strncmp(uri, "mqtts", 5) ? "8883" : "1883");
+    }
+
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *addr = NULL;
+    if( getaddrinfo(host, port, &hints, &addr) != 0 || addr == NULL ) {
+        ESP_LOGW(TAG, "unable to resolve %s", host);
+        return;
+    }
+
+    boot_mark(BOOT_PHASE_DNS);
+
+    int sock = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    if( sock >= 0 ) {
+
+        fcntl(sock, F_SETFL, O_NONBLOCK);
+
+        if( connect(sock, addr->ai_addr, addr->ai_addrlen) == 0 || errno == EINPROGRESS ) {
+
+            fd_set writeSet;
+            FD_ZERO(&writeSet);
+            FD_SET(sock, &writeSet);
+            struct timeval timeout = { .tv_sec = APP_WIFI_PRECONNECT_TIMEOUT };
+            int sockErr = 0;
+            socklen_t sockErrLen = sizeof(sockErr);
+
+            if( select(sock + 1, NULL, &writeSet, NULL, &timeout) > 0 &&
+                getsockopt(sock, SOL_SOCKET, SO_ERROR, &sockErr, &sockErrLen) == 0 && sockErr == 0 ) {
+
+                boot_mark(BOOT_PHASE_TCP);
+            }
+        }
+
+        close(sock);
+    }
+
+    freeaddrinfo(addr);
+}
+
+
 /**
  * Get AP rssi
  *
@@ -307,6 +603,41 @@ int8_t app_wifi_get_rssi(void)
 }
 
 
+/**
+ * Get the reconnect counters, from a disconnection to an IP address
+ */
+void app_wifi_get_stats(app_wifi_stats_t *stats)
+{
+    *stats = app_wifi_stats;
+
+    // the history oldest first, the weakest and the strongest samples over it
+    int32_t sum = 0;
+    stats->rssiMin = 0;
+    stats->rssiAvg = 0;
+    stats->rssiMax = 0;
+
+    portENTER_CRITICAL(&app_wifi_rssi_mux);
+    stats->rssiCount = app_wifi_rssi_count;
+    for( uint8_t hIdx = 0; hIdx < app_wifi_rssi_count; hIdx++ ) {
+
+        uint8_t entry = (app_wifi_rssi_head + APP_WIFI_RSSI_HISTORY_SIZE - app_wifi_rssi_count + hIdx) % APP_WIFI_RSSI_HISTORY_SIZE;
+        stats->rssiHistory[hIdx] = app_wifi_rssi_history[entry];
+        sum += app_wifi_rssi_history[entry];
+        if( hIdx == 0 || app_wifi_rssi_min_history[entry] < stats->rssiMin ) {
+            stats->rssiMin = app_wifi_rssi_min_history[entry];
+        }
+        if( hIdx == 0 || app_wifi_rssi_max_history[entry] > stats->rssiMax ) {
+            stats->rssiMax = app_wifi_rssi_max_history[entry];
+        }
+    }
+    portEXIT_CRITICAL(&app_wifi_rssi_mux);
+
+    if( stats->rssiCount > 0 ) {
+        stats->rssiAvg = sum / stats->rssiCount;
+    }
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////
 // local function implementations
 
@@ -331,15 +662,24 @@ static void app_wifi_got_ip_event_handle(void *arg, esp_event_base_t event_base,
                                         int32_t event_id, void *event_data)
 {
     wifi_ap_record_t wifiInfo;
+    const uint8_t *bssid = NULL;
 
     // get ap info
     if( esp_wifi_sta_get_ap_info(&wifiInfo) == ESP_OK ){
         // get bssid from ap info
         memcpy(t_device_wifi_bssid, wifiInfo.bssid, 6);
+        bssid = wifiInfo.bssid;
+
+        // the AP to go back to next time
+        app_wifi_ap_save(&wifiInfo);
     }
 
+    app_wifi_connected(bssid);
+
     // set event group tag
     xEventGroupSetBits(wifi_event_group, APP_WIFI_CONNECTED_BIT);
+    boot_mark(BOOT_PHASE_WIFI);
+    t_gpio_notify(T_GPIO_EVENT_WIFI);
 
     // normal status
     t_gpio_led_mode(T_GPIO_LED_MODE_CLEAR_ERROR);
@@ -358,7 +698,33 @@ static void app_wifi_disconnect_event_handle(void *arg, esp_event_base_t event_b
     // set disconnect status
     // NOTE: set before app_wifi_connect_ap(), or
     //      would be too late
-    xEventGroupClearBits(wifi_event_group, APP_WIFI_CONNECTED_BIT);
+    bool wasConnected = xEventGroupClearBits(wifi_event_group, APP_WIFI_CONNECTED_BIT) & APP_WIFI_CONNECTED_BIT;
+
+    // a background scan has nothing left to compare with
+    app_wifi_roam_stop();
+
+    if( wasConnected ) {
+        // a new outage, the cached AP first
+        app_wifi_disconnected_at = esp_timer_get_time();
+        app_wifi_attempt = APP_WIFI_ATTEMPT_FAST;
+
+        // the gpio task starts counting the outage
+        t_gpio_notify(T_GPIO_EVENT_WIFI);
+    } else {
+        // the cached AP is gone, or the last scan did not get through
+        app_wifi_attempt = APP_WIFI_ATTEMPT_SCAN;
+
+        // the AP of the roaming did not take the device, it is an outage from here
+        if( app_wifi_roaming ) {
+            app_wifi_roaming = false;
+            app_wifi_stats.roamFails++;
+
+            ESP_LOGI(TAG, "roaming failed, scanning");
+        }
+    }
+
+    wifi_event_sta_disconnected_t *disconnected = event_data;
+    ESP_LOGI(TAG, "disconnected, reason %d", disconnected != NULL ? disconnected->reason : 0);
 
     // cleanup wifi state
     // NOTE: do it before app_wifi_connect_ap(), for wifi scan
@@ -370,61 +736,57 @@ static void app_wifi_disconnect_event_handle(void *arg, esp_event_base_t event_b
 
 
 /**
- * Search the strongest ap with the config essid, then connect to the ap
+ * Connect to the cached AP on its channel, or search the strongest ap with the config essid
  */
 static void app_wifi_connect_ap(void)
 {
-    wifi_ap_record_t *wifiScanList = NULL;
-    uint16_t apCount;
+    // get SSID/PASSWORD
+    wifi_config_t wifiConfig = app_wifi_get_config();
+
+    if( app_wifi_attempt == APP_WIFI_ATTEMPT_FAST && app_wifi_ap_is_valid() ) {
+
+        // only this channel is probed, for only this ap
+        memcpy(wifiConfig.sta.bssid, app_wifi_ap_store.ap.bssid, 6);
+        wifiConfig.sta.bssid_set = true;
+        wifiConfig.sta.channel = app_wifi_ap_store.ap.channel;
+        esp_wifi_set_config(ESP_IF_WIFI_STA, &wifiConfig);
+
+        esp_wifi_connect();
+        return;
+    }
+
+    app_wifi_attempt = APP_WIFI_ATTEMPT_SCAN;
+
+    // only the APs of the SSID are reported
     wifi_scan_config_t wifiScanConf = {
-        .ssid = NULL,
+        .ssid = wifiConfig.sta.ssid,
         .bssid = NULL,
         .channel = 0,
-        .show_hidden = 1
+        .show_hidden = 0
     };
 
     // start wifi scan
     esp_err_t err = esp_wifi_scan_start(&wifiScanConf, true);
     if( err != ESP_OK ) {
         // scan failed, try connect
+        esp_wifi_set_config(ESP_IF_WIFI_STA, &wifiConfig);
         esp_wifi_connect();
         return;
     }
 
-    // get number of APs found in last scan
-    esp_wifi_scan_get_ap_num(&apCount);
-
-    if( apCount > 0 ) {
-        // malloc sacn list
-        wifiScanList = malloc(sizeof(wifi_ap_record_t) * apCount);
-        if( wifiScanList != NULL ) {
-            // get scan list
-            esp_wifi_scan_get_ap_records(&apCount, wifiScanList);
-
-            // get SSID/PASSWORD
-            wifi_config_t wifiConfig = app_wifi_get_config();
-
-            for( int32_t index = 0; index < apCount; index++ ) {
-                // find the bssid of the strongest ap from scan list
-                // NOTE: default sort by rssi, so first one must be the strongest one
-                if( !strcmp((char *)wifiScanList[index].ssid, (char *)wifiConfig.sta.ssid) ) {
-                    // set bssid to config
-                    memcpy(wifiConfig.sta.bssid, wifiScanList[index].bssid, 6);
-
-                    // force to use only this ap
-                    wifiConfig.sta.bssid_set = true;
+    // the strongest ones, the scan list is sorted by rssi
+    wifi_ap_record_t wifiScanList[APP_WIFI_SCAN_SIZE];
+    uint16_t apCount = APP_WIFI_SCAN_SIZE;
+    if( esp_wifi_scan_get_ap_records(&apCount, wifiScanList) == ESP_OK && apCount > 0 ) {
 
-                    // commit setting
-                    esp_wifi_set_config(ESP_IF_WIFI_STA, &wifiConfig);
-
-                    break;
-                } // end if( !strcmp((char *)apList[index].ssid, (char *)wifiConfig.sta.ssid) )
-            } // end for
-        } // end if( wifiScanList != NULL )
+        // force to use only this ap
+        memcpy(wifiConfig.sta.bssid, wifiScanList[0].bssid, 6);
+        wifiConfig.sta.bssid_set = true;
+        wifiConfig.sta.channel = wifiScanList[0].primary;
+    }
 
-        // free malloc
-        UTIL_FREE(wifiScanList);
-    } // end if( apCount > 0 )
+    // commit setting
+    esp_wifi_set_config(ESP_IF_WIFI_STA, &wifiConfig);
 
     // connect to wifi
     esp_wifi_connect();
@@ -457,9 +819,423 @@ static wifi_config_t app_wifi_get_config(void)
     // enable capable with pmf
     wifiConfig.sta.pmf_cfg.capable = true;
 
+#ifdef CONFIG_WPA_11KV_SUPPORT
+    // neighbor reports for the roaming scans
+    wifiConfig.sta.rm_enabled = true;
+#endif
+
     // duplicate ssid for the device report (long name will be truncated)
     strncpy(t_device_wifi_ssid, (char *) wifiConfig.sta.ssid, 19);
     t_device_wifi_ssid[19] = 0;
 
     return(wifiConfig);
 }
+
+
+/**
+ * @return true if now is past APP_WIFI_VALID_YEAR
+ */
+static bool app_wifi_time_is_valid(time_t now)
+{
+    struct tm timeinfo = { 0 };
+    gmtime_r(&now, &timeinfo);
+
+    return(timeinfo.tm_year >= (APP_WIFI_VALID_YEAR - 1900));
+}
+
+
+/**
+ * SNTP callback, from the lwIP task, on every sync
+ */
+static void app_wifi_ntp_synced(struct timeval *tv)
+{
+    app_wifi_time_synced = true;
+    boot_set_time_source(BOOT_TIME_NTP);
+    boot_mark(BOOT_PHASE_NTP);
+
+    app_wifi_time_save(tv->tv_sec);
+}
+
+
+/**
+ * keep now as the last good time, in RTC memory on every sync and in NVS once a day
+ */
+static void app_wifi_time_save(time_t now)
+{
+    app_wifi_time_store.magic = APP_WIFI_TIME_MAGIC;
+    app_wifi_time_store.time = now;
+    app_wifi_time_store.check = ~app_wifi_time_store.time;
+
+    if( llabs(now - app_wifi_time_nvs) < APP_WIFI_TIME_NVS_INTERVAL ) {
+        return;
+    }
+
+    nvs_handle_t handle;
+    if( nvs_open(APP_WIFI_TIME_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK ) {
+        ESP_LOGE(TAG, "unable to open NVS");
+        return;
+    }
+
+    if( nvs_set_i64(handle, APP_WIFI_TIME_NVS_KEY, now) == ESP_OK && nvs_commit(handle) == ESP_OK ) {
+        app_wifi_time_nvs = now;
+    } else {
+        ESP_LOGE(TAG, "unable to save the time to NVS");
+    }
+
+    nvs_close(handle);
+}
+
+
+/**
+ * @return true if there is an AP to go back to
+ */
+static bool app_wifi_ap_is_valid(void)
+{
+    return(app_wifi_ap_store.magic == APP_WIFI_AP_MAGIC &&
+           app_wifi_ap_store.crc == crc32_le(0, (const uint8_t *) &app_wifi_ap_store.ap, sizeof(app_wifi_ap_t)) &&
+           app_wifi_ap_store.ap.channel > 0);
+}
+
+
+/**
+ * the AP of the previous boot, in RTC memory after a software reset, else in NVS
+ */
+static void app_wifi_ap_load(void)
+{
+    memset(&app_wifi_ap_nvs, 0, sizeof(app_wifi_ap_nvs));
+
+    nvs_handle_t handle;
+    if( nvs_open(APP_WIFI_TIME_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK ) {
+
+        size_t len = sizeof(app_wifi_ap_nvs);
+        if( nvs_get_blob(handle, APP_WIFI_AP_NVS_KEY, &app_wifi_ap_nvs, &len) != ESP_OK || len != sizeof(app_wifi_ap_nvs) ) {
+            memset(&app_wifi_ap_nvs, 0, sizeof(app_wifi_ap_nvs));
+        }
+
+        nvs_close(handle);
+    }
+
+    if( !app_wifi_ap_is_valid() ) {
+        app_wifi_ap_keep(&app_wifi_ap_nvs);
+    }
+
+    if( app_wifi_ap_is_valid() ) {
+        ESP_LOGI(TAG, "last AP %02X:%02X:%02X:%02X:%02X:%02X on channel %d", app_wifi_ap_store.ap.bssid[0],
+                                                                           app_wifi_ap_store.ap.bssid[1],
+                                                                           app_wifi_ap_store.ap.bssid[2],
+                                                                           app_wifi_ap_store.ap.bssid[3],
+                                                                           app_wifi_ap_store.ap.bssid[4],
+                                                                           app_wifi_ap_store.ap.bssid[5],
+                                                                           app_wifi_ap_store.ap.channel);
+    }
+}
+
+
+/**
+ * keep the AP in RTC memory, and in NVS when it is another one than there
+ */
+static void app_wifi_ap_save(const wifi_ap_record_t *apInfo)
+{
+    app_wifi_ap_t ap;
+    memset(&ap, 0, sizeof(ap));
+    memcpy(ap.bssid, apInfo->bssid, 6);
+    ap.channel = apInfo->primary;
+
+    app_wifi_ap_keep(&ap);
+
+    if( !memcmp(&ap, &app_wifi_ap_nvs, sizeof(ap)) ) {
+        return;
+    }
+
+    nvs_handle_t handle;
+    if( nvs_open(APP_WIFI_TIME_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK ) {
+        ESP_LOGE(TAG, "unable to open NVS");
+        return;
+    }
+
+    if( nvs_set_blob(handle, APP_WIFI_AP_NVS_KEY, &ap, sizeof(ap)) == ESP_OK && nvs_commit(handle) == ESP_OK ) {
+        app_wifi_ap_nvs = ap;
+    } else {
+        ESP_LOGE(TAG, "unable to save the AP to NVS");
+    }
+
+    nvs_close(handle);
+}
+
+
+/**
+ * the AP of the next fast connection, in RTC memory
+ */
+static void app_wifi_ap_keep(const app_wifi_ap_t *ap)
+{
+    app_wifi_ap_store.magic = APP_WIFI_AP_MAGIC;
+    app_wifi_ap_store.ap = *ap;
+    app_wifi_ap_store.crc = crc32_le(0, (const uint8_t *) &app_wifi_ap_store.ap, sizeof(app_wifi_ap_t));
+}
+
+
+/**
+ * an IP address again, count the outage by the way it ended
+ *
+ * @param bssid of the AP connected to, NULL if not known
+ */
+static void app_wifi_connected(const uint8_t *bssid)
+{
+    if( app_wifi_disconnected_at == 0 ) {
+        return;
+    }
+
+    int64_t elapsed = esp_timer_get_time() - app_wifi_disconnected_at;
+    app_wifi_disconnected_at = 0;
+
+    // a roaming ends on the AP it went for, anything else is an outage
+    bool roamed = app_wifi_roaming && bssid != NULL && !memcmp(bssid, app_wifi_roam_best.bssid, 6);
+    if( app_wifi_roaming && !roamed ) {
+        app_wifi_stats.roamFails++;
+    }
+    app_wifi_roaming = false;
+
+    if( roamed ) {
+        // not an outage, the device left on its own
+        app_wifi_stats.roams++;
+        app_wifi_stats.roamTime = elapsed / 1000;
+
+        ESP_LOGI(TAG, "roamed in %u ms", app_wifi_stats.roamTime);
+        return;
+    }
+
+    app_wifi_stats.reconnects++;
+    app_wifi_stats.lastTime = elapsed / 1000;
+
+    if( app_wifi_attempt == APP_WIFI_ATTEMPT_FAST ) {
+        app_wifi_stats.fast++;
+        app_wifi_fast_total += elapsed;
+        app_wifi_stats.fastTime = app_wifi_fast_total / app_wifi_stats.fast / 1000;
+    } else {
+        app_wifi_stats.scanned++;
+        app_wifi_scan_total += elapsed;
+        app_wifi_stats.scanTime = app_wifi_scan_total / app_wifi_stats.scanned / 1000;
+    }
+
+    ESP_LOGI(TAG, "reconnected in %u ms, %s", app_wifi_stats.lastTime,
+                                              app_wifi_attempt == APP_WIFI_ATTEMPT_FAST ? "cached AP" : "scan");
+}
+
+
+/**
+ * RSSI monitor, from the gpio task, every APP_WIFI_RSSI_SAMPLE_INTERVAL
+ */
+static void app_wifi_rssi_sample(void)
+{
+    if( !app_wifi_is_connected() ) {
+        return;
+    }
+
+    int8_t rssi = app_wifi_get_rssi();
+    if( rssi == 0 ) {
+        return;
+    }
+
+    // one history entry a minute, the average, the weakest and the strongest of its samples
+    if( app_wifi_rssi_samples == 0 || rssi < app_wifi_rssi_min ) {
+        app_wifi_rssi_min = rssi;
+    }
+    if( app_wifi_rssi_samples == 0 || rssi > app_wifi_rssi_max ) {
+        app_wifi_rssi_max = rssi;
+    }
+    app_wifi_rssi_sum += rssi;
+    if( ++app_wifi_rssi_samples >= APP_WIFI_RSSI_HISTORY_SAMPLES ) {
+
+        portENTER_CRITICAL(&app_wifi_rssi_mux);
+        app_wifi_rssi_history[app_wifi_rssi_head] = app_wifi_rssi_sum / app_wifi_rssi_samples;
+        app_wifi_rssi_min_history[app_wifi_rssi_head] = app_wifi_rssi_min;
+        app_wifi_rssi_max_history[app_wifi_rssi_head] = app_wifi_rssi_max;
+        app_wifi_rssi_head = (app_wifi_rssi_head + 1) % APP_WIFI_RSSI_HISTORY_SIZE;
+        if( app_wifi_rssi_count < APP_WIFI_RSSI_HISTORY_SIZE ) {
+            app_wifi_rssi_count++;
+        }
+        portEXIT_CRITICAL(&app_wifi_rssi_mux);
+
+        app_wifi_rssi_sum = 0;
+        app_wifi_rssi_samples = 0;
+    }
+
+    // the roaming belongs to the event task
+    if( rssi < APP_WIFI_ROAM_RSSI_LOW ) {
+        esp_event_post(APP_WIFI_EVENT, APP_WIFI_EVENT_RSSI_LOW, &rssi, sizeof(rssi), 0);
+    }
+}
+
+
+/**
+ * the RSSI is low, look for a better AP, at most every APP_WIFI_ROAM_SCAN_INTERVAL
+ */
+static void app_wifi_rssi_low_event_handle(void *arg, esp_event_base_t event_base,
+                                          int32_t event_id, void *event_data)
+{
+    int64_t now = esp_timer_get_time();
+
+    // a scan must not be started over one in flight, its scan done would be lost,
+    // a neighbor report that never came expires with the interval
+    if( app_wifi_roaming || app_wifi_roam_scanning || !app_wifi_is_connected() ||
+        (app_wifi_roam_last_scan != 0 && now - app_wifi_roam_last_scan < APP_WIFI_ROAM_SCAN_INTERVAL * 1000000LL) ) {
+        return;
+    }
+
+    app_wifi_roam_last_scan = now;
+    app_wifi_roam_rssi = *(const int8_t *) event_data;
+    app_wifi_roam_best_rssi = INT8_MIN;
+    app_wifi_roam_channels = 0;
+    app_wifi_stats.roamScans++;
+
+    ESP_LOGI(TAG, "rssi %d, looking for a better AP", app_wifi_roam_rssi);
+
+#ifdef CONFIG_WPA_11KV_SUPPORT
+    // the AP names its neighbors, only their channels are scanned
+    if( esp_rrm_is_rrm_supported_connection() &&
+        esp_rrm_send_neighbor_rep_request(app_wifi_neighbor_report, NULL) == 0 ) {
+        return;
+    }
+#endif
+
+    app_wifi_roam_scan_next();
+}
+
+
+/**
+ * the channels of the neighbor report
+ */
+static void app_wifi_neighbors_event_handle(void *arg, esp_event_base_t event_base,
+                                           int32_t event_id, void *event_data)
+{
+    // a late report, the scans of the next attempt are already running
+    if( app_wifi_roaming || app_wifi_roam_scanning || !app_wifi_is_connected() ) {
+        return;
+    }
+
+    // an empty report, every channel
+    app_wifi_roam_channels = *(const uint16_t *) event_data;
+    app_wifi_roam_scan_next();
+}
+
+
+/**
+ * a background scan is done, scan the next channel or roam to the strongest AP
+ * Note: the blocking scans of app_wifi_connect_ap() end here too, they are not for roaming
+ */
+static void app_wifi_scan_done_event_handle(void *arg, esp_event_base_t event_base,
+                                           int32_t event_id, void *event_data)
+{
+    if( !app_wifi_roam_scanning ) {
+        return;
+    }
+
+    app_wifi_roam_scanning = false;
+
+    wifi_ap_record_t wifiScanList[APP_WIFI_SCAN_SIZE];
+    uint16_t apCount = APP_WIFI_SCAN_SIZE;
+    if( esp_wifi_scan_get_ap_records(&apCount, wifiScanList) == ESP_OK ) {
+
+        for( uint16_t apIdx = 0; apIdx < apCount; apIdx++ ) {
+
+            if( memcmp(wifiScanList[apIdx].bssid, t_device_wifi_bssid, 6) &&
+                wifiScanList[apIdx].rssi > app_wifi_roam_best_rssi ) {
+
+                memset(&app_wifi_roam_best, 0, sizeof(app_wifi_roam_best));
+                memcpy(app_wifi_roam_best.bssid, wifiScanList[apIdx].bssid, 6);
+                app_wifi_roam_best.channel = wifiScanList[apIdx].primary;
+                app_wifi_roam_best_rssi = wifiScanList[apIdx].rssi;
+            }
+        }
+    }
+
+    if( !app_wifi_is_connected() ) {
+        return;
+    }
+
+    if( app_wifi_roam_channels != 0 ) {
+        app_wifi_roam_scan_next();
+        return;
+    }
+
+    // the hysteresis, a slightly better AP is not worth a reconnection
+    if( app_wifi_roam_best_rssi < app_wifi_roam_rssi + APP_WIFI_ROAM_RSSI_GAIN ) {
+        ESP_LOGI(TAG, "no better AP, the best is %d", app_wifi_roam_best_rssi);
+        return;
+    }
+
+    ESP_LOGI(TAG, "roaming to %02X:%02X:%02X:%02X:%02X:%02X on channel %d, rssi %d", app_wifi_roam_best.bssid[0],
+                                                                                     app_wifi_roam_best.bssid[1],
+                                                                                     app_wifi_roam_best.bssid[2],
+                                                                                     app_wifi_roam_best.bssid[3],
+                                                                                     app_wifi_roam_best.bssid[4],
+                                                                                     app_wifi_roam_best.bssid[5],
+                                                                                     app_wifi_roam_best.channel,
+                                                                                     app_wifi_roam_best_rssi);
+
+    // the disconnection goes straight to the new AP, as after an outage
+    app_wifi_ap_keep(&app_wifi_roam_best);
+    app_wifi_roaming = true;
+    esp_wifi_disconnect();
+}
+
+
+/**
+ * scan the SSID on the lowest channel left, or on every channel
+ */
+static void app_wifi_roam_scan_next(void)
+{
+    uint8_t channel = 0;
+    if( app_wifi_roam_channels != 0 ) {
+        channel = __builtin_ctz(app_wifi_roam_channels);
+        app_wifi_roam_channels &= ~(1 << channel);
+    }
+
+    wifi_config_t wifiConfig = app_wifi_get_config();
+    wifi_scan_config_t wifiScanConf = {
+        .ssid = wifiConfig.sta.ssid,
+        .bssid = NULL,
+        .channel = channel,
+        .show_hidden = 0
+    };
+
+    app_wifi_roam_scanning = esp_wifi_scan_start(&wifiScanConf, false) == ESP_OK;
+}
+
+
+/**
+ * drop the background scan, the connection is lost
+ * Note: a roaming in progress stays, it is counted once connected, or failed
+ *       if the AP it went for does not take the device
+ */
+static void app_wifi_roam_stop(void)
+{
+    if( app_wifi_roam_scanning ) {
+        esp_wifi_scan_stop();
+        app_wifi_roam_scanning = false;
+    }
+
+    app_wifi_roam_channels = 0;
+}
+
+#ifdef CONFIG_WPA_11KV_SUPPORT
+/**
+ * 802.11k neighbor report, from the supplicant task
+ */
+static void app_wifi_neighbor_report(void *ctx, const uint8_t *report, size_t reportLen)
+{
+    uint16_t channels = 0;
+
+    for( size_t pos = 0; pos + 2 <= reportLen && pos + 2 + report[pos + 1] <= reportLen; pos += 2 + report[pos + 1] ) {
+
+        const uint8_t *element = report + pos + 2;
+        if( report[pos] == APP_WIFI_NEIGHBOR_REPORT_ID && report[pos + 1] > APP_WIFI_NEIGHBOR_REPORT_CHANNEL &&
+            element[APP_WIFI_NEIGHBOR_REPORT_CHANNEL] > 0 && element[APP_WIFI_NEIGHBOR_REPORT_CHANNEL] < 15 ) {
+
+            channels |= 1 << element[APP_WIFI_NEIGHBOR_REPORT_CHANNEL];
+        }
+    }
+
+    esp_event_post(APP_WIFI_EVENT, APP_WIFI_EVENT_NEIGHBORS, &channels, sizeof(channels), 0);
+}
+#endif
@@ -10,16 +10,49 @@
 #ifndef _APP_WIFI_H_
 #define _APP_WIFI_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define APP_WIFI_RSSI_HISTORY_SIZE              10      // a minute each, the last 10 minutes
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef struct {
+    uint32_t reconnects;                // disconnections that ended with an IP address
+    uint32_t fast;                      // of them, straight to the cached AP on its channel
+    uint32_t scanned;                   // of them, after a scan of the SSID
+    uint32_t lastTime;                  // in ms, from the disconnection to the IP address
+    uint32_t fastTime;                  // in ms, the average through the cached AP
+    uint32_t scanTime;                  // in ms, the average through a scan
+    uint32_t roams;                     // moves to a stronger AP while connected
+    uint32_t roamScans;                 // background scans for a stronger AP
+    uint32_t roamTime;                  // in ms, from leaving the AP to the IP address on the new one
+    uint32_t roamFails;                 // roams that did not end on the AP they went for, counted as outages
+    int8_t rssiHistory[APP_WIFI_RSSI_HISTORY_SIZE];     // in dBm, the average of each minute, oldest first
+    uint8_t rssiCount;
+    int8_t rssiMin;                     // in dBm, the weakest sample of the history
+    int8_t rssiAvg;                     // in dBm, the average of the history
+    int8_t rssiMax;                     // in dBm, the strongest sample of the history
+} app_wifi_stats_t;
+
 ///////////////////////////////////////////////////////////////////////////////////
 // public function
 void app_wifi_initialise(void);
 void app_wifi_wait_connected(void);
 bool app_wifi_is_connected(void);
 
+void app_wifi_time_restore(void);
+bool app_wifi_time_valid(void);
+bool app_wifi_time_confirmed(void);
 void app_wifi_ntp_request(void);
 void app_wifi_ntp_init(void);
+void app_wifi_ntp_wait(void);
+void app_wifi_preconnect(const char *uri);
 
 int8_t app_wifi_get_rssi(void);
+void app_wifi_get_stats(app_wifi_stats_t *stats);
 
 #endif
 
@@ -0,0 +1,98 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "boot.h"
+
+static const char *TAG = "BOOT";
+
+// Note: the time of each startup phase, in ms from the start of the app. the phases
+//       do not run in this order, the MQTT connection starts as soon as there is
+//       an IP address and a valid time, while SNTP is still in flight. only the first
+//       time a phase is reached is kept, a reconnect does not move it
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static const char *const boot_phase_names[BOOT_PHASE_COUNT] = {
+    [BOOT_PHASE_TIME] = "time",
+    [BOOT_PHASE_WIFI] = "wifi",
+    [BOOT_PHASE_DNS] = "dns",
+    [BOOT_PHASE_TCP] = "tcp",
+    [BOOT_PHASE_NTP] = "ntp",
+    [BOOT_PHASE_MQTT] = "mqtt",
+};
+
+static const char *const boot_time_source_names[] = {
+    [BOOT_TIME_NONE] = "none",
+    [BOOT_TIME_RTC] = "rtc",
+    [BOOT_TIME_NVS] = "nvs",
+    [BOOT_TIME_NTP] = "ntp",
+};
+
+static int32_t boot_phases[BOOT_PHASE_COUNT] = { -1, -1, -1, -1, -1, -1 };
+static boot_time_source_t boot_time_source = BOOT_TIME_NONE;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+/**
+ * the phase is reached now, from any task
+ */
+void boot_mark(boot_phase_t phase)
+{
+    if( phase >= BOOT_PHASE_COUNT || boot_phases[phase] >= 0 ) {
+        return;
+    }
+
+    boot_phases[phase] = esp_timer_get_time() / 1000;
+
+    ESP_LOGI(TAG, "%s at %d ms", boot_phase_names[phase], boot_phases[phase]);
+}
+
+
+/**
+ * @return in ms from the start of the app, -1 if the phase is not reached yet
+ */
+int32_t boot_get_phase(boot_phase_t phase)
+{
+    if( phase >= BOOT_PHASE_COUNT ) {
+        return(-1);
+    }
+
+    return(boot_phases[phase]);
+}
+
+
+const char *boot_phase_name(boot_phase_t phase)
+{
+    if( phase >= BOOT_PHASE_COUNT ) {
+        return("");
+    }
+
+    return(boot_phase_names[phase]);
+}
+
+
+/**
+ * where the time came from, the last source wins
+ */
+void boot_set_time_source(boot_time_source_t source)
+{
+    boot_time_source = source;
+    boot_mark(BOOT_PHASE_TIME);
+}
+
+
+const char *boot_time_source_name(void)
+{
+    return(boot_time_source_names[boot_time_source]);
+}
@@ -0,0 +1,42 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _BOOT_H_
+#define _BOOT_H_
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef enum {
+    BOOT_PHASE_TIME = 0,                // a valid time, restored or from SNTP
+    BOOT_PHASE_WIFI,                    // the first IP address
+    BOOT_PHASE_DNS,                     // the broker resolved ahead of the MQTT client
+    BOOT_PHASE_TCP,                     // the broker reached ahead of the MQTT client
+    BOOT_PHASE_NTP,                     // the first SNTP sync
+    BOOT_PHASE_MQTT,                    // the first MQTT connection, the device is ready
+    BOOT_PHASE_COUNT
+} boot_phase_t;
+
+typedef enum {
+    BOOT_TIME_NONE = 0,
+    BOOT_TIME_RTC,                      // kept by the RTC across a software reset
+    BOOT_TIME_NVS,                      // the last good time, from before a power cut
+    BOOT_TIME_NTP
+} boot_time_source_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void boot_mark(boot_phase_t phase);
+int32_t boot_get_phase(boot_phase_t phase);
+const char *boot_phase_name(boot_phase_t phase);
+void boot_set_time_source(boot_time_source_t source);
+const char *boot_time_source_name(void);
+
+#endif
@@ -87,7 +87,7 @@ void button_init(void)
 
 
 /**
- * Handle all button event, call by t_gpio_task()
+ * Handle all button event, call by t_gpio_task() on T_GPIO_EVENT_BUTTON
  */
 void button_handle(void)
 {
@@ -130,5 +130,10 @@ static void IRAM_ATTR button_isr_handler(void* arg)
 
     // LEAVE critical section
     portEXIT_CRITICAL_ISR(&button_mux);
+
+    // let the gpio task handle it
+    if( button_level == 1 ) {
+        t_gpio_notify_from_isr(T_GPIO_EVENT_BUTTON);
+    }
 }
 // ******************************************************************************
@@ -17,8 +17,9 @@
 #include "esp_int_wdt.h"
 #include "esp_task_wdt.h"
 #include "esp_system.h"
+#include "esp_attr.h"
 #include "esp_log.h"
-#include "mbedtls/aes.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "driver/ledc.h"
 #include "nvs_flash.h"
@@ -27,39 +28,29 @@
 #include "open_tls.h"
 #include "util.h"
 #include "cmd.h"
+#include "relay.h"
+#include "cmd_sched.h"
+#include "otp.h"
+#include "app_wifi.h"
 
 static const char *TAG = "CMD";
 
 ///////////////////////////////////////////////////////////////////////////////////
 // defines
 #define CMD_QUEUE_SIZE                  16
-#define	CMD_EVENT_WAITING_TIME			1000	// in ms
-#define CMD_RELAY_STAY_TIME             700     // in ms
-
-///////////////////////////////////////////////////////////////////////////////////
-// typedefs
-typedef struct {
-    uint32_t random1;
-    uint32_t otpTime;
-    uint32_t random3;
-    uint8_t random4[3];
-    uint8_t checksum;
-} cmd_otp_type_t;
+#define	CMD_EVENT_WAITING_TIME			1000	// in ms, the longest wait, for the watchdog
 
 ///////////////////////////////////////////////////////////////////////////////////
 // local variables
 static QueueHandle_t cmd_que = NULL;
-
-static bool cmd_delayed_stop_action = false;
-static time_t cmd_delayed_stop_action_time = 0;
-
-static bool cmd_delayed_close_action = false;
-static time_t cmd_delayed_close_action_time = 0;
+static otp_verifier_t cmd_otp_verifier;
+static RTC_NOINIT_ATTR otp_replay_store_t cmd_otp_replay;  // the accepted OTPs survive a reboot
 
 ///////////////////////////////////////////////////////////////////////////////////
 // local function
 void cmd_loop(void * arg);
-void cmd_perform(cmd_action_code_t action);
+void cmd_perform(cmd_action_code_t action, const latency_stamps_t *stamps);
+static TickType_t cmd_wait_ticks(void);
 
 ///////////////////////////////////////////////////////////////////////////////////
 // public function implementations
@@ -71,11 +62,17 @@ void cmd_init(void)
 {
     TaskHandle_t cmdEventHnd;
 
-    // vars init
-    cmd_delayed_stop_action = false;
-    cmd_delayed_stop_action_time = 0;
-    cmd_delayed_close_action = false;
-    cmd_delayed_close_action_time = 0;
+    // the AES key is expanded once, not for every command
+    if( !otp_verifier_init(&cmd_otp_verifier, OPEN_TLS_OTP_AES_KEY, OPEN_TLS_CMD_OTP_TOLERANCE, &cmd_otp_replay) ) {
+
+        ESP_LOGE(TAG, "AES KEY configuration error");
+    }
+
+    // delayed actions, including the ones pending before a reboot
+    cmd_sched_init(app_wifi_time_confirmed());
+
+    // stage histograms of the command path
+    latency_init();
 
     // create the command handling queues
     cmd_que = xQueueCreate(CMD_QUEUE_SIZE, sizeof(cmd_action_t));
@@ -85,6 +82,9 @@ void cmd_init(void)
         return;
     }
 
+    // relay pulses are ended by a timer, the command task never waits for them
+    relay_init();
+
 	// create the receiver task
 	xTaskCreate(&cmd_loop, "cmd_task", 3096, NULL, 1, &cmdEventHnd);	  // lowest priority
 	esp_task_wdt_add(cmdEventHnd);
@@ -102,6 +102,9 @@ void cmd_add(cmd_action_t *cmdSet)
         return;
     }
 
+    // the relay layer reports how long the command waited before actuation
+    cmdSet->stamps.queued = esp_timer_get_time();
+
     // add the command queue without waiting
     if( xQueueSend(cmd_que, cmdSet, 0) != pdTRUE ) {
 
@@ -109,6 +112,40 @@ void cmd_add(cmd_action_t *cmdSet)
     }
 }
 
+/**
+ * copy the OTP verifier counters for the device report
+ */
+void cmd_get_otp_stats(otp_stats_t *stats)
+{
+    *stats = cmd_otp_verifier.stats;
+}
+
+
+/**
+ * check an OTP as the command task will, from another task, without remembering it
+ * the rate limit lets a command with a valid OTP through a flood
+ *
+ * @return true if the OTP would be accepted now, one the command task accepted before is not
+ */
+bool cmd_otp_check(const uint8_t *otpAuth)
+{
+    otp_plain_t otp;
+    time_t currentTime;
+
+    if( !app_wifi_time_confirmed() ) {
+        return(false);
+    }
+
+    time(&currentTime);
+
+    // a replay is rejected on the ciphertext, before any decryption
+    if( otp_replay_seen(&cmd_otp_verifier, otpAuth, currentTime) ) {
+        return(false);
+    }
+
+    return(otp_check(&cmd_otp_verifier, otpAuth, currentTime, &otp) == OTP_VERIFY_OK);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////
 // local function implementations
 void cmd_loop(void * arg)
@@ -120,112 +157,102 @@ void cmd_loop(void * arg)
 
         cmd_action_t cmdEvent;
 
-		// receive the event from the queue
-		if( xQueueReceive(cmd_que, &cmdEvent, pdMS_TO_TICKS(CMD_EVENT_WAITING_TIME)) ) {
-
-            ESP_LOGI(TAG, "incoming queue command=%d", cmdEvent.command_action);
+		// receive the event from the queue, or wake up for the next delayed action
+		if( xQueueReceive(cmd_que, &cmdEvent, cmd_wait_ticks()) ) {
 
-            // AED decrypt
-            esp_aes_context aes;
-            uint8_t aesKey[16];
-            uint8_t plainText[16];
+            cmdEvent.stamps.dequeued = esp_timer_get_time();
 
-            if( util_string_to_aes_key(OPEN_TLS_OTP_AES_KEY, aesKey) ) {
-
-                // set AES key
-                esp_aes_setkey(&aes, aesKey, 128);
+            ESP_LOGI(TAG, "incoming queue command=%d", cmdEvent.command_action);
 
-                // decrypt
-                esp_aes_crypt_ecb(&aes, ESP_AES_DECRYPT, cmdEvent.otpAuth, plainText);
+            // decrypt and verify the OTP with the key schedule built at init
+            otp_plain_t otp;
+            time_t currentTime;
 
-                // verify checksum
-                uint8_t checksum = 0;
-                for( uint8_t pIdx=0; pIdx < 15; pIdx++ ) {
+            // a restored time may be far behind, nothing is checked against it
+            bool timeConfirmed = app_wifi_time_confirmed();
+            otp_verify_result_t result = OTP_VERIFY_TIME;
 
-                    checksum += plainText[pIdx];
-                }
+            time(&currentTime);
+            if( timeConfirmed ) {
+                result = otp_verify(&cmd_otp_verifier, cmdEvent.otpAuth, currentTime, &otp);
+            }
+            cmdEvent.stamps.verified = esp_timer_get_time();
 
-                if( checksum == plainText[15] ) {
+            if( !timeConfirmed ) {
 
-                    // decode the timestamp
-                    cmd_otp_type_t *otp = (cmd_otp_type_t *) plainText;
+                ESP_LOGI(TAG, "otp rejected, the time is not confirmed by SNTP yet");
 
-                    ESP_LOGI(TAG, "decrypted checksum matched (0x%02x)", otp->checksum);
+            } else if( result == OTP_VERIFY_OK ) {
 
-                    // check time difference
-                    time_t currentTime;
-                    int32_t timeDiff;
+                ESP_LOGI(TAG, "decrypted checksum matched (0x%02x)", otp.checksum);
+                ESP_LOGI(TAG, "otp time difference = %d", (int32_t) currentTime - (int32_t) otp.otpTime);
 
-                    // get current time
-                    time(&currentTime);
-                    timeDiff = (int32_t) currentTime - (int32_t) otp->otpTime;
+                // a new door command takes over from the pending delayed actions
+                if( cmdEvent.command_action >= CMD_ACTION_OPEN && cmdEvent.command_action <= CMD_ACTION_OPEN_STOP_CLOSE ) {
+                    cmd_sched_cancel();
+                }
 
-                    ESP_LOGI(TAG, "otp time difference = %d", timeDiff);
+                // everything is correct, perform the action
+                cmd_perform(cmdEvent.command_action, &cmdEvent.stamps);
 
-                    if( timeDiff <= OPEN_TLS_CMD_OTP_TOLERANCE ) {
+            } else if( result == OTP_VERIFY_TIME ) {
 
-                        // everything is correct, perform the action
-                        cmd_perform(cmdEvent.command_action);
+                // timestamp is not right, someone is reusing the old messages!?
+                ESP_LOGI(TAG, "intolerable timestamp is used");
 
-                    } else {
+                // convert time string
+                char strftime_buf[64];
+                struct tm timeinfo = { 0 };
+                time_t obtainedTimestamp = (time_t) otp.otpTime;
+                localtime_r(&obtainedTimestamp, &timeinfo);
+                strftime(strftime_buf, sizeof(strftime_buf), "%c", &timeinfo);
+                ESP_LOGI(TAG, "Obtained timestamp GMT date/time: %s", strftime_buf);
 
-                        // timestamp is not right, someone is reusing the old messages!?
-                        ESP_LOGI(TAG, "intolerable timestamp is used");
+            } else if( result == OTP_VERIFY_REPLAY || result == OTP_VERIFY_REPLAY_FULL ) {
 
-                        // convert time string
-                        char strftime_buf[64];
-                        struct tm timeinfo = { 0 };
-                        time_t obtainedTimestamp = (time_t) otp->otpTime;
-                        localtime_r(&obtainedTimestamp, &timeinfo);
-                        strftime(strftime_buf, sizeof(strftime_buf), "%c", &timeinfo);
-                        ESP_LOGI(TAG, "Obtained timestamp GMT date/time: %s", strftime_buf);
-                    }
-                } else {
+                // the OTP was already used, or could not be remembered to stop a later replay
+                ESP_LOGI(TAG, "otp rejected, %s", result == OTP_VERIFY_REPLAY ? "replayed" : "replay cache full");
 
-                    ESP_LOGI(TAG, "checksum not matched! (cal=0x%02x vs rcv=0x%02x)", checksum, plainText[15]);
+            } else if( result == OTP_VERIFY_CHECKSUM ) {
 
-                    // show the decrypted message for debugging
-                    char decryptedMsg[64];
-                    decryptedMsg[0] = 0;
-                    for( uint8_t decIdx=0; decIdx<16; decIdx++ ) {
-                        char msgChip[8];
-                        sprintf(msgChip, "%02x", plainText[decIdx]);
-                        strcat(decryptedMsg, msgChip);
-                    }
+                uint8_t *plainText = (uint8_t *) &otp;
+                uint8_t checksum = 0;
+                for( uint8_t pIdx=0; pIdx < 15; pIdx++ ) {
 
-                    ESP_LOGI(TAG, "DECRYPTED MSG: %s", decryptedMsg);
+                    checksum += plainText[pIdx];
                 }
-            } else {
 
-                ESP_LOGE(TAG, "AES KEY configuration error");
-            }
-        }
+                ESP_LOGI(TAG, "checksum not matched! (cal=0x%02x vs rcv=0x%02x)", checksum, plainText[15]);
 
-        // get current time for the following up the delayed actions
-        time_t currentTime;
-        time(&currentTime);
-
-        // check if any delayed actions to perform
-        if( cmd_delayed_stop_action ) {
+                // show the decrypted message for debugging
+                char decryptedMsg[64];
+                decryptedMsg[0] = 0;
+                for( uint8_t decIdx=0; decIdx<16; decIdx++ ) {
+                    char msgChip[8];
+                    sprintf(msgChip, "%02x", plainText[decIdx]);
+                    strcat(decryptedMsg, msgChip);
+                }
 
-            if( currentTime >= cmd_delayed_stop_action_time ) {
+                ESP_LOGI(TAG, "DECRYPTED MSG: %s", decryptedMsg);
 
-                cmd_perform(CMD_ACTION_STOP);
-                cmd_delayed_stop_action = false;
+            } else {
 
-                ESP_LOGI(TAG, "delayed STOP performed");
+                ESP_LOGE(TAG, "AES KEY configuration error");
             }
         }
 
-        if( cmd_delayed_close_action ) {
+        // restore the delayed actions of the last boot, follow the steps of the wall clock
+        cmd_sched_poll(app_wifi_time_confirmed());
 
-            if( currentTime >= cmd_delayed_close_action_time ) {
+        // perform the delayed actions which are due
+        cmd_action_code_t delayedAction;
+        while( (delayedAction = cmd_sched_pop_due()) != CMD_ACTION_NONE ) {
 
-                cmd_perform(CMD_ACTION_CLOSE);
-                cmd_delayed_close_action = false;
+            // not from MQTT, only the queued time is known
+            latency_stamps_t stamps = { .queued = esp_timer_get_time() };
+            cmd_perform(delayedAction, &stamps);
 
-                ESP_LOGI(TAG, "delayed CLOSE performed");
-            }
+            ESP_LOGI(TAG, "delayed action %d performed", delayedAction);
         }
 
 		// watchdog
@@ -241,48 +268,50 @@ void cmd_loop(void * arg)
 
 /**
  * Perform the IO actions
+ * the relay pulses are timed by the relay layer, this returns at once
  */
-void cmd_perform(cmd_action_code_t action)
+void cmd_perform(cmd_action_code_t action, const latency_stamps_t *stamps)
 {
     if( action == CMD_ACTION_OPEN ) {
 
         // --------- OPEN ---------
-        gpio_set_level(OPEN_TLS_HW_DOOR_OPEN, 1);
-        vTaskDelay(pdMS_TO_TICKS(CMD_RELAY_STAY_TIME));
-        gpio_set_level(OPEN_TLS_HW_DOOR_OPEN, 0);
+        relay_pulse(OPEN_TLS_HW_DOOR_OPEN, stamps);
 
     } else if( action == CMD_ACTION_STOP ) {
 
         // --------- STOP ---------
-        gpio_set_level(OPEN_TLS_HW_DOOR_STOP, 1);
-        vTaskDelay(pdMS_TO_TICKS(CMD_RELAY_STAY_TIME));
-        gpio_set_level(OPEN_TLS_HW_DOOR_STOP, 0);
+        relay_pulse(OPEN_TLS_HW_DOOR_STOP, stamps);
 
     } else if( action == CMD_ACTION_CLOSE ) {
 
         // --------- CLOSE ---------
-        gpio_set_level(OPEN_TLS_HW_DOOR_CLOSE, 1);
-        vTaskDelay(pdMS_TO_TICKS(CMD_RELAY_STAY_TIME));
-        gpio_set_level(OPEN_TLS_HW_DOOR_CLOSE, 0);
+        relay_pulse(OPEN_TLS_HW_DOOR_CLOSE, stamps);
 
     } else if( action == CMD_ACTION_OPEN_STOP_CLOSE ) {
 
         // --------- OPEN-STOP-THEN-CLOSE ---------
         // make it open first
-        gpio_set_level(OPEN_TLS_HW_DOOR_OPEN, 1);
-        vTaskDelay(pdMS_TO_TICKS(CMD_RELAY_STAY_TIME));
-        gpio_set_level(OPEN_TLS_HW_DOOR_OPEN, 0);
-
-        // get current time
-        time_t currentTime;
-        time(&currentTime);
-
-        // define the delayed action timers
-        cmd_delayed_stop_action_time = currentTime + OPEN_TLS_DOOR_OPEN_STOP_CLOSE_TIMER_STOP;
-        cmd_delayed_close_action_time = currentTime + OPEN_TLS_DOOR_OPEN_THEN_CLOSE_TIMER_CLOSE;
-        cmd_delayed_stop_action = true;
-        cmd_delayed_close_action = true;
+        relay_pulse(OPEN_TLS_HW_DOOR_OPEN, stamps);
+
+        // then stop and close it later
+        cmd_sched_add(CMD_ACTION_STOP, OPEN_TLS_DOOR_OPEN_STOP_CLOSE_TIMER_STOP * 1000);
+        cmd_sched_add(CMD_ACTION_CLOSE, OPEN_TLS_DOOR_OPEN_THEN_CLOSE_TIMER_CLOSE * 1000);
     }
     // Note: there is no else
 }
 
+
+/**
+ * ticks to wait for the next command, rounded up so the next delayed action is
+ * due when the task wakes up, and never longer than CMD_EVENT_WAITING_TIME
+ */
+static TickType_t cmd_wait_ticks(void)
+{
+    int64_t waitUs = cmd_sched_next_wait();
+
+    if( waitUs < 0 || waitUs >= (int64_t) CMD_EVENT_WAITING_TIME * 1000 ) {
+        return(pdMS_TO_TICKS(CMD_EVENT_WAITING_TIME));
+    }
+
+    return((TickType_t) ((waitUs + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000)));
+}
@@ -11,6 +11,8 @@
 #define _CMD_H_
 
 #include "esp_system.h"
+#include "otp.h"
+#include "latency.h"
 
 ///////////////////////////////////////////////////////////////////////////////////
 // defines
@@ -24,12 +26,14 @@ typedef enum {
     CMD_ACTION_CLOSE = 3,
     CMD_ACTION_OPEN_STOP_CLOSE = 4,
     CMD_ACTION_FORCE_REPORT = 5,
-    CMD_ACTION_INVALID = 6
+    CMD_ACTION_LATENCY_REPORT = 6,
+    CMD_ACTION_INVALID = 7
 } cmd_action_code_t;
 
 typedef struct {
     uint32_t command_action;
     uint8_t otpAuth[16];
+    latency_stamps_t stamps;            // arrival and parsed are set by the caller of cmd_add()
 } cmd_action_t;
 
 
@@ -37,5 +41,7 @@ typedef struct {
 // public functions
 void cmd_init(void);
 void cmd_add(cmd_action_t *cmdSet);
+void cmd_get_otp_stats(otp_stats_t *stats);
+bool cmd_otp_check(const uint8_t *otpAuth);
 
 #endif
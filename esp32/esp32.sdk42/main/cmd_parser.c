@@ -0,0 +1,433 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "util.h"
+#include "cmd_parser.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define CMD_PARSER_KEY_COMMAND              "command"
+#define CMD_PARSER_KEY_OTP_AUTH             "otp-auth"
+#define CMD_PARSER_OTP_AUTH_LEN             32
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+
+// reading position over the not null-terminated message
+typedef struct {
+    const char *data;
+    uint32_t len;
+    uint32_t pos;
+} cmd_parser_cursor_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static void cmd_parser_skip_space(cmd_parser_cursor_t *cur);
+static bool cmd_parser_string(cmd_parser_cursor_t *cur, const char **str, uint32_t *strLen, bool *escaped);
+static bool cmd_parser_number(cmd_parser_cursor_t *cur, bool *isUnsigned, uint32_t *value);
+static bool cmd_parser_literal(cmd_parser_cursor_t *cur, const char *literal);
+static bool cmd_parser_skip_value(cmd_parser_cursor_t *cur, uint8_t depth);
+static bool cmd_parser_key_is(const char *key, uint32_t keyLen, const char *name);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+/**
+ * parse a JSON command in place, only "command" and "otp-auth" are extracted
+ * nothing is allocated and the message does not need to be null-terminated.
+ * the same as cJSON, key names are case insensitive and the first key wins.
+ *
+ * @param data JSON message
+ * @param len length of the message
+ * @param result the extracted command
+ *
+ * @return true if the message is a valid JSON object
+ */
+bool cmd_parser_json(const char *data, uint32_t len, cmd_parser_json_t *result)
+{
+    cmd_parser_cursor_t cur = { .data = data, .len = len, .pos = 0 };
+    bool commandFound = false;
+    bool otpAuthFound = false;
+
+    memset(result, 0, sizeof(cmd_parser_json_t));
+
+    cmd_parser_skip_space(&cur);
+    if( cur.pos >= cur.len || cur.data[cur.pos] != '{' ) {
+        return(false);
+    }
+    cur.pos++;
+
+    cmd_parser_skip_space(&cur);
+    if( cur.pos < cur.len && cur.data[cur.pos] == '}' ) {
+        return(true);
+    }
+
+    while( cur.pos < cur.len ) {
+
+        const char *key;
+        uint32_t keyLen;
+        bool keyEscaped;
+
+        // "key" :
+        cmd_parser_skip_space(&cur);
+        if( !cmd_parser_string(&cur, &key, &keyLen, &keyEscaped) ) {
+            return(false);
+        }
+
+        cmd_parser_skip_space(&cur);
+        if( cur.pos >= cur.len || cur.data[cur.pos] != ':' ) {
+            return(false);
+        }
+        cur.pos++;
+        cmd_parser_skip_space(&cur);
+
+        if( !keyEscaped && !commandFound && cmd_parser_key_is(key, keyLen, CMD_PARSER_KEY_COMMAND) ) {
+
+            uint32_t value;
+            bool isUnsigned;
+
+            commandFound = true;
+
+            if( cur.pos < cur.len && (cur.data[cur.pos] == '-' || (cur.data[cur.pos] >= '0' && cur.data[cur.pos] <= '9')) ) {
+
+                if( !cmd_parser_number(&cur, &isUnsigned, &value) ) {
+                    return(false);
+                }
+
+                // negative or out of range numbers are never a valid action
+                result->command = isUnsigned ? value : 0;
+
+            } else if( !cmd_parser_skip_value(&cur, 0) ) {
+                return(false);
+            }
+
+        } else if( !keyEscaped && !otpAuthFound && cmd_parser_key_is(key, keyLen, CMD_PARSER_KEY_OTP_AUTH) ) {
+
+            const char *otp;
+            uint32_t otpLen;
+            bool otpEscaped;
+
+            otpAuthFound = true;
+
+            if( cur.pos >= cur.len || cur.data[cur.pos] != '"' ) {
+
+                // not a string, ignore it
+                if( !cmd_parser_skip_value(&cur, 0) ) {
+                    return(false);
+                }
+                otpLen = 0;
+                otpEscaped = true;
+
+            } else if( !cmd_parser_string(&cur, &otp, &otpLen, &otpEscaped) ) {
+                return(false);
+            }
+
+            // 16-byte encrypted data must be 32 hex digits, converted in place
+            if( !otpEscaped && otpLen == CMD_PARSER_OTP_AUTH_LEN ) {
+
+                bool foundNonDigit = false;
+                for( uint8_t nIdx = 0; nIdx < 16; nIdx++ ) {
+
+                    int8_t digitHiValue = util_hex_digit_to_dec(otp[nIdx * 2]);
+                    int8_t digitLoValue = util_hex_digit_to_dec(otp[nIdx * 2 + 1]);
+
+                    if( digitHiValue < 0 || digitLoValue < 0 ) {
+                        foundNonDigit = true;
+                        break;
+                    }
+
+                    result->otpAuth[nIdx] = digitHiValue << 4 | digitLoValue;
+                }
+
+                result->otpAuthFound = !foundNonDigit;
+            }
+
+        } else if( !cmd_parser_skip_value(&cur, 0) ) {
+            return(false);
+        }
+
+        // , or }
+        cmd_parser_skip_space(&cur);
+        if( cur.pos >= cur.len ) {
+            return(false);
+        }
+
+        if( cur.data[cur.pos] == '}' ) {
+            return(true);
+        } else if( cur.data[cur.pos] != ',' ) {
+            return(false);
+        }
+        cur.pos++;
+    }
+
+    return(false);
+}
+
+/**
+ * check the magic prefix of the binary command frame
+ */
+bool cmd_parser_is_frame(const char *data, uint32_t len)
+{
+    return(len >= 2 &&
+           (uint8_t) data[0] == CMD_PARSER_FRAME_MAGIC_0 &&
+           (uint8_t) data[1] == CMD_PARSER_FRAME_MAGIC_1);
+}
+
+
+/**
+ * take the command from a binary frame, the OTP is copied as is
+ *
+ * @param data binary frame
+ * @param len length of the frame
+ * @param cmdSet the command to be added to the command queue
+ *
+ * @return true if the frame is a supported version with a valid action
+ */
+bool cmd_parser_frame(const char *data, uint32_t len, cmd_action_t *cmdSet)
+{
+    const cmd_parser_frame_t *frame = (const cmd_parser_frame_t *) data;
+
+    if( len != sizeof(cmd_parser_frame_t) ||
+        !cmd_parser_is_frame(data, len) ||
+        frame->version != CMD_PARSER_FRAME_VERSION ) {
+        return(false);
+    }
+
+    if( frame->action <= CMD_ACTION_NONE || frame->action >= CMD_ACTION_INVALID ) {
+        return(false);
+    }
+
+    cmdSet->command_action = frame->action;
+    memcpy(cmdSet->otpAuth, frame->otpAuth, sizeof(cmdSet->otpAuth));
+
+    return(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+static void cmd_parser_skip_space(cmd_parser_cursor_t *cur)
+{
+    while( cur->pos < cur->len &&
+           (cur->data[cur->pos] == ' ' || cur->data[cur->pos] == '\t' ||
+            cur->data[cur->pos] == '\r' || cur->data[cur->pos] == '\n') ) {
+        cur->pos++;
+    }
+}
+
+
+/**
+ * find the string boundary, the content is not unescaped
+ */
+static bool cmd_parser_string(cmd_parser_cursor_t *cur, const char **str, uint32_t *strLen, bool *escaped)
+{
+    if( cur->pos >= cur->len || cur->data[cur->pos] != '"' ) {
+        return(false);
+    }
+    cur->pos++;
+
+    *str = cur->data + cur->pos;
+    *escaped = false;
+
+    while( cur->pos < cur->len ) {
+
+        char c = cur->data[cur->pos];
+
+        if( c == '"' ) {
+            *strLen = (cur->data + cur->pos) - *str;
+            cur->pos++;
+            return(true);
+        } else if( c == '\\' ) {
+            *escaped = true;
+            cur->pos++;
+        } else if( (uint8_t) c < 0x20 ) {
+            // control characters must be escaped
+            return(false);
+        }
+
+        cur->pos++;
+    }
+
+    return(false);
+}
+
+
+/**
+ * parse a JSON number, only the integer part is kept (the same as cJSON valueint)
+ *
+ * @param isUnsigned false if the number is negative, has an exponent or is out of range
+ */
+static bool cmd_parser_number(cmd_parser_cursor_t *cur, bool *isUnsigned, uint32_t *value)
+{
+    uint32_t start = cur->pos;
+
+    *isUnsigned = true;
+    *value = 0;
+
+    if( cur->pos < cur->len && cur->data[cur->pos] == '-' ) {
+        *isUnsigned = false;
+        cur->pos++;
+    }
+
+    uint32_t digitStart = cur->pos;
+    while( cur->pos < cur->len && cur->data[cur->pos] >= '0' && cur->data[cur->pos] <= '9' ) {
+
+        if( *value > (UINT32_MAX - 9) / 10 ) {
+            *isUnsigned = false;
+        }
+        *value = *value * 10 + (cur->data[cur->pos] - '0');
+        cur->pos++;
+    }
+
+    if( cur->pos == digitStart ) {
+        return(false);
+    }
+
+    // fraction
+    if( cur->pos < cur->len && cur->data[cur->pos] == '.' ) {
+        cur->pos++;
+        digitStart = cur->pos;
+        while( cur->pos < cur->len && cur->data[cur->pos] >= '0' && cur->data[cur->pos] <= '9' ) {
+            cur->pos++;
+        }
+        if( cur->pos == digitStart ) {
+            return(false);
+        }
+    }
+
+    // exponent
+    if( cur->pos < cur->len && (cur->data[cur->pos] == 'e' || cur->data[cur->pos] == 'E') ) {
+        *isUnsigned = false;
+        cur->pos++;
+        if( cur->pos < cur->len && (cur->data[cur->pos] == '+' || cur->data[cur->pos] == '-') ) {
+            cur->pos++;
+        }
+        digitStart = cur->pos;
+        while( cur->pos < cur->len && cur->data[cur->pos] >= '0' && cur->data[cur->pos] <= '9' ) {
+            cur->pos++;
+        }
+        if( cur->pos == digitStart ) {
+            return(false);
+        }
+    }
+
+    return(cur->pos > start);
+}
+
+
+static bool cmd_parser_literal(cmd_parser_cursor_t *cur, const char *literal)
+{
+    uint32_t literalLen = strlen(literal);
+
+    if( cur->len - cur->pos < literalLen || memcmp(cur->data + cur->pos, literal, literalLen) ) {
+        return(false);
+    }
+    cur->pos += literalLen;
+
+    return(true);
+}
+
+
+/**
+ * skip over any JSON value, nesting is bounded by CMD_PARSER_MAX_DEPTH
+ */
+static bool cmd_parser_skip_value(cmd_parser_cursor_t *cur, uint8_t depth)
+{
+    if( cur->pos >= cur->len ) {
+        return(false);
+    }
+
+    char c = cur->data[cur->pos];
+
+    if( c == '"' ) {
+        const char *str;
+        uint32_t strLen;
+        bool escaped;
+        return(cmd_parser_string(cur, &str, &strLen, &escaped));
+
+    } else if( c == '-' || (c >= '0' && c <= '9') ) {
+        bool isUnsigned;
+        uint32_t value;
+        return(cmd_parser_number(cur, &isUnsigned, &value));
+
+    } else if( c == 't' ) {
+        return(cmd_parser_literal(cur, "true"));
+
+    } else if( c == 'f' ) {
+        return(cmd_parser_literal(cur, "false"));
+
+    } else if( c == 'n' ) {
+        return(cmd_parser_literal(cur, "null"));
+
+    } else if( c == '{' || c == '[' ) {
+
+        char closing = (c == '{') ? '}' : ']';
+
+        if( depth >= CMD_PARSER_MAX_DEPTH ) {
+            return(false);
+        }
+        cur->pos++;
+
+        cmd_parser_skip_space(cur);
+        if( cur->pos < cur->len && cur->data[cur->pos] == closing ) {
+            cur->pos++;
+            return(true);
+        }
+
+        while( cur->pos < cur->len ) {
+
+            if( c == '{' ) {
+                const char *key;
+                uint32_t keyLen;
+                bool escaped;
+
+                cmd_parser_skip_space(cur);
+                if( !cmd_parser_string(cur, &key, &keyLen, &escaped) ) {
+                    return(false);
+                }
+                cmd_parser_skip_space(cur);
+                if( cur->pos >= cur->len || cur->data[cur->pos] != ':' ) {
+                    return(false);
+                }
+                cur->pos++;
+            }
+
+            cmd_parser_skip_space(cur);
+            if( !cmd_parser_skip_value(cur, depth + 1) ) {
+                return(false);
+            }
+
+            cmd_parser_skip_space(cur);
+            if( cur->pos >= cur->len ) {
+                return(false);
+            }
+
+            if( cur->data[cur->pos] == closing ) {
+                cur->pos++;
+                return(true);
+            } else if( cur->data[cur->pos] != ',' ) {
+                return(false);
+            }
+            cur->pos++;
+        }
+    }
+
+    return(false);
+}
+
+
+static bool cmd_parser_key_is(const char *key, uint32_t keyLen, const char *name)
+{
+    return(keyLen == strlen(name) && !strncasecmp(key, name, keyLen));
+}
@@ -0,0 +1,49 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _CMD_PARSER_H_
+#define _CMD_PARSER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cmd.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define CMD_PARSER_MAX_DEPTH                8       // nesting allowed for the unknown values
+
+// binary command frame, the magic can never start a JSON message
+#define CMD_PARSER_FRAME_MAGIC_0            0xA5
+#define CMD_PARSER_FRAME_MAGIC_1            0x5A
+#define CMD_PARSER_FRAME_VERSION            1
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef struct {
+    uint32_t command;                   // 0 if "command" is missing or not a number
+    bool otpAuthFound;                  // "otp-auth" is a 32-digit hex string
+    uint8_t otpAuth[16];
+} cmd_parser_json_t;
+
+// version 1 of the binary command frame, 20 bytes
+typedef struct __attribute__((packed)) {
+    uint8_t magic[2];                   // CMD_PARSER_FRAME_MAGIC_0, CMD_PARSER_FRAME_MAGIC_1
+    uint8_t version;                    // CMD_PARSER_FRAME_VERSION
+    uint8_t action;                     // cmd_action_code_t
+    uint8_t otpAuth[16];                // raw AES-128 OTP, the same bytes as the hex "otp-auth"
+} cmd_parser_frame_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+bool cmd_parser_json(const char *data, uint32_t len, cmd_parser_json_t *result);
+bool cmd_parser_is_frame(const char *data, uint32_t len);
+bool cmd_parser_frame(const char *data, uint32_t len, cmd_action_t *cmdSet);
+
+#endif
@@ -0,0 +1,338 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/time.h>
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp32/rom/crc.h"
+
+#include "cmd_sched.h"
+
+static const char *TAG = "CMD_SCHED";
+
+// Note: the delayed actions of the command task, kept in a min-heap by deadline
+//       only the command task calls these functions, there is no locking
+//
+//       the deadlines are on esp_timer, which an SNTP step does not move. A copy of the
+//       heap is sealed in RTC memory with the deadlines on the wall clock, which the RTC
+//       keeps across a watchdog or panic reboot while esp_timer starts over from zero.
+//       The copy is resealed when the wall clock steps, and restored on the next boot
+//       once SNTP confirmed the clock, see cmd_sched_poll()
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define CMD_SCHED_MAGIC                     0x43534844  // "CSHD"
+#define CMD_SCHED_CLOCK_STEP                1000000     // in us, a larger change of the wall clock is a step
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct {
+    int64_t deadline;                   // in us, esp_timer in the heap, wall clock in the store
+    uint32_t action;
+} cmd_sched_entry_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t count;
+    cmd_sched_entry_t heap[CMD_SCHED_SIZE];
+    uint32_t crc;                       // over everything above
+} cmd_sched_store_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static cmd_sched_entry_t cmd_sched_heap[CMD_SCHED_SIZE];
+static uint32_t cmd_sched_count = 0;
+static int64_t cmd_sched_offset = 0;    // in us, the wall clock minus esp_timer at the last seal
+static bool cmd_sched_restore_pending = false;
+static RTC_NOINIT_ATTR cmd_sched_store_t cmd_sched_store;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static int64_t cmd_sched_wall_offset(void);
+static void cmd_sched_restore(void);
+static void cmd_sched_push(int64_t deadline, uint32_t action);
+static void cmd_sched_seal(void);
+static bool cmd_sched_is_valid(void);
+static void cmd_sched_sift_up(uint32_t idx);
+static void cmd_sched_sift_down(uint32_t idx);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+/**
+ * start empty, the actions pending in RTC memory before the reboot are restored
+ * by cmd_sched_poll() once the wall clock is confirmed
+ *
+ * @param timeConfirmed the wall clock is confirmed by SNTP, or kept by the RTC since it was
+ */
+void cmd_sched_init(bool timeConfirmed)
+{
+    cmd_sched_count = 0;
+    cmd_sched_restore_pending = cmd_sched_is_valid() && cmd_sched_store.count > 0;
+
+    if( !cmd_sched_restore_pending ) {
+
+        cmd_sched_seal();
+        return;
+    }
+
+    cmd_sched_poll(timeConfirmed);
+}
+
+
+/**
+ * from the command task, at least once a second
+ * restores the pending actions of the last boot once the wall clock is confirmed,
+ * and reseals them in RTC memory when the wall clock stepped
+ *
+ * @param timeConfirmed the wall clock is confirmed by SNTP, or kept by the RTC since it was
+ */
+void cmd_sched_poll(bool timeConfirmed)
+{
+    if( cmd_sched_restore_pending ) {
+
+        // a restored wall clock may be far behind, the deadlines cannot be converted yet
+        if( timeConfirmed ) {
+            cmd_sched_restore();
+        }
+        return;
+    }
+
+    if( cmd_sched_count > 0 ) {
+
+        int64_t step = cmd_sched_wall_offset() - cmd_sched_offset;
+        if( step > CMD_SCHED_CLOCK_STEP || step < -CMD_SCHED_CLOCK_STEP ) {
+
+            ESP_LOGI(TAG, "wall clock stepped by %lld ms, resealed", (long long) (step / 1000));
+            cmd_sched_seal();
+        }
+    }
+}
+
+
+/**
+ * schedule an action to be performed after the delay
+ *
+ * @return false if the scheduler is full or the delay is too long
+ */
+bool cmd_sched_add(cmd_action_code_t action, uint32_t delayMs)
+{
+    if( cmd_sched_count >= CMD_SCHED_SIZE || delayMs > CMD_SCHED_MAX_DELAY * 1000 ) {
+
+        ESP_LOGE(TAG, "unable to schedule action %d", action);
+        return(false);
+    }
+
+    cmd_sched_push(esp_timer_get_time() + (int64_t) delayMs * 1000, action);
+    cmd_sched_seal();
+
+    return(true);
+}
+
+
+/**
+ * drop all pending actions, including the ones not restored yet
+ */
+void cmd_sched_cancel(void)
+{
+    if( cmd_sched_count > 0 || cmd_sched_restore_pending ) {
+
+        ESP_LOGI(TAG, "%d delayed actions cancelled", cmd_sched_count +
+                                                      (cmd_sched_restore_pending ? cmd_sched_store.count : 0));
+
+        cmd_sched_count = 0;
+        cmd_sched_restore_pending = false;
+        cmd_sched_seal();
+    }
+}
+
+
+/**
+ * @return us until the earliest deadline, 0 if already due, -1 if nothing is pending
+ */
+int64_t cmd_sched_next_wait(void)
+{
+    if( cmd_sched_count == 0 ) {
+        return(-1);
+    }
+
+    int64_t wait = cmd_sched_heap[0].deadline - esp_timer_get_time();
+
+    return(wait > 0 ? wait : 0);
+}
+
+
+/**
+ * remove the earliest action if its deadline has passed
+ *
+ * @return the action, CMD_ACTION_NONE if nothing is due
+ */
+cmd_action_code_t cmd_sched_pop_due(void)
+{
+    if( cmd_sched_count == 0 || cmd_sched_heap[0].deadline > esp_timer_get_time() ) {
+        return(CMD_ACTION_NONE);
+    }
+
+    cmd_action_code_t action = cmd_sched_heap[0].action;
+
+    cmd_sched_count--;
+    if( cmd_sched_count > 0 ) {
+        cmd_sched_heap[0] = cmd_sched_heap[cmd_sched_count];
+        cmd_sched_sift_down(0);
+    }
+    cmd_sched_seal();
+
+    return(action);
+}
+
+
+uint8_t cmd_sched_pending(void)
+{
+    return((uint8_t) cmd_sched_count);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+static int64_t cmd_sched_wall_offset(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return((int64_t) tv.tv_sec * 1000000 + tv.tv_usec - esp_timer_get_time());
+}
+
+
+/**
+ * convert the sealed deadlines back to esp_timer
+ * actions too far in the future or too late are dropped, actions added
+ * since the boot are kept
+ */
+static void cmd_sched_restore(void)
+{
+    int64_t offset = cmd_sched_wall_offset();
+    int64_t now = esp_timer_get_time();
+    int64_t earliest = now - (int64_t) CMD_SCHED_RESTORE_GRACE * 1000000;
+    int64_t latest = now + (int64_t) CMD_SCHED_MAX_DELAY * 1000000;
+    uint32_t kept = 0;
+
+    for( uint32_t eIdx = 0; eIdx < cmd_sched_store.count; eIdx++ ) {
+
+        const cmd_sched_entry_t *entry = &cmd_sched_store.heap[eIdx];
+        int64_t deadline = entry->deadline - offset;
+
+        if( deadline < earliest || deadline > latest || cmd_sched_count >= CMD_SCHED_SIZE ) {
+
+            ESP_LOGI(TAG, "restored action %d dropped, deadline out of range or no room", entry->action);
+            continue;
+        }
+
+        cmd_sched_push(deadline, entry->action);
+        kept++;
+    }
+
+    cmd_sched_restore_pending = false;
+    cmd_sched_seal();
+
+    ESP_LOGI(TAG, "%d delayed actions restored", kept);
+}
+
+
+static void cmd_sched_push(int64_t deadline, uint32_t action)
+{
+    uint32_t idx = cmd_sched_count++;
+
+    cmd_sched_heap[idx].deadline = deadline;
+    cmd_sched_heap[idx].action = action;
+    cmd_sched_sift_up(idx);
+}
+
+
+/**
+ * copy the heap to RTC memory with the deadlines on the wall clock
+ * the store of the last boot is left alone until it is restored
+ */
+static void cmd_sched_seal(void)
+{
+    if( cmd_sched_restore_pending ) {
+        return;
+    }
+
+    cmd_sched_offset = cmd_sched_wall_offset();
+
+    cmd_sched_store.magic = CMD_SCHED_MAGIC;
+    cmd_sched_store.count = cmd_sched_count;
+    for( uint32_t eIdx = 0; eIdx < cmd_sched_count; eIdx++ ) {
+
+        cmd_sched_store.heap[eIdx].deadline = cmd_sched_heap[eIdx].deadline + cmd_sched_offset;
+        cmd_sched_store.heap[eIdx].action = cmd_sched_heap[eIdx].action;
+    }
+
+    cmd_sched_store.crc = crc32_le(0, (const uint8_t *) &cmd_sched_store, offsetof(cmd_sched_store_t, crc));
+}
+
+
+static bool cmd_sched_is_valid(void)
+{
+    return(cmd_sched_store.magic == CMD_SCHED_MAGIC &&
+           cmd_sched_store.count <= CMD_SCHED_SIZE &&
+           cmd_sched_store.crc == crc32_le(0, (const uint8_t *) &cmd_sched_store, offsetof(cmd_sched_store_t, crc)));
+}
+
+
+static void cmd_sched_sift_up(uint32_t idx)
+{
+    cmd_sched_entry_t *heap = cmd_sched_heap;
+
+    while( idx > 0 ) {
+
+        uint32_t parent = (idx - 1) / 2;
+        if( heap[parent].deadline <= heap[idx].deadline ) {
+            break;
+        }
+
+        cmd_sched_entry_t temp = heap[parent];
+        heap[parent] = heap[idx];
+        heap[idx] = temp;
+        idx = parent;
+    }
+}
+
+
+static void cmd_sched_sift_down(uint32_t idx)
+{
+    cmd_sched_entry_t *heap = cmd_sched_heap;
+    uint32_t count = cmd_sched_count;
+
+    while( true ) {
+
+        uint32_t smallest = idx;
+        uint32_t left = idx * 2 + 1;
+        uint32_t right = left + 1;
+
+        if( left < count && heap[left].deadline < heap[smallest].deadline ) {
+            smallest = left;
+        }
+        if( right < count && heap[right].deadline < heap[smallest].deadline ) {
+            smallest = right;
+        }
+        if( smallest == idx ) {
+            break;
+        }
+
+        cmd_sched_entry_t temp = heap[smallest];
+        heap[smallest] = heap[idx];
+        heap[idx] = temp;
+        idx = smallest;
+    }
+}
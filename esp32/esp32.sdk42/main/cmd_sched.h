@@ -0,0 +1,33 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _CMD_SCHED_H_
+#define _CMD_SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmd.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define CMD_SCHED_SIZE                      16      // pending delayed actions
+#define CMD_SCHED_MAX_DELAY                 3600    // in seconds, longest accepted delay
+#define CMD_SCHED_RESTORE_GRACE             300     // in seconds, how late a restored action may still run
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void cmd_sched_init(bool timeConfirmed);
+void cmd_sched_poll(bool timeConfirmed);
+bool cmd_sched_add(cmd_action_code_t action, uint32_t delayMs);
+void cmd_sched_cancel(void);
+int64_t cmd_sched_next_wait(void);
+cmd_action_code_t cmd_sched_pop_due(void);
+uint8_t cmd_sched_pending(void);
+
+#endif
@@ -6,3 +6,9 @@
 # embed files from the "certs" directory as binary data symbols
 # in the app
 COMPONENT_EMBED_TXTFILES := certs/aws-root-ca.pem certs/my-tls-certificate.pem.crt certs/my-tls-private.pem.key
+
+# tls_session.c sets and saves the TLS session around the handshake of esp-tls
+COMPONENT_ADD_LDFLAGS += -Wl,--wrap=mbedtls_ssl_handshake
+
+# mqtt_ping.c times the MQTT PINGREQ and PINGRESP on the transport of esp-mqtt
+COMPONENT_ADD_LDFLAGS += -Wl,--wrap=esp_transport_write -Wl,--wrap=esp_transport_read
@@ -0,0 +1,242 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "json_writer.h"
+
+// Note: every write appends at writer->len, nothing is rescanned and nothing is allocated
+//       when a write does not fit, the writer stops and json_writer_finish() returns 0,
+//       so a report is either complete or not sent
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static void json_writer_put(json_writer_t *writer, const char *data, size_t len);
+static void json_writer_put_char(json_writer_t *writer, char c);
+static void json_writer_put_escaped(json_writer_t *writer, const char *str);
+static void json_writer_key(json_writer_t *writer, const char *key);
+static void json_writer_begin(json_writer_t *writer, const char *key, char opening, char closing);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+void json_writer_init(json_writer_t *writer, char *buf, size_t size)
+{
+    writer->buf = buf;
+    writer->size = size;
+    writer->len = 0;
+    writer->depth = 0;
+    writer->comma = false;
+    writer->overflow = size == 0;
+
+    if( size > 0 ) {
+        buf[0] = 0x00;
+    }
+}
+
+
+void json_writer_begin_object(json_writer_t *writer, const char *key)
+{
+    json_writer_begin(writer, key, '{', '}');
+}
+
+
+void json_writer_begin_array(json_writer_t *writer, const char *key)
+{
+    json_writer_begin(writer, key, '[', ']');
+}
+
+
+void json_writer_end(json_writer_t *writer)
+{
+    if( writer->depth > 0 ) {
+        writer->depth--;
+        json_writer_put_char(writer, writer->closing[writer->depth]);
+        writer->comma = true;
+    }
+}
+
+
+void json_writer_string(json_writer_t *writer, const char *key, const char *value)
+{
+    json_writer_key(writer, key);
+    json_writer_put_char(writer, '"');
+    json_writer_put_escaped(writer, value);
+    json_writer_put_char(writer, '"');
+    writer->comma = true;
+}
+
+
+void json_writer_int(json_writer_t *writer, const char *key, int64_t value)
+{
+    char digits[20];
+    uint8_t digitPos = sizeof(digits);
+
+    // unsigned, so INT64_MIN is negated correctly
+    uint64_t magnitude = value < 0 ? (uint64_t) 0 - (uint64_t) value : (uint64_t) value;
+
+    do {
+        digits[--digitPos] = '0' + (magnitude % 10);
+        magnitude /= 10;
+    } while( magnitude > 0 );
+
+    json_writer_key(writer, key);
+    if( value < 0 ) {
+        json_writer_put_char(writer, '-');
+    }
+    json_writer_put(writer, digits + digitPos, sizeof(digits) - digitPos);
+    writer->comma = true;
+}
+
+
+void json_writer_bool(json_writer_t *writer, const char *key, bool value)
+{
+    json_writer_key(writer, key);
+    if( value ) {
+        json_writer_put(writer, "true", 4);
+    } else {
+        json_writer_put(writer, "false", 5);
+    }
+    writer->comma = true;
+}
+
+
+/**
+ * bytes left before the null terminator, for callers which cut a long list short
+ */
+size_t json_writer_room(const json_writer_t *writer)
+{
+    if( writer->overflow ) {
+        return(0);
+    }
+
+    return(writer->size - writer->len - 1);
+}
+
+
+/**
+ * close whatever is still open and terminate the string
+ * returns the JSON length, 0 if it did not fit, the partial JSON is still null terminated
+ */
+size_t json_writer_finish(json_writer_t *writer)
+{
+    while( writer->depth > 0 ) {
+        json_writer_end(writer);
+    }
+
+    if( writer->size > 0 ) {
+        writer->buf[writer->len] = 0x00;
+    }
+
+    if( writer->overflow ) {
+        return(0);
+    }
+
+    return(writer->len);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+static void json_writer_put(json_writer_t *writer, const char *data, size_t len)
+{
+    if( writer->overflow ) {
+        return;
+    }
+
+    // one byte is always kept for the null terminator
+    if( len >= writer->size - writer->len ) {
+        writer->overflow = true;
+        return;
+    }
+
+    memcpy(writer->buf + writer->len, data, len);
+    writer->len += len;
+}
+
+
+static void json_writer_put_char(json_writer_t *writer, char c)
+{
+    json_writer_put(writer, &c, 1);
+}
+
+
+/**
+ * plain runs are copied at once, quotes, backslashes and control characters are escaped
+ */
+static void json_writer_put_escaped(json_writer_t *writer, const char *str)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    const char *run = str;
+
+    for( const char *pos = str; *pos != 0x00; pos++ ) {
+
+        uint8_t c = (uint8_t) *pos;
+        if( c >= 0x20 && c != '"' && c != '\\' ) {
+            continue;
+        }
+
+        json_writer_put(writer, run, pos - run);
+        run = pos + 1;
+
+        char escaped[6] = { '\\', (char) c };
+        size_t escapedLen = 2;
+
+        if( c == '\n' ) {
+            escaped[1] = 'n';
+        } else if( c == '\r' ) {
+            escaped[1] = 'r';
+        } else if( c == '\t' ) {
+            escaped[1] = 't';
+        } else if( c < 0x20 ) {
+            escaped[1] = 'u';
+            escaped[2] = '0';
+            escaped[3] = '0';
+            escaped[4] = hexDigits[c >> 4];
+            escaped[5] = hexDigits[c & 0x0f];
+            escapedLen = 6;
+        }
+
+        json_writer_put(writer, escaped, escapedLen);
+    }
+
+    json_writer_put(writer, run, strlen(run));
+}
+
+
+static void json_writer_key(json_writer_t *writer, const char *key)
+{
+    if( writer->comma ) {
+        json_writer_put_char(writer, ',');
+    }
+
+    if( key != NULL ) {
+        json_writer_put_char(writer, '"');
+        json_writer_put_escaped(writer, key);
+        json_writer_put(writer, "\":", 2);
+    }
+}
+
+
+static void json_writer_begin(json_writer_t *writer, const char *key, char opening, char closing)
+{
+    if( writer->depth >= JSON_WRITER_MAX_DEPTH ) {
+        writer->overflow = true;
+        return;
+    }
+
+    json_writer_key(writer, key);
+    json_writer_put_char(writer, opening);
+
+    writer->closing[writer->depth++] = closing;
+    writer->comma = false;
+}
@@ -0,0 +1,46 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _JSON_WRITER_H_
+#define _JSON_WRITER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define JSON_WRITER_MAX_DEPTH               8
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+// append-only JSON over a caller buffer, the key is NULL for array elements
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    uint8_t depth;
+    bool comma;                         // a value was written at this depth
+    bool overflow;                      // nothing more is written once set
+    char closing[JSON_WRITER_MAX_DEPTH];
+} json_writer_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void json_writer_init(json_writer_t *writer, char *buf, size_t size);
+void json_writer_begin_object(json_writer_t *writer, const char *key);
+void json_writer_begin_array(json_writer_t *writer, const char *key);
+void json_writer_end(json_writer_t *writer);
+void json_writer_string(json_writer_t *writer, const char *key, const char *value);
+void json_writer_int(json_writer_t *writer, const char *key, int64_t value);
+void json_writer_bool(json_writer_t *writer, const char *key, bool value);
+size_t json_writer_room(const json_writer_t *writer);
+size_t json_writer_finish(json_writer_t *writer);
+
+#endif
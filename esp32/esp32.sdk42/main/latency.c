@@ -0,0 +1,187 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "latency.h"
+
+// Note: log-scale histograms of the command path, one per stage
+//       buckets 0..3 are 0..3 us exactly, then each power of two is split in
+//       LATENCY_SUB_BUCKETS, so a percentile is off by at most a quarter octave
+//
+//       recorded from the cmd task and the esp_timer task, read from the MQTT task
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static portMUX_TYPE latency_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t latency_counts[LATENCY_STAGE_COUNT][LATENCY_BUCKETS];
+static uint32_t latency_total[LATENCY_STAGE_COUNT];
+static uint32_t latency_max[LATENCY_STAGE_COUNT];
+
+static const char *latency_stage_names[LATENCY_STAGE_COUNT] = {
+    "parse", "enqueue", "queue", "verify", "actuate", "total"
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static uint32_t latency_bucket_of(int64_t us);
+static uint32_t latency_percentile(const uint32_t *counts, uint32_t total, uint32_t permille);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+void latency_init(void)
+{
+    portENTER_CRITICAL(&latency_mux);
+    memset(latency_counts, 0, sizeof(latency_counts));
+    memset(latency_total, 0, sizeof(latency_total));
+    memset(latency_max, 0, sizeof(latency_max));
+    portEXIT_CRITICAL(&latency_mux);
+}
+
+
+/**
+ * record every stage of one command at its relay rising edge
+ * commands which did not come from MQTT, like the delayed ones, are skipped
+ */
+void latency_record_command(const latency_stamps_t *stamps, int64_t actuated)
+{
+    if( stamps->arrival == 0 ) {
+        return;
+    }
+
+    const int64_t stageTimes[LATENCY_STAGE_COUNT] = {
+        [LATENCY_STAGE_PARSE] = stamps->parsed - stamps->arrival,
+        [LATENCY_STAGE_ENQUEUE] = stamps->queued - stamps->parsed,
+        [LATENCY_STAGE_QUEUE] = stamps->dequeued - stamps->queued,
+        [LATENCY_STAGE_VERIFY] = stamps->verified - stamps->dequeued,
+        [LATENCY_STAGE_ACTUATE] = actuated - stamps->verified,
+        [LATENCY_STAGE_TOTAL] = actuated - stamps->arrival,
+    };
+
+    portENTER_CRITICAL(&latency_mux);
+    for( uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++ ) {
+
+        int64_t us = stageTimes[stage] > 0 ? stageTimes[stage] : 0;
+
+        latency_counts[stage][latency_bucket_of(us)]++;
+        latency_total[stage]++;
+        if( us > latency_max[stage] ) {
+            latency_max[stage] = us > UINT32_MAX ? UINT32_MAX : (uint32_t) us;
+        }
+    }
+    portEXIT_CRITICAL(&latency_mux);
+}
+
+
+void latency_get_summary(latency_stage_t stage, latency_summary_t *summary)
+{
+    // a few hundred additions, short enough for a critical section
+    portENTER_CRITICAL(&latency_mux);
+    summary->count = latency_total[stage];
+    summary->p50 = latency_percentile(latency_counts[stage], summary->count, 500);
+    summary->p95 = latency_percentile(latency_counts[stage], summary->count, 950);
+    summary->p99 = latency_percentile(latency_counts[stage], summary->count, 990);
+    summary->max = latency_max[stage];
+    portEXIT_CRITICAL(&latency_mux);
+
+    // the bucket bound may be past the largest sample
+    summary->p50 = summary->p50 < summary->max ? summary->p50 : summary->max;
+    summary->p95 = summary->p95 < summary->max ? summary->p95 : summary->max;
+    summary->p99 = summary->p99 < summary->max ? summary->p99 : summary->max;
+}
+
+
+/**
+ * copy the histogram of a stage
+ *
+ * @param counts LATENCY_BUCKETS entries
+ *
+ * @return number of samples
+ */
+uint32_t latency_get_buckets(latency_stage_t stage, uint32_t *counts)
+{
+    portENTER_CRITICAL(&latency_mux);
+    memcpy(counts, latency_counts[stage], sizeof(latency_counts[stage]));
+    uint32_t total = latency_total[stage];
+    portEXIT_CRITICAL(&latency_mux);
+
+    return(total);
+}
+
+
+/**
+ * @return the largest value in us counted in the bucket
+ */
+uint32_t latency_bucket_upper(uint32_t bucket)
+{
+    if( bucket < LATENCY_SUB_BUCKETS ) {
+        return(bucket);
+    }
+
+    uint32_t msb = bucket / LATENCY_SUB_BUCKETS + 1;
+    uint32_t sub = bucket % LATENCY_SUB_BUCKETS;
+    uint32_t width = 1u << (msb - 2);
+
+    return((LATENCY_SUB_BUCKETS + sub) * width + width - 1);
+}
+
+
+const char *latency_stage_name(latency_stage_t stage)
+{
+    return(stage < LATENCY_STAGE_COUNT ? latency_stage_names[stage] : "");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+static uint32_t latency_bucket_of(int64_t us)
+{
+    if( us >= (1LL << LATENCY_MAX_BITS) ) {
+        return(LATENCY_BUCKETS - 1);
+    }
+
+    uint32_t value = (uint32_t) us;
+    if( value < LATENCY_SUB_BUCKETS ) {
+        return(value);
+    }
+
+    uint32_t msb = 31 - __builtin_clz(value);
+
+    return((msb - 1) * LATENCY_SUB_BUCKETS + ((value >> (msb - 2)) & (LATENCY_SUB_BUCKETS - 1)));
+}
+
+
+/**
+ * @return the upper bound of the bucket holding the sample at permille, 0 if empty
+ */
+static uint32_t latency_percentile(const uint32_t *counts, uint32_t total, uint32_t permille)
+{
+    if( total == 0 ) {
+        return(0);
+    }
+
+    // the rank of the sample, 1-based, rounded up
+    uint64_t rank = ((uint64_t) total * permille + 999) / 1000;
+    uint64_t seen = 0;
+
+    for( uint32_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++ ) {
+
+        seen += counts[bucket];
+        if( seen >= rank ) {
+            return(latency_bucket_upper(bucket));
+        }
+    }
+
+    return(latency_bucket_upper(LATENCY_BUCKETS - 1));
+}
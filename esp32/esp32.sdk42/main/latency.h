@@ -0,0 +1,60 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define LATENCY_SUB_BUCKETS                 4       // per power of two, the bucket math assumes 4
+#define LATENCY_MAX_BITS                    26      // up to 67 s, longer is counted in the last bucket
+#define LATENCY_BUCKETS                     ((LATENCY_MAX_BITS - 1) * LATENCY_SUB_BUCKETS)
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef enum {
+    LATENCY_STAGE_PARSE = 0,            // MQTT_EVENT_DATA to parsed
+    LATENCY_STAGE_ENQUEUE,              // parsed to cmd_add()
+    LATENCY_STAGE_QUEUE,                // cmd_add() to dequeued by cmd_loop()
+    LATENCY_STAGE_VERIFY,               // dequeued to OTP verified
+    LATENCY_STAGE_ACTUATE,              // verified to the relay rising edge
+    LATENCY_STAGE_TOTAL,                // MQTT_EVENT_DATA to the relay rising edge
+    LATENCY_STAGE_COUNT
+} latency_stage_t;
+
+// esp_timer_get_time() at each stage of a command, arrival is 0 if not from MQTT
+typedef struct {
+    int64_t arrival;
+    int64_t parsed;
+    int64_t queued;
+    int64_t dequeued;
+    int64_t verified;
+} latency_stamps_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t p50;                       // in us, upper bound of the bucket
+    uint32_t p95;
+    uint32_t p99;
+    uint32_t max;                       // in us, exact
+} latency_summary_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void latency_init(void);
+void latency_record_command(const latency_stamps_t *stamps, int64_t actuated);
+void latency_get_summary(latency_stage_t stage, latency_summary_t *summary);
+uint32_t latency_get_buckets(latency_stage_t stage, uint32_t *counts);
+uint32_t latency_bucket_upper(uint32_t bucket);
+const char *latency_stage_name(latency_stage_t stage);
+
+#endif
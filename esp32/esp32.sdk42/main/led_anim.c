@@ -0,0 +1,284 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/ledc.h"
+
+#include "open_tls.h"
+#include "led_anim.h"
+
+static const char *TAG = "LED_ANIM";
+
+// Note: the LED patterns run in the esp_timer task, one timer expiry per step.
+//       each step starts a LEDC fade without waiting, and the timer expires when
+//       the fade and the hold after it are over. nothing else waits for the LED.
+//       IDF 4.2 has no LEDC fade-end callback, the step times are kept by the timer
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+
+// LED-PWM config
+#define LED_ANIM_IO                         OPEN_TLS_HW_LED1
+#define LED_ANIM_INTR_FLAG_LEDC             1
+#define LED_ANIM_LEDC_SPEED_MODE            LEDC_LOW_SPEED_MODE
+#define LED_ANIM_LEDC_CHANNEL               LEDC_CHANNEL_0
+#define LED_ANIM_DARK_DUTY                  0
+#define LED_ANIM_LIGHT_DUTY                 4000    // scale of 13-bit brightness (8192)
+#define LED_ANIM_DARK_FADE_TIME             2000    // in ms
+#define LED_ANIM_LIGHT_FADE_TIME            1000    // in ms
+
+#define LED_ANIM_STEP_TIME                  250     // in ms, the blinking period and the breathing wait unit
+#define LED_ANIM_INTERVAL_LONG              20      // in 250ms count
+#define LED_ANIM_INTERVAL_MEDIUM            10      // in 250ms count
+#define LED_ANIM_INTERVAL_SHORT             1       // in 250ms count
+
+// the LED stays dark this long after the dark fade, one step more than the interval
+#define LED_ANIM_DARK_HOLD(interval)        (((interval) + 1) * LED_ANIM_STEP_TIME)
+
+#define LED_ANIM_NO_REQUEST                 LED_ANIM_COUNT
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct {
+    uint32_t duty;
+    uint32_t fadeTime;                  // in ms, 0 sets the duty at once
+    uint32_t holdTime;                  // in ms, after the fade
+} led_anim_step_t;
+
+typedef struct {
+    const led_anim_step_t *steps;
+    uint8_t stepCount;
+    uint8_t group;                      // within a group, the steps line up and a switch keeps the current step
+    uint8_t priority;                   // within a group, a lower priority does not replace a higher one
+    led_anim_pattern_t next;            // played after the last step
+} led_anim_pattern_def_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static const led_anim_step_t led_anim_blink_steps[] = {
+    { LED_ANIM_LIGHT_DUTY,  0,                          LED_ANIM_STEP_TIME },
+    { LED_ANIM_DARK_DUTY,   0,                          LED_ANIM_STEP_TIME },
+};
+
+static const led_anim_step_t led_anim_breathe_steps[] = {
+    { LED_ANIM_LIGHT_DUTY,  LED_ANIM_LIGHT_FADE_TIME,   LED_ANIM_STEP_TIME },
+    { LED_ANIM_DARK_DUTY,   LED_ANIM_DARK_FADE_TIME,    LED_ANIM_DARK_HOLD(LED_ANIM_INTERVAL_LONG) },
+};
+
+static const led_anim_step_t led_anim_breathe_medium_steps[] = {
+    { LED_ANIM_LIGHT_DUTY,  LED_ANIM_LIGHT_FADE_TIME,   LED_ANIM_STEP_TIME },
+    { LED_ANIM_DARK_DUTY,   LED_ANIM_DARK_FADE_TIME,    LED_ANIM_DARK_HOLD(LED_ANIM_INTERVAL_MEDIUM) },
+};
+
+static const led_anim_step_t led_anim_breathe_short_steps[] = {
+    { LED_ANIM_LIGHT_DUTY,  LED_ANIM_LIGHT_FADE_TIME,   LED_ANIM_STEP_TIME },
+    { LED_ANIM_DARK_DUTY,   LED_ANIM_DARK_FADE_TIME,    LED_ANIM_DARK_HOLD(LED_ANIM_INTERVAL_SHORT) },
+};
+
+#define LED_ANIM_STEPS(steps)               steps, sizeof(steps) / sizeof(steps[0])
+
+static const led_anim_pattern_def_t led_anim_patterns[LED_ANIM_COUNT] = {
+    [LED_ANIM_BLINK]            = { LED_ANIM_STEPS(led_anim_blink_steps),           0, 0, LED_ANIM_BLINK },
+    [LED_ANIM_BREATHE]          = { LED_ANIM_STEPS(led_anim_breathe_steps),         1, 0, LED_ANIM_BREATHE },
+    [LED_ANIM_BREATHE_MEDIUM]   = { LED_ANIM_STEPS(led_anim_breathe_medium_steps),  1, 1, LED_ANIM_BREATHE },
+    [LED_ANIM_BREATHE_SHORT]    = { LED_ANIM_STEPS(led_anim_breathe_short_steps),   1, 2, LED_ANIM_BREATHE },
+};
+
+static esp_timer_handle_t led_anim_timer = NULL;
+static portMUX_TYPE led_anim_mux = portMUX_INITIALIZER_UNLOCKED;
+static led_anim_pattern_t led_anim_request = LED_ANIM_NO_REQUEST;   // taken by the next timer expiry
+
+// owned by the timer callback
+static led_anim_pattern_t led_anim_pattern = LED_ANIM_BLINK;
+static int8_t led_anim_step = -1;                                   // -1 before the first step
+static int64_t led_anim_step_start = 0;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local functions
+static void led_anim_timer_callback(void *arg);
+static void led_anim_wake(void);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+/**
+ * set up the LED PWM, then start with the blinking
+ */
+void led_anim_init(void)
+{
+    ledc_timer_config_t ledc_timer = {
+        .duty_resolution = LEDC_TIMER_13_BIT,   // resolution of PWM duty
+        .freq_hz = 5000,                        // frequency of PWM signal
+        .speed_mode = LED_ANIM_LEDC_SPEED_MODE, // timer mode
+        .timer_num = LEDC_TIMER_0               // timer index
+    };
+
+    // set configuration of timer0 for high speed channels
+    ledc_timer_config(&ledc_timer);
+
+    ledc_channel_config_t ledc_channel = {
+        .channel    = LED_ANIM_LEDC_CHANNEL,
+        .duty       = 0,
+        .gpio_num   = LED_ANIM_IO,
+        .speed_mode = LED_ANIM_LEDC_SPEED_MODE,
+        .timer_sel  = LEDC_TIMER_0
+    };
+    // set configuration of timer0 for high speed channels
+    ledc_channel_config(&ledc_channel);
+
+    // initialize fade service.
+    ledc_fade_func_install(LED_ANIM_INTR_FLAG_LEDC);
+
+    const esp_timer_create_args_t timerArgs = {
+        .callback = led_anim_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "led_anim"
+    };
+
+    if( esp_timer_create(&timerArgs, &led_anim_timer) != ESP_OK ) {
+
+        ESP_LOGE(TAG, "unable to create LED timer");
+        return;
+    }
+
+    // everything starts from an error blinking
+    led_anim_pattern = LED_ANIM_BLINK;
+    led_anim_step = -1;
+    led_anim_play(LED_ANIM_BLINK);
+}
+
+
+/**
+ * switch to another pattern, without waiting for it
+ * within the breathing patterns, the current breath goes on and only the wait after it changes
+ */
+void led_anim_play(led_anim_pattern_t pattern)
+{
+    if( led_anim_timer == NULL || pattern >= LED_ANIM_COUNT ) {
+        return;
+    }
+
+    portENTER_CRITICAL(&led_anim_mux);
+
+    // a short breathing request is not overwritten by a medium one before it is taken
+    if( led_anim_request == LED_ANIM_NO_REQUEST ||
+        led_anim_patterns[pattern].group != led_anim_patterns[led_anim_request].group ||
+        led_anim_patterns[pattern].priority >= led_anim_patterns[led_anim_request].priority ) {
+
+        led_anim_request = pattern;
+    }
+
+    portEXIT_CRITICAL(&led_anim_mux);
+
+    led_anim_wake();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+/**
+ * take the requested pattern, start the next step when the current one is over,
+ * then sleep until the end of the step
+ */
+static void led_anim_timer_callback(void *arg)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&led_anim_mux);
+    led_anim_pattern_t request = led_anim_request;
+    led_anim_request = LED_ANIM_NO_REQUEST;
+    portEXIT_CRITICAL(&led_anim_mux);
+
+    const led_anim_pattern_def_t *current = &led_anim_patterns[led_anim_pattern];
+    int64_t fadeEnd = led_anim_step_start;
+    if( led_anim_step >= 0 ) {
+        fadeEnd += (int64_t) current->steps[led_anim_step].fadeTime * 1000;
+    }
+
+    if( request != LED_ANIM_NO_REQUEST ) {
+
+        const led_anim_pattern_def_t *requested = &led_anim_patterns[request];
+
+        if( requested->group != current->group ) {
+
+            if( now < fadeEnd ) {
+                // a new fade waits in the LEDC driver for the running one, not in the timer task
+                portENTER_CRITICAL(&led_anim_mux);
+                if( led_anim_request == LED_ANIM_NO_REQUEST ) {
+                    led_anim_request = request;
+                }
+                portEXIT_CRITICAL(&led_anim_mux);
+
+                esp_timer_start_once(led_anim_timer, fadeEnd - now);
+                return;
+            }
+
+            // start over with the first step
+            led_anim_pattern = request;
+            led_anim_step = -1;
+
+        } else if( requested->priority >= current->priority ) {
+
+            // the same step goes on, only its length changes
+            led_anim_pattern = request;
+        }
+    }
+
+    const led_anim_pattern_def_t *pattern = &led_anim_patterns[led_anim_pattern];
+    int64_t stepEnd = led_anim_step_start;
+    if( led_anim_step >= 0 ) {
+        stepEnd += (int64_t) (pattern->steps[led_anim_step].fadeTime + pattern->steps[led_anim_step].holdTime) * 1000;
+    }
+
+    if( led_anim_step < 0 || now >= stepEnd ) {
+
+        // the next step, or the next pattern after the last step
+        led_anim_step++;
+        if( led_anim_step >= pattern->stepCount ) {
+            led_anim_pattern = pattern->next;
+            pattern = &led_anim_patterns[led_anim_pattern];
+            led_anim_step = 0;
+        }
+
+        const led_anim_step_t *step = &pattern->steps[led_anim_step];
+
+        // 0 ms still fades for 1 ms to avoid SDK warning log
+        ledc_set_fade_time_and_start(LED_ANIM_LEDC_SPEED_MODE,
+                                     LED_ANIM_LEDC_CHANNEL,
+                                     step->duty,
+                                     step->fadeTime > 0 ? step->fadeTime : 1,
+                                     LEDC_FADE_NO_WAIT);
+
+        led_anim_step_start = now;
+        stepEnd = now + (int64_t) (step->fadeTime + step->holdTime) * 1000;
+    }
+
+    // a request in the meantime restarts the timer at once
+    esp_timer_start_once(led_anim_timer, stepEnd - now);
+}
+
+
+/**
+ * expire the timer at once, so the callback takes the request
+ */
+static void led_anim_wake(void)
+{
+    // not running is fine
+    esp_timer_stop(led_anim_timer);
+    esp_timer_start_once(led_anim_timer, 0);
+}
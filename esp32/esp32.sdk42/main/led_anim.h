@@ -0,0 +1,30 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _LED_ANIM_H_
+#define _LED_ANIM_H_
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef enum {
+    LED_ANIM_BLINK = 0,                 // 250ms blinking
+    LED_ANIM_BREATHE,                   // breathing with the long interval
+    LED_ANIM_BREATHE_MEDIUM,            // the next interval is medium, then long again
+    LED_ANIM_BREATHE_SHORT,             // the next interval is short (network activity), then long again
+    LED_ANIM_COUNT
+} led_anim_pattern_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void led_anim_init(void);
+void led_anim_play(led_anim_pattern_t pattern);
+
+#endif
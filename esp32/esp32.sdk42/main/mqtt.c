@@ -14,13 +14,14 @@
 #include <time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_task_wdt.h"
 #include "mbedtls/base64.h"
 #include "esp32/rom/crc.h"
 #include "mqtt_client.h"
-#include "cJSON.h"
 
 #include "app_wifi.h"
 #include "open_tls.h"
@@ -28,6 +29,19 @@
 #include "util.h"
 #include "version.h"
 #include "cmd.h"
+#include "cmd_parser.h"
+#include "relay.h"
+#include "rate_limit.h"
+#include "latency.h"
+#include "json_writer.h"
+#include "mqtt_reasm.h"
+#include "mqtt_router.h"
+#include "tls_session.h"
+#include "tls_certs.h"
+#include "boot.h"
+#include "periodical.h"
+#include "sysmon.h"
+#include "netmon.h"
 #include "mqtt.h"
 
 static const char *TAG = "MQTT";
@@ -37,22 +51,72 @@ static const char *TAG = "MQTT";
 #define MQTT_MAX_WAITING_COUNT          600 // in seconds, this is for the first MQTT connection.
                                             // if failed, system will reboot
 #define MQTT_BUF_SIZE                   (2 * 1024)
+#define MQTT_LATENCY_REPORT_RESERVE     48  // one more bucket and the closing of the latency report
 
-extern const uint8_t aws_root_ca_pem_start[] asm("_binary_aws_root_ca_pem_start");
-extern const uint8_t aws_root_ca_pem_end[] asm("_binary_aws_root_ca_pem_end");
-extern const uint8_t certificate_pem_crt_start[] asm("_binary_my_tls_certificate_pem_crt_start");
-extern const uint8_t certificate_pem_crt_end[] asm("_binary_my_tls_certificate_pem_crt_end");
-extern const uint8_t private_key_pem_start[] asm("_binary_my_tls_private_pem_key_start");
-extern const uint8_t private_key_pem_end[] asm("_binary_my_tls_private_pem_key_end");
+// every phone may publish on its own sub-topic, so it gets its own rate limit
+#define MQTT_SENDER_TOPIC_FILTER        OPEN_TLS_MQTT_TOPIC "/+"
+#define MQTT_VERIFIED_MAX_LEN           256 // in bytes, a longer message over the rate limit is not looked at
+#define MQTT_VERIFIED_RECENT            RATE_LIMIT_VERIFIED_BURST   // OTPs let through over the rate limit, kept
+                                                                    // until the command task has them as well
+
+// reports go to <command topic>/status/<TT_ID>, two levels down, so no command filter matches it
+#define MQTT_STATUS_TOPIC_PREFIX        OPEN_TLS_MQTT_TOPIC "/status/"
+
+// the retained online/offline state of the device, the offline one is the will left at the broker
+#define MQTT_PRESENCE_TOPIC_PREFIX      OPEN_TLS_MQTT_TOPIC "/presence/"
+#define MQTT_PRESENCE_BUF_SIZE          192
+
+// the broker publishes the will once nothing is heard for 1.5 keepalive
+#define MQTT_KEEPALIVE                  60  // in seconds
 
 ///////////////////////////////////////////////////////////////////////////////////
 // local variables
 static bool mqtt_currently_connected = false;        // this state is just a 'possible' state
+static SemaphoreHandle_t mqtt_connected_sem = NULL;  // given on every connection, mqtt_init() waits for it
 static esp_mqtt_client_handle_t client = NULL;
+static char mqtt_status_topic[sizeof(MQTT_STATUS_TOPIC_PREFIX) + sizeof(t_device_sn_str)];
+static char mqtt_presence_topic[sizeof(MQTT_PRESENCE_TOPIC_PREFIX) + sizeof(t_device_sn_str)];
+static char mqtt_offline_msg[MQTT_PRESENCE_BUF_SIZE];
+static char mqtt_online_msg[MQTT_PRESENCE_BUF_SIZE];   // built by the MQTT task only
+
+// the reports are built in place, from the periodical task and from the MQTT task
+static char mqtt_report_buf[MQTT_REPORT_BUF_SIZE];
+static SemaphoreHandle_t mqtt_report_lock = NULL;
+static uint32_t mqtt_report_drops = 0;      // device reports which did not fit, under mqtt_report_lock
+
+// fragmented messages are rebuilt here, OPEN_TLS_MQTT_MAX_MSG_SIZE is the longest accepted
+static char mqtt_reasm_buf[OPEN_TLS_MQTT_MAX_MSG_SIZE];
+static mqtt_reasm_t mqtt_reasm;
+static mqtt_router_t mqtt_router;
+static netmon_topic_t mqtt_data_topic = NETMON_TOPIC_OTHER;     // of the inbound message in progress
+static uint8_t mqtt_verified_otps[MQTT_VERIFIED_RECENT][16];    // the MQTT task only
+static uint8_t mqtt_verified_head = 0;
 
 ///////////////////////////////////////////////////////////////////////////////////
 // local functions
-static void mqtt_handle_received_control_message(char *data, uint32_t len);
+static void mqtt_handle_received_message(const mqtt_reasm_msg_t *msg);
+static void mqtt_handle_command(const mqtt_reasm_msg_t *msg);
+static void mqtt_handle_received_control_message(const char *data, uint32_t len, int64_t arrivalTime);
+static void mqtt_handle_received_control_frame(const char *data, uint32_t len, int64_t arrivalTime);
+static void mqtt_publish_online(esp_mqtt_client_handle_t client);
+static const char *mqtt_boot_reason(void);
+static netmon_topic_t mqtt_topic_role(const char *topic, int topicLen);
+static bool mqtt_command_verified(esp_mqtt_event_handle_t event);
+static void mqtt_handle_error(const esp_mqtt_error_codes_t *error);
+
+///////////////////////////////////////////////////////////////////////////////////
+// topic routes
+// the subscribed topic filters and their handlers, the router is built from them at init
+static const struct {
+    const char *filter;
+    mqtt_router_handler_t handler;
+} mqtt_routes[] = {
+    { OPEN_TLS_MQTT_TOPIC,              mqtt_handle_command },
+    { MQTT_SENDER_TOPIC_FILTER,         mqtt_handle_command },
+#ifdef OPEN_TLS_MQTT_GROUP_TOPIC
+    { OPEN_TLS_MQTT_GROUP_TOPIC,        mqtt_handle_command },
+#endif
+};
 
 ///////////////////////////////////////////////////////////////////////////////////
 // MQTT event handler
@@ -61,19 +125,38 @@ static esp_err_t mqtt_event_handler(esp_mqtt_event_handle_t event)
 {
     esp_mqtt_client_handle_t client = event->client;
     int msg_id;
+    int64_t arrivalTime;
 
     switch (event->event_id) {
+        case MQTT_EVENT_BEFORE_CONNECT:
+            netmon_mqtt_before_connect();
+            break;
+
         case MQTT_EVENT_CONNECTED:
             ESP_LOGI(TAG, "MQTT_EVENT_CONNECTED");
 
             mqtt_currently_connected = true;
+            netmon_mqtt_connected();
+            boot_mark(BOOT_PHASE_MQTT);
 
             // normal status
             t_gpio_led_mode(T_GPIO_LED_MODE_CLEAR_ERROR);
 
-            // subscribe the command topic with QOS0
-            msg_id = esp_mqtt_client_subscribe(client, OPEN_TLS_MQTT_TOPIC, 0);
-            ESP_LOGI(TAG, "sent subscribe %s successful, msg_id=%d", OPEN_TLS_MQTT_TOPIC, msg_id);
+            // subscribe every routed topic with QOS0
+            for( uint8_t rIdx = 0; rIdx < sizeof(mqtt_routes) / sizeof(mqtt_routes[0]); rIdx++ ) {
+
+                msg_id = esp_mqtt_client_subscribe(client, mqtt_routes[rIdx].filter, 0);
+                ESP_LOGI(TAG, "sent subscribe %s successful, msg_id=%d", mqtt_routes[rIdx].filter, msg_id);
+            }
+
+            // replaces the retained offline will
+            mqtt_publish_online(client);
+
+            // mqtt_init() returns now, not at its next poll
+            xSemaphoreGive(mqtt_connected_sem);
+
+            // the device report right after the connection
+            periodical_mqtt_connected();
 
             break;
 
@@ -86,6 +169,7 @@ static esp_err_t mqtt_event_handler(esp_mqtt_event_handle_t event)
 
             ESP_LOGI(TAG, "MQTT_EVENT_DISCONNECTED");
             mqtt_currently_connected = false;
+            netmon_mqtt_disconnected();
 
             break;
 
@@ -102,25 +186,38 @@ static esp_err_t mqtt_event_handler(esp_mqtt_event_handle_t event)
             break;
 
         case MQTT_EVENT_DATA:
-            // ignore the device status report
-            // then process the other messages
-            if( strncmp(event->data, "{\"TT_ID\"", 8) ) {
-
-                // process message only sent from the known topic
-                if( !strncmp(event->topic, OPEN_TLS_MQTT_TOPIC, strlen(OPEN_TLS_MQTT_TOPIC)) ) {
+            // the first stage of the command latency
+            arrivalTime = esp_timer_get_time();
 
-                    t_gpio_led2_blink();
-                    mqtt_handle_received_control_message(event->data, event->data_len);
+            // counted before the rate limit, what the broker sent is what the link carried
+            if( event->current_data_offset == 0 ) {
+                mqtt_data_topic = mqtt_topic_role(event->topic, event->topic_len);
+            }
+            netmon_topic_in(mqtt_data_topic, event->data_len, event->current_data_offset == 0);
+
+            // drop floods before any other work, quietly, the counters are in the report
+            // only the first fragment of a message carries the topic
+            // a command with a valid OTP still gets through, on the tokens kept for those
+            if( event->current_data_offset == 0 && !rate_limit_admit(event->topic, event->topic_len) &&
+                !mqtt_command_verified(event) ) {
+                mqtt_reasm_skip(&mqtt_reasm);
+                break;
+            }
 
-                } else {
+            // nothing is parsed until the last fragment is in
+            mqtt_reasm_msg_t msg;
+            if( mqtt_reasm_feed(&mqtt_reasm, event->topic, event->topic_len,
+                                event->data, event->data_len,
+                                event->current_data_offset, event->total_data_len,
+                                arrivalTime, &msg) ) {
 
-                    ESP_LOGI(TAG, "MQTT_EVENT_DATA, (no handler) %s", event->data);
-                }
+                mqtt_handle_received_message(&msg);
             }
             break;
 
         case MQTT_EVENT_ERROR:
             ESP_LOGI(TAG, "MQTT_EVENT_ERROR");
+            mqtt_handle_error(event->error_handle);
             break;
 
         default:
@@ -132,7 +229,7 @@ static esp_err_t mqtt_event_handler(esp_mqtt_event_handle_t event)
 static esp_mqtt_client_config_t mqtt_cfg = {
     .uri = OPEN_TLS_MQTT_BROKER,
     .event_handle = mqtt_event_handler,
-    .keepalive = 120,
+    .keepalive = MQTT_KEEPALIVE,
     .buffer_size = MQTT_BUF_SIZE
 };
 
@@ -146,6 +243,24 @@ void mqtt_init(void)
 {
     // var init
     mqtt_currently_connected = false;
+    mqtt_connected_sem = xSemaphoreCreateBinary();
+    rate_limit_init();
+    netmon_init();
+    mqtt_report_lock = xSemaphoreCreateMutex();
+    snprintf(mqtt_status_topic, sizeof(mqtt_status_topic), "%s%s", MQTT_STATUS_TOPIC_PREFIX, t_device_sn_str);
+    snprintf(mqtt_presence_topic, sizeof(mqtt_presence_topic), "%s%s", MQTT_PRESENCE_TOPIC_PREFIX, t_device_sn_str);
+    mqtt_reasm_init(&mqtt_reasm, mqtt_reasm_buf, sizeof(mqtt_reasm_buf));
+
+    mqtt_router_init(&mqtt_router);
+    for( uint8_t rIdx = 0; rIdx < sizeof(mqtt_routes) / sizeof(mqtt_routes[0]); rIdx++ ) {
+
+        if( !mqtt_router_add(&mqtt_router, mqtt_routes[rIdx].filter, mqtt_routes[rIdx].handler) ) {
+            ESP_LOGE(TAG, "unable to route %s", mqtt_routes[rIdx].filter);
+        }
+    }
+
+    // the TLS session of the previous connection, from RTC memory or NVS
+    tls_session_init();
 
     // set MQTT Broker
     mqtt_cfg.uri = OPEN_TLS_MQTT_BROKER;
@@ -153,11 +268,30 @@ void mqtt_init(void)
     // set default client id
     mqtt_cfg.client_id = t_device_sn_str;
 
-    // set default mqtt settings
-    mqtt_cfg.cert_pem = (const char *)aws_root_ca_pem_start;
-    mqtt_cfg.client_cert_pem = (const char *)certificate_pem_crt_start;
-    mqtt_cfg.client_key_pem = (const char *)private_key_pem_start;
-    mqtt_cfg.cert_pem = (const char *)aws_root_ca_pem_start;
+    // set the certificates, DER from the certs partition or the embedded PEM
+    const tls_certs_t *certs = tls_certs_init();
+    if( certs->globalCaStore ) {
+        mqtt_cfg.use_global_ca_store = true;
+    } else {
+        mqtt_cfg.cert_pem = certs->data[TLS_CERTS_ROOT_CA];
+        mqtt_cfg.cert_len = certs->len[TLS_CERTS_ROOT_CA];
+    }
+    mqtt_cfg.client_cert_pem = certs->data[TLS_CERTS_CLIENT_CERT];
+    mqtt_cfg.client_cert_len = certs->len[TLS_CERTS_CLIENT_CERT];
+    mqtt_cfg.client_key_pem = certs->data[TLS_CERTS_CLIENT_KEY];
+    mqtt_cfg.client_key_len = certs->len[TLS_CERTS_CLIENT_KEY];
+
+    // the will, published and retained by the broker when the device is lost
+    json_writer_t writer;
+    json_writer_init(&writer, mqtt_offline_msg, sizeof(mqtt_offline_msg));
+    json_writer_begin_object(&writer, NULL);
+    json_writer_string(&writer, "TT_ID", t_device_sn_str);
+    json_writer_string(&writer, "state", "offline");
+    mqtt_cfg.lwt_topic = mqtt_presence_topic;
+    mqtt_cfg.lwt_msg = mqtt_offline_msg;
+    mqtt_cfg.lwt_msg_len = json_writer_finish(&writer);
+    mqtt_cfg.lwt_qos = 1;
+    mqtt_cfg.lwt_retain = 1;
 
     // init mqtt client handler
     client = esp_mqtt_client_init(&mqtt_cfg);
@@ -167,9 +301,7 @@ void mqtt_init(void)
 
     // wait until it is connected
     uint16_t waitingCount = 0;
-    do {
-        // delay the previous scanning period
-        vTaskDelay(pdMS_TO_TICKS(1000));
+    while( xSemaphoreTake(mqtt_connected_sem, pdMS_TO_TICKS(1000)) != pdTRUE ) {
 
         // feed the watchdog
         esp_task_wdt_reset();
@@ -186,8 +318,7 @@ void mqtt_init(void)
 
             // unreachable
         }
-
-    } while( !mqtt_currently_connected );
+    }
 }
 
 
@@ -213,7 +344,10 @@ void mqtt_send_msg(char *msg)
     if( mqtt_connected() && msg != NULL ) {
         // publish data
         int msg_id;
-        msg_id = esp_mqtt_client_publish(client, OPEN_TLS_MQTT_TOPIC, msg, 0, 0, 0);
+        msg_id = esp_mqtt_client_publish(client, mqtt_status_topic, msg, 0, 0, 0);
+        if( msg_id >= 0 ) {
+            netmon_topic_out(NETMON_TOPIC_STATUS, strlen(msg));
+        }
         ESP_LOGI(TAG, "MQTT Publish %s, msg_id=%d", msg, msg_id);
     } // end if(mqtt_connected())
 }
@@ -225,175 +359,696 @@ void mqtt_send_msg(char *msg)
 void mqtt_proceed_device_report(void)
 {
     if( mqtt_connected() ) {
-        char *postBuf = NULL;
 
         ESP_LOGI(TAG, "System Report");
 
-        // prepare JSON memory
-        postBuf = malloc(MQTT_BUF_SIZE);
-        if( postBuf != NULL ) {
+        xSemaphoreTake(mqtt_report_lock, portMAX_DELAY);
+
+        if( mqtt_build_device_report(mqtt_report_buf, sizeof(mqtt_report_buf)) > 0 ) {
+
+            // publish data
+            int msg_id = esp_mqtt_client_publish(client, mqtt_status_topic, mqtt_report_buf, 0, 0, 0);
+            if( msg_id >= 0 ) {
+                netmon_topic_out(NETMON_TOPIC_STATUS, strlen(mqtt_report_buf));
+            }
+            ESP_LOGI(TAG, "MQTT Publish %s, msg_id=%d", mqtt_report_buf, msg_id);
+        } else {
+            // counted in the next report which fits
+            mqtt_report_drops++;
+            ESP_LOGE(TAG, "device report does not fit in %d bytes, %u dropped", MQTT_REPORT_BUF_SIZE, mqtt_report_drops);
+        }
+
+        xSemaphoreGive(mqtt_report_lock);
+    } // end if(mqtt_connected())
+}
+
+
+/**
+ * Build the Device-Alive Report JSON into buf
+ * returns the length, 0 if it does not fit
+ */
+size_t mqtt_build_device_report(char *buf, size_t bufSize)
+{
+    json_writer_t writer;
+    char tempStr[32];
+
+    json_writer_init(&writer, buf, bufSize);
+    json_writer_begin_object(&writer, NULL);
+
+    // get current time
+    time_t currentTime;
+    time(&currentTime);
+
+    json_writer_string(&writer, "TT_ID", t_device_sn_str);
+    json_writer_int(&writer, "event_timestamp", currentTime);
+    json_writer_string(&writer, "firmware_version", TT_VERSION_INFO);
+
+    // get IP address
+    tcpip_adapter_ip_info_t ipInfo;
+    tcpip_adapter_get_ip_info(TCPIP_ADAPTER_IF_STA, &ipInfo);
+
+    json_writer_begin_object(&writer, "tt_net_info");
+    snprintf(tempStr, sizeof(tempStr), "%d.%d.%d.%d",
+                                    ipInfo.ip.addr & 0xff,
+                                    (ipInfo.ip.addr >> 8) & 0xff,
+                                    (ipInfo.ip.addr >> 16) & 0xff,
+                                    (ipInfo.ip.addr >> 24) & 0xff);
+    json_writer_string(&writer, "ipv4", tempStr);
+
+    // convert SSID to BASE64
+    unsigned char wifiSsidBase64[64];
+    size_t encLen = 0;
+    int result = mbedtls_base64_encode(wifiSsidBase64, sizeof(wifiSsidBase64) - 1, &encLen, (unsigned char *) t_device_wifi_ssid, strlen(t_device_wifi_ssid));
+    if( result == 0 ) {
+        // end string
+        wifiSsidBase64[encLen] = 0x00;
+
+        json_writer_string(&writer, "SSID", (char *) wifiSsidBase64);
+    }
+
+    snprintf(tempStr, sizeof(tempStr), "%02X:%02X:%02X:%02X:%02X:%02X",
+                                    t_device_wifi_bssid[0],
+                                    t_device_wifi_bssid[1],
+                                    t_device_wifi_bssid[2],
+                                    t_device_wifi_bssid[3],
+                                    t_device_wifi_bssid[4],
+                                    t_device_wifi_bssid[5]);
+    json_writer_string(&writer, "BSSID", tempStr);
+    json_writer_int(&writer, "rssi", app_wifi_get_rssi());
+    json_writer_end(&writer);
+
+    // WiFi outages by the way they ended, roaming and the RSSI of each minute, oldest first
+    app_wifi_stats_t wifiStats;
+    app_wifi_get_stats(&wifiStats);
+    json_writer_begin_object(&writer, "wifi");
+    json_writer_int(&writer, "reconnects", wifiStats.reconnects);
+    json_writer_int(&writer, "fast", wifiStats.fast);
+    json_writer_int(&writer, "scanned", wifiStats.scanned);
+    json_writer_int(&writer, "last_ms", wifiStats.lastTime);
+    json_writer_int(&writer, "fast_ms", wifiStats.fastTime);
+    json_writer_int(&writer, "scan_ms", wifiStats.scanTime);
+    json_writer_int(&writer, "roams", wifiStats.roams);
+    json_writer_int(&writer, "roam_scans", wifiStats.roamScans);
+    json_writer_int(&writer, "roam_ms", wifiStats.roamTime);
+    json_writer_int(&writer, "roam_fails", wifiStats.roamFails);
+    json_writer_int(&writer, "rssi_min", wifiStats.rssiMin);
+    json_writer_int(&writer, "rssi_avg", wifiStats.rssiAvg);
+    json_writer_int(&writer, "rssi_max", wifiStats.rssiMax);
+    json_writer_begin_array(&writer, "rssi_hist");
+    for( uint8_t hIdx = 0; hIdx < wifiStats.rssiCount; hIdx++ ) {
+        json_writer_int(&writer, NULL, wifiStats.rssiHistory[hIdx]);
+    }
+    json_writer_end(&writer);
+    json_writer_end(&writer);
+
+    // relay actuation stats, the waits are in ms
+    relay_stats_t relayStats;
+    relay_get_stats(&relayStats);
+    json_writer_begin_object(&writer, "relay");
+    json_writer_int(&writer, "pulses", relayStats.pulses);
+    json_writer_int(&writer, "dropped", relayStats.dropped);
+    json_writer_int(&writer, "wait_last", relayStats.lastQueueWait / 1000);
+    json_writer_int(&writer, "wait_max", relayStats.maxQueueWait / 1000);
+    json_writer_end(&writer);
+
+    // OTP replay cache counters
+    otp_stats_t otpStats;
+    cmd_get_otp_stats(&otpStats);
+    json_writer_begin_object(&writer, "otp");
+    json_writer_int(&writer, "replay_hits", otpStats.replayHits);
+    json_writer_int(&writer, "replay_misses", otpStats.replayMisses);
+    json_writer_int(&writer, "replay_full", otpStats.replayFull);
+    json_writer_end(&writer);
+
+    // inbound rate limit counters
+    rate_limit_stats_t rateStats;
+    rate_limit_get_stats(&rateStats);
+    json_writer_begin_object(&writer, "rate_limit");
+    json_writer_int(&writer, "admitted", rateStats.admitted);
+    json_writer_int(&writer, "drop_sender", rateStats.droppedSender);
+    json_writer_int(&writer, "drop_global", rateStats.droppedGlobal);
+    json_writer_int(&writer, "checked", rateStats.checked);
+    json_writer_int(&writer, "verified", rateStats.verified);
+    json_writer_end(&writer);
+
+    // inbound messages rebuilt from fragments, and the dropped ones
+    mqtt_reasm_stats_t reasmStats;
+    mqtt_get_reasm_stats(&reasmStats);
+    json_writer_begin_object(&writer, "reasm");
+    json_writer_int(&writer, "fragmented", reasmStats.fragmented);
+    json_writer_int(&writer, "oversized", reasmStats.oversized);
+    json_writer_int(&writer, "broken", reasmStats.broken);
+    json_writer_end(&writer);
+
+    // TLS handshakes since boot, and how many resumed the saved session
+    tls_session_stats_t tlsStats;
+    tls_session_get_stats(&tlsStats);
+    json_writer_begin_object(&writer, "tls");
+    json_writer_int(&writer, "handshakes", tlsStats.handshakes);
+    json_writer_int(&writer, "resumed", tlsStats.resumed);
+    json_writer_int(&writer, "hit_rate", tlsStats.handshakes > 0 ? tlsStats.resumed * 100 / tlsStats.handshakes : 0);
+    json_writer_int(&writer, "failed", tlsStats.failed);
+    json_writer_int(&writer, "last_ms", tlsStats.lastTime);
+    json_writer_int(&writer, "full_ms", tlsStats.fullTime);
+    json_writer_int(&writer, "resumed_ms", tlsStats.resumedTime);
+    json_writer_string(&writer, "suite", tlsStats.suite != NULL ? tlsStats.suite : "");
+    json_writer_string(&writer, "key", tlsStats.key != NULL ? tlsStats.key : "");
+    json_writer_end(&writer);
+
+    // startup phases in ms from the start of the app, -1 if not reached
+    json_writer_begin_object(&writer, "boot");
+    json_writer_string(&writer, "time_src", boot_time_source_name());
+    json_writer_bool(&writer, "time_ok", app_wifi_time_confirmed());
+    for( uint8_t phase = 0; phase < BOOT_PHASE_COUNT; phase++ ) {
+        json_writer_int(&writer, boot_phase_name(phase), boot_get_phase(phase));
+    }
+    json_writer_end(&writer);
+
+    // wakeups of the gpio task, and how late its jobs ran after their deadlines in us
+    t_gpio_stats_t gpioStats;
+    t_gpio_get_stats(&gpioStats);
+    json_writer_begin_object(&writer, "gpio");
+    json_writer_int(&writer, "wakeups", gpioStats.wakeups);
+    json_writer_int(&writer, "per_min", gpioStats.perMinute);
+    json_writer_int(&writer, "late_avg", gpioStats.lateAvg);
+    json_writer_int(&writer, "late_max", gpioStats.lateMax);
+    json_writer_end(&writer);
+
+    // the periodical jobs, times in us
+    periodical_stats_t jobStats[PERIODICAL_MAX_JOBS];
+    uint8_t jobCount = periodical_get_stats(jobStats, PERIODICAL_MAX_JOBS);
+    json_writer_begin_object(&writer, "jobs");
+    for( uint8_t jIdx = 0; jIdx < jobCount; jIdx++ ) {
+        json_writer_begin_object(&writer, jobStats[jIdx].name);
+        json_writer_int(&writer, "n", jobStats[jIdx].runs);
+        json_writer_int(&writer, "run", jobStats[jIdx].lastRuntime);
+        json_writer_int(&writer, "run_max", jobStats[jIdx].maxRuntime);
+        json_writer_int(&writer, "late", jobStats[jIdx].lastLateness);
+        json_writer_int(&writer, "late_max", jobStats[jIdx].maxLateness);
+        json_writer_int(&writer, "over", jobStats[jIdx].overruns);
+        json_writer_end(&writer);
+    }
+    json_writer_end(&writer);
+
+    // the heap in bytes, lowest and highest samples since boot
+    sysmon_stats_t sysStats;
+    sysmon_get_stats(&sysStats);
+    json_writer_begin_object(&writer, "heap");
+    json_writer_int(&writer, "free", sysStats.free);
+    json_writer_int(&writer, "free_min", sysStats.freeMin);
+    json_writer_int(&writer, "free_max", sysStats.freeMax);
+    json_writer_int(&writer, "lowest", sysStats.lowest);
+    json_writer_int(&writer, "block", sysStats.largest);
+    json_writer_int(&writer, "block_min", sysStats.largestMin);
+    json_writer_int(&writer, "frag", sysStats.frag);
+    json_writer_int(&writer, "frag_max", sysStats.fragMax);
+    json_writer_end(&writer);
+
+    // every task as [CPU in 0.1 %, highest CPU since boot, free stack in bytes]
+    static sysmon_task_stats_t taskStats[SYSMON_MAX_TASKS];
+    uint8_t taskCount = sysmon_get_task_stats(taskStats, SYSMON_MAX_TASKS);
+    json_writer_begin_object(&writer, "tasks");
+    for( uint8_t tIdx = 0; tIdx < taskCount; tIdx++ ) {
+        json_writer_begin_array(&writer, taskStats[tIdx].name);
+        json_writer_int(&writer, NULL, taskStats[tIdx].cpu);
+        json_writer_int(&writer, NULL, taskStats[tIdx].cpuMax);
+        json_writer_int(&writer, NULL, taskStats[tIdx].stackFree);
+        json_writer_end(&writer);
+    }
+    json_writer_end(&writer);
+
+    // the MQTT connection, times in ms, the outages as [seconds since boot, reason, detail, failed]
+    // and every topic role as [messages in, bytes in, messages out, bytes out]
+    static netmon_stats_t netStats;
+    netmon_get_stats(&netStats);
+    json_writer_begin_object(&writer, "net");
+    json_writer_int(&writer, "connects", netStats.connects);
+    json_writer_int(&writer, "disconnects", netStats.disconnects);
+    json_writer_int(&writer, "failed", netStats.failed);
+    json_writer_int(&writer, "report_drops", mqtt_get_report_drops());
+    json_writer_begin_object(&writer, "ping");
+    json_writer_int(&writer, "n", netStats.ping.count);
+    json_writer_int(&writer, "lost", netStats.pingsLost);
+    json_writer_int(&writer, "last", netStats.ping.last);
+    json_writer_int(&writer, "min", netStats.ping.min);
+    json_writer_int(&writer, "avg", netStats.ping.avg);
+    json_writer_int(&writer, "max", netStats.ping.max);
+    json_writer_end(&writer);
+    json_writer_begin_object(&writer, "connect");
+    json_writer_int(&writer, "n", netStats.connect.count);
+    json_writer_int(&writer, "last", netStats.connect.last);
+    json_writer_int(&writer, "min", netStats.connect.min);
+    json_writer_int(&writer, "avg", netStats.connect.avg);
+    json_writer_int(&writer, "max", netStats.connect.max);
+    json_writer_end(&writer);
+    json_writer_begin_object(&writer, "reasons");
+    for( uint8_t reason = 0; reason < NETMON_REASON_COUNT; reason++ ) {
+        json_writer_int(&writer, netmon_reason_name(reason), netStats.reasons[reason]);
+    }
+    json_writer_end(&writer);
+    json_writer_begin_array(&writer, "outages");
+    for( uint8_t oIdx = 0; oIdx < netStats.outageCount; oIdx++ ) {
+        json_writer_begin_array(&writer, NULL);
+        json_writer_int(&writer, NULL, netStats.outages[oIdx].at);
+        json_writer_string(&writer, NULL, netmon_reason_name(netStats.outages[oIdx].reason));
+        json_writer_int(&writer, NULL, netStats.outages[oIdx].detail);
+        json_writer_bool(&writer, NULL, netStats.outages[oIdx].failed);
+        json_writer_end(&writer);
+    }
+    json_writer_end(&writer);
+    json_writer_begin_object(&writer, "topics");
+    for( uint8_t topic = 0; topic < NETMON_TOPIC_COUNT; topic++ ) {
+        json_writer_begin_array(&writer, netmon_topic_name(topic));
+        json_writer_int(&writer, NULL, netStats.topics[topic].inMsgs);
+        json_writer_int(&writer, NULL, netStats.topics[topic].inBytes);
+        json_writer_int(&writer, NULL, netStats.topics[topic].outMsgs);
+        json_writer_int(&writer, NULL, netStats.topics[topic].outBytes);
+        json_writer_end(&writer);
+    }
+    json_writer_end(&writer);
+    json_writer_end(&writer);
+
+    // command latency percentiles, in us
+    json_writer_begin_object(&writer, "latency");
+    for( uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++ ) {
+
+        latency_summary_t summary;
+        latency_get_summary(stage, &summary);
+
+        json_writer_begin_object(&writer, latency_stage_name(stage));
+        json_writer_int(&writer, "n", summary.count);
+        json_writer_int(&writer, "p50", summary.p50);
+        json_writer_int(&writer, "p95", summary.p95);
+        json_writer_int(&writer, "p99", summary.p99);
+        json_writer_int(&writer, "max", summary.max);
+        json_writer_end(&writer);
+    }
+    json_writer_end(&writer);
+
+    // complete the json
+    return(json_writer_finish(&writer));
+}
+
 
-            char tempStr[256];
+/**
+ * Proceed Command Latency Report
+ * every non-empty bucket of every stage as [upper bound in us, count]
+ */
+void mqtt_proceed_latency_report(void)
+{
+    if( mqtt_connected() ) {
 
-            // get current time
-            time_t currentTime;
-            time(&currentTime);
+        static uint32_t counts[LATENCY_BUCKETS];
+        json_writer_t writer;
+        bool truncated = false;
 
-            // put event timestamp to post buffer
-            sprintf(postBuf, "{\"TT_ID\":\"%s\",\"event_timestamp\":%ld,\"firmware_version\":\"%s\"", t_device_sn_str, currentTime, TT_VERSION_INFO);
+        ESP_LOGI(TAG, "Latency Report");
 
-            tcpip_adapter_ip_info_t ipInfo;
+        xSemaphoreTake(mqtt_report_lock, portMAX_DELAY);
 
-            // get IP address
-            tcpip_adapter_get_ip_info(TCPIP_ADAPTER_IF_STA, &ipInfo);
+        // get current time
+        time_t currentTime;
+        time(&currentTime);
 
-            // put IP address to post buffer
-            sprintf(tempStr, ",\"tt_net_info\":{\"ipv4\":\"%d.%d.%d.%d\"",
-                                            ipInfo.ip.addr & 0xff,
-                                            (ipInfo.ip.addr >> 8) & 0xff,
-                                            (ipInfo.ip.addr >> 16) & 0xff,
-                                            (ipInfo.ip.addr >> 24) & 0xff);
-            strcat(postBuf, tempStr);
+        json_writer_init(&writer, mqtt_report_buf, sizeof(mqtt_report_buf));
+        json_writer_begin_object(&writer, NULL);
+        json_writer_string(&writer, "TT_ID", t_device_sn_str);
+        json_writer_int(&writer, "event_timestamp", currentTime);
+        json_writer_begin_object(&writer, "latency_histogram");
 
-            // convert SSID to BASE64
-            unsigned char wifiSsidBase64[64];
-            uint32_t encLen = 0;
-            int result = mbedtls_base64_encode(wifiSsidBase64, sizeof(wifiSsidBase64) - 1, &encLen, (unsigned char *) t_device_wifi_ssid, strlen(t_device_wifi_ssid));
-            if( result == 0 ) {
-                // end string
-                wifiSsidBase64[encLen] = 0x00;
+        for( uint8_t stage = 0; stage < LATENCY_STAGE_COUNT && !truncated; stage++ ) {
 
-                // put SSID to post buffer
-                sprintf(tempStr, ",\"SSID\":\"%s\"", (char *) wifiSsidBase64);
-                strcat(postBuf, tempStr);
+            // room is kept for closing the JSON when the buckets do not fit
+            if( json_writer_room(&writer) < MQTT_LATENCY_REPORT_RESERVE ) {
+                truncated = true;
+                break;
             }
 
-            // put BSSID to post buffer
-            sprintf(tempStr, ",\"BSSID\":\"%02X:%02X:%02X:%02X:%02X:%02X\"",
-                                                                t_device_wifi_bssid[0],
-                                                                t_device_wifi_bssid[1],
-                                                                t_device_wifi_bssid[2],
-                                                                t_device_wifi_bssid[3],
-                                                                t_device_wifi_bssid[4],
-                                                                t_device_wifi_bssid[5]);
-            strcat(postBuf, tempStr);
+            latency_get_buckets(stage, counts);
 
-            // get wifi rssi
-            int8_t wifiRssi;
-            wifiRssi = app_wifi_get_rssi();
+            json_writer_begin_array(&writer, latency_stage_name(stage));
+            for( uint32_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++ ) {
 
-            // put wifi rssi to post buffer
-            sprintf(tempStr, ",\"rssi\":%d}", wifiRssi);
-            strcat(postBuf, tempStr);
+                if( counts[bucket] == 0 ) {
+                    continue;
+                }
 
-            // complete the json
-            strcat(postBuf, "}");
+                if( json_writer_room(&writer) < MQTT_LATENCY_REPORT_RESERVE ) {
+                    truncated = true;
+                    break;
+                }
 
-            // publish data
-            int msg_id = esp_mqtt_client_publish(client, OPEN_TLS_MQTT_TOPIC, postBuf, 0, 0, 0);
-            ESP_LOGI(TAG, "MQTT Publish %s, msg_id=%d", postBuf, msg_id);
+                json_writer_begin_array(&writer, NULL);
+                json_writer_int(&writer, NULL, latency_bucket_upper(bucket));
+                json_writer_int(&writer, NULL, counts[bucket]);
+                json_writer_end(&writer);
+            }
+            json_writer_end(&writer);
+        }
+        json_writer_end(&writer);
+
+        if( truncated ) {
+            json_writer_bool(&writer, "truncated", true);
+        }
 
-            // release memory
-            UTIL_FREE(postBuf);
+        // complete the json
+        if( json_writer_finish(&writer) > 0 ) {
+
+            // publish data
+            int msg_id = esp_mqtt_client_publish(client, mqtt_status_topic, mqtt_report_buf, 0, 0, 0);
+            if( msg_id >= 0 ) {
+                netmon_topic_out(NETMON_TOPIC_STATUS, strlen(mqtt_report_buf));
+            }
+            ESP_LOGI(TAG, "MQTT Publish %s, msg_id=%d", mqtt_report_buf, msg_id);
         } else {
-            ESP_LOGE(TAG, "unable to malloc memory");
+            ESP_LOGE(TAG, "latency report does not fit in %d bytes", MQTT_REPORT_BUF_SIZE);
         }
+
+        xSemaphoreGive(mqtt_report_lock);
     } // end if(mqtt_connected())
 }
 
 
+/**
+ * counters of the inbound message reassembly, updated from the MQTT task only
+ */
+void mqtt_get_reasm_stats(mqtt_reasm_stats_t *stats)
+{
+    memcpy(stats, &mqtt_reasm.stats, sizeof(mqtt_reasm_stats_t));
+}
+
+
+/**
+ * device reports since boot which did not fit in MQTT_REPORT_BUF_SIZE and were not sent
+ */
+uint32_t mqtt_get_report_drops(void)
+{
+    return(mqtt_report_drops);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////
 // local function implementations
 
-static void mqtt_handle_received_control_message(char *data, uint32_t len)
+/**
+ * a complete inbound message, neither the data nor the topic is null terminated
+ */
+static void mqtt_handle_received_message(const mqtt_reasm_msg_t *msg)
 {
-    char *msgBuf = (char *) malloc(len + 1);
-    if( msgBuf != NULL ) {
+    // process message only sent from the known topics
+    mqtt_router_handler_t handler = mqtt_router_match(&mqtt_router, msg->topic, msg->topicLen);
 
-        bool commandForPhysicalControl = false;
-        bool requestSystemReport = false;
+    if( handler != NULL ) {
 
-        // duplicate the message
-        memcpy(msgBuf, data, len);
-        msgBuf[len] = 0;    // make it null-terminated
+        handler(msg);
 
-        // parse the JSON message
-        cJSON *jsonRoot = cJSON_Parse(msgBuf);
-        if( jsonRoot != NULL ) {
+    } else {
 
-            uint32_t commandActionId = 0;
-            char *otpAuthStr = NULL;
-            cmd_action_t commandSet;
+        ESP_LOGI(TAG, "MQTT_EVENT_DATA, (no handler) %.*s", (int) msg->dataLen, msg->data);
+    }
+}
 
-            // get the command ID
-            cJSON *cmdIdJSON = cJSON_GetObjectItem(jsonRoot, "command");
-            if( cmdIdJSON != NULL ) {
 
-                if( cJSON_IsNumber(cmdIdJSON) ) {
-                    commandActionId = cmdIdJSON->valueint;
-                }
-            }
+/**
+ * a command on the command topic, a phone sub-topic or the group topic
+ */
+static void mqtt_handle_command(const mqtt_reasm_msg_t *msg)
+{
+    // ignore the status report of a device with older firmware, which sends it to the command topic
+    // then process the other messages
+    if( msg->dataLen >= 8 && !memcmp(msg->data, "{\"TT_ID\"", 8) ) {
+        return;
+    }
 
-            // get OTP authentication key
-            cJSON *otpAuthJSON = cJSON_GetObjectItem(jsonRoot, "otp-auth");
-            if( otpAuthJSON != NULL ) {
+    t_gpio_led2_blink();
 
-                otpAuthStr = cJSON_GetStringValue(otpAuthJSON);
-            }
+    if( cmd_parser_is_frame(msg->data, msg->dataLen) ) {
 
-            // identify the command
-            if( commandActionId > CMD_ACTION_NONE && commandActionId < CMD_ACTION_INVALID ) {
+        // binary command frame, no parsing or hex conversion
+        mqtt_handle_received_control_frame(msg->data, msg->dataLen, msg->arrival);
 
-                commandSet.command_action = commandActionId;
+    } else {
 
-                if( commandSet.command_action == CMD_ACTION_FORCE_REPORT ) {
+        mqtt_handle_received_control_message(msg->data, msg->dataLen, msg->arrival);
+    }
+}
 
-                    ESP_LOGI(TAG, "System Report request received");
 
-                    // system checking request, no OTP checking is needed
-                    // so it can be checked manually from the Test Console
-                    mqtt_proceed_device_report();
-                    requestSystemReport = true;
+static void mqtt_handle_received_control_message(const char *data, uint32_t len, int64_t arrivalTime)
+{
+    bool commandForPhysicalControl = false;
+    bool requestSystemReport = false;
+    cmd_parser_json_t parsed;
 
-                } else {
+    // parse the JSON message in place, no copy and no allocation
+    if( cmd_parser_json(data, len, &parsed) ) {
 
-                    // physical action command requires the OTP authentication
-                    if( otpAuthStr != NULL ) {
+        cmd_action_t commandSet = { .stamps = { .arrival = arrivalTime, .parsed = esp_timer_get_time() } };
 
-                        // 16-byte encrypted data must be 32 characters long
-                        if( strlen(otpAuthStr) == 32 ) {
+        // identify the command
+        if( parsed.command > CMD_ACTION_NONE && parsed.command < CMD_ACTION_INVALID ) {
 
-                            // convert the string to 16-byte value array
-                            if( util_string_to_aes_key(otpAuthStr, commandSet.otpAuth) ) {
+            commandSet.command_action = parsed.command;
 
-                                commandForPhysicalControl = true;
-                            }
-                        }
-                    }
-                }
-            }
+            if( commandSet.command_action == CMD_ACTION_FORCE_REPORT ) {
 
-            if( commandForPhysicalControl) {
+                ESP_LOGI(TAG, "System Report request received");
 
-                // add this action to the command queue
-                cmd_add(&commandSet);
+                // system checking request, no OTP checking is needed
+                // so it can be checked manually from the Test Console
+                mqtt_proceed_device_report();
+                requestSystemReport = true;
 
-                ESP_LOGE(TAG, "command accepted, action=%d, %s", commandSet.command_action, msgBuf);
+            } else if( commandSet.command_action == CMD_ACTION_LATENCY_REPORT ) {
+
+                ESP_LOGI(TAG, "Latency Report request received");
+
+                // the same as the system report, no OTP checking is needed
+                mqtt_proceed_latency_report();
+                requestSystemReport = true;
+
+            } else if( parsed.otpAuthFound ) {
+
+                // physical action command requires the OTP authentication
+                memcpy(commandSet.otpAuth, parsed.otpAuth, sizeof(commandSet.otpAuth));
+                commandForPhysicalControl = true;
             }
+        }
+
+        if( commandForPhysicalControl ) {
+
+            // add this action to the command queue
+            cmd_add(&commandSet);
+
+            ESP_LOGE(TAG, "command accepted, action=%d, %.*s", commandSet.command_action, (int) len, data);
+        }
+    } // end if(cmd_parser_json())
+
+    // output to log if this command is not accepted
+    if( !commandForPhysicalControl && !requestSystemReport ) {
+
+        ESP_LOGE(TAG, "invalid command received, %.*s", (int) len, data);
+    }
+}
+
+
+static void mqtt_handle_received_control_frame(const char *data, uint32_t len, int64_t arrivalTime)
+{
+    cmd_action_t commandSet;
+
+    if( cmd_parser_frame(data, len, &commandSet) ) {
+
+        commandSet.stamps.arrival = arrivalTime;
+        commandSet.stamps.parsed = esp_timer_get_time();
+
+        if( commandSet.command_action == CMD_ACTION_FORCE_REPORT ) {
+
+            ESP_LOGI(TAG, "System Report request received");
+
+            // the same as the JSON command, no OTP checking is needed
+            mqtt_proceed_device_report();
+
+        } else if( commandSet.command_action == CMD_ACTION_LATENCY_REPORT ) {
+
+            ESP_LOGI(TAG, "Latency Report request received");
+
+            mqtt_proceed_latency_report();
+
+        } else {
+
+            // add this action to the command queue
+            cmd_add(&commandSet);
+
+            ESP_LOGI(TAG, "command frame accepted, action=%d", commandSet.command_action);
+        }
+
+    } else {
+
+        ESP_LOGE(TAG, "invalid command frame received, len=%d", len);
+    }
+}
+
+
+/**
+ * the retained online state, with what a dashboard needs to tell a reboot from a network drop
+ */
+static void mqtt_publish_online(esp_mqtt_client_handle_t client)
+{
+    json_writer_t writer;
+    time_t currentTime;
+    time(&currentTime);
+
+    json_writer_init(&writer, mqtt_online_msg, sizeof(mqtt_online_msg));
+    json_writer_begin_object(&writer, NULL);
+    json_writer_string(&writer, "TT_ID", t_device_sn_str);
+    json_writer_string(&writer, "state", "online");
+    json_writer_int(&writer, "event_timestamp", currentTime);
+    json_writer_string(&writer, "firmware_version", TT_VERSION_INFO);
+    json_writer_string(&writer, "boot_reason", mqtt_boot_reason());
+
+    size_t len = json_writer_finish(&writer);
+    if( len == 0 ) {
+        ESP_LOGE(TAG, "online message does not fit in %d bytes", MQTT_PRESENCE_BUF_SIZE);
+        return;
+    }
+
+    int msg_id = esp_mqtt_client_publish(client, mqtt_presence_topic, mqtt_online_msg, len, 1, 1);
+    if( msg_id >= 0 ) {
+        netmon_topic_out(NETMON_TOPIC_PRESENCE, len);
+    }
+    ESP_LOGI(TAG, "MQTT Publish %s, msg_id=%d", mqtt_online_msg, msg_id);
+}
+
+
+static const char *mqtt_boot_reason(void)
+{
+    switch( esp_reset_reason() ) {
+        case ESP_RST_POWERON:   return("poweron");
+        case ESP_RST_EXT:       return("external");
+        case ESP_RST_SW:        return("software");
+        case ESP_RST_PANIC:     return("panic");
+        case ESP_RST_INT_WDT:   return("int_wdt");
+        case ESP_RST_TASK_WDT:  return("task_wdt");
+        case ESP_RST_WDT:       return("wdt");
+        case ESP_RST_DEEPSLEEP: return("deepsleep");
+        case ESP_RST_BROWNOUT:  return("brownout");
+        case ESP_RST_SDIO:      return("sdio");
+        default:                return("unknown");
+    }
+}
 
-            // release the cJSON object
-            cJSON_Delete(jsonRoot);
 
-        } // end if(jsonRoot==NULL)-else
+/**
+ * a command over the rate limit, in one fragment on a command topic, whose OTP is valid
+ * and was neither accepted by the command task nor let through here before
+ * the OTPs are checked at RATE_LIMIT_CHECK_RATE at most, nothing is parsed without a token
+ */
+static bool mqtt_command_verified(esp_mqtt_event_handle_t event)
+{
+    bool commandTopic = mqtt_data_topic == NETMON_TOPIC_COMMAND || mqtt_data_topic == NETMON_TOPIC_PHONE ||
+                        mqtt_data_topic == NETMON_TOPIC_GROUP;
+
+    if( !commandTopic || event->data_len != event->total_data_len || event->data_len > MQTT_VERIFIED_MAX_LEN ||
+        !rate_limit_admit_check() ) {
+        return(false);
+    }
+
+    const uint8_t *otpAuth = NULL;
+    cmd_action_t frame;
+    cmd_parser_json_t parsed;
+
+    if( cmd_parser_is_frame(event->data, event->data_len) ) {
+
+        if( cmd_parser_frame(event->data, event->data_len, &frame) ) {
+            otpAuth = frame.otpAuth;
+        }
+
+    } else if( cmd_parser_json(event->data, event->data_len, &parsed) && parsed.otpAuthFound ) {
+
+        otpAuth = parsed.otpAuth;
+    }
 
-        // output to log if this command is not accepted
-        if( !commandForPhysicalControl && !requestSystemReport ) {
+    if( otpAuth == NULL || !cmd_otp_check(otpAuth) ) {
+        return(false);
+    }
 
-            ESP_LOGE(TAG, "invalid command received, %s", msgBuf);
+    // a replay of a command still in the queue, the command task has not remembered it yet
+    for( uint8_t oIdx = 0; oIdx < MQTT_VERIFIED_RECENT; oIdx++ ) {
+        if( !memcmp(mqtt_verified_otps[oIdx], otpAuth, sizeof(mqtt_verified_otps[0])) ) {
+            return(false);
         }
+    }
+
+    if( !rate_limit_admit_verified() ) {
+        return(false);
+    }
+
+    memcpy(mqtt_verified_otps[mqtt_verified_head], otpAuth, sizeof(mqtt_verified_otps[0]));
+    mqtt_verified_head = (mqtt_verified_head + 1) % MQTT_VERIFIED_RECENT;
 
-        // release allocated msgBuf
-        UTIL_FREE(msgBuf);
-    } // end if(msgBuf!=NULL)
+    return(true);
 }
 
+
+/**
+ * the role of an inbound topic, the phones publish on the sub-topics of the command topic
+ */
+static netmon_topic_t mqtt_topic_role(const char *topic, int topicLen)
+{
+    size_t len = topicLen > 0 ? (size_t) topicLen : 0;
+    size_t commandLen = sizeof(OPEN_TLS_MQTT_TOPIC) - 1;
+
+    if( topic == NULL ) {
+        return(NETMON_TOPIC_OTHER);
+    }
+
+#ifdef OPEN_TLS_MQTT_GROUP_TOPIC
+    if( len == sizeof(OPEN_TLS_MQTT_GROUP_TOPIC) - 1 && !memcmp(topic, OPEN_TLS_MQTT_GROUP_TOPIC, len) ) {
+        return(NETMON_TOPIC_GROUP);
+    }
+#endif
+
+    if( len < commandLen || memcmp(topic, OPEN_TLS_MQTT_TOPIC, commandLen) ) {
+        return(NETMON_TOPIC_OTHER);
+    }
+
+    if( len == commandLen ) {
+        return(NETMON_TOPIC_COMMAND);
+    }
+
+    // one level down, as MQTT_SENDER_TOPIC_FILTER
+    if( topic[commandLen] == '/' && len > commandLen + 1 &&
+        memchr(topic + commandLen + 1, '/', len - commandLen - 1) == NULL ) {
+        return(NETMON_TOPIC_PHONE);
+    }
+
+    return(NETMON_TOPIC_OTHER);
+}
+
+
+/**
+ * the reason of a failed connection, or of the disconnection which follows
+ */
+static void mqtt_handle_error(const esp_mqtt_error_codes_t *error)
+{
+    if( error == NULL ) {
+        netmon_mqtt_error(NETMON_REASON_CLOSED, 0);
+        return;
+    }
+
+    if( error->error_type == MQTT_ERROR_TYPE_CONNECTION_REFUSED ) {
+
+        ESP_LOGE(TAG, "connection refused, %d", error->connect_return_code);
+        netmon_mqtt_error(NETMON_REASON_REFUSED, error->connect_return_code);
+
+    } else if( error->esp_transport_sock_errno != 0 ) {
+
+        ESP_LOGE(TAG, "socket error, %d", error->esp_transport_sock_errno);
+        netmon_mqtt_error(NETMON_REASON_SOCKET, error->esp_transport_sock_errno);
+
+    } else {
+
+        ESP_LOGE(TAG, "TLS error, 0x%x", error->esp_tls_last_esp_err);
+        netmon_mqtt_error(NETMON_REASON_TLS, error->esp_tls_last_esp_err);
+    }
+}
@@ -10,11 +10,36 @@
 #ifndef _MQTT_H_
 #define _MQTT_H_
 
+#include <stddef.h>
+#include <stdint.h>
+#include "mqtt_reasm.h"
+#include "periodical.h"
+#include "sysmon.h"
+#include "netmon.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+// the device report at its longest, every number at 11 characters and every list full,
+// esp-mqtt sends a message longer than its buffer in pieces
+#define MQTT_REPORT_INT_SIZE                11      // -2147483648
+#define MQTT_REPORT_FIXED_SIZE              3328    // without the tasks, the outages and the jobs, about 3.1 KB
+#define MQTT_REPORT_TASK_SIZE               (SYSMON_TASK_NAME_SIZE + 3 * MQTT_REPORT_INT_SIZE + 8)
+#define MQTT_REPORT_OUTAGE_SIZE             (2 * MQTT_REPORT_INT_SIZE + 24)
+#define MQTT_REPORT_JOB_SIZE                (6 * MQTT_REPORT_INT_SIZE + 72)     // a job name up to 16 characters
+#define MQTT_REPORT_BUF_SIZE                (MQTT_REPORT_FIXED_SIZE + \
+                                             SYSMON_MAX_TASKS * MQTT_REPORT_TASK_SIZE + \
+                                             NETMON_OUTAGE_SIZE * MQTT_REPORT_OUTAGE_SIZE + \
+                                             PERIODICAL_MAX_JOBS * MQTT_REPORT_JOB_SIZE)
+
 ///////////////////////////////////////////////////////////////////////////////////
 // public function
 void mqtt_init(void);
 bool mqtt_connected(void);
 void mqtt_send_msg(char *msg);
 void mqtt_proceed_device_report(void);
+size_t mqtt_build_device_report(char *buf, size_t bufSize);
+void mqtt_proceed_latency_report(void);
+void mqtt_get_reasm_stats(mqtt_reasm_stats_t *stats);
+uint32_t mqtt_get_report_drops(void);
 
 #endif
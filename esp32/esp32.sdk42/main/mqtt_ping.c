@@ -0,0 +1,83 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_transport.h"
+
+#include "netmon.h"
+
+// Note: esp-mqtt of ESP-IDF v4.2 sends the PINGREQ and takes the PINGRESP without an event,
+//       so esp_transport_write() and esp_transport_read() are wrapped at link time
+//       (-Wl,--wrap, see CMakeLists.txt and component.mk) and the two packets are
+//       recognized on the way. both are two bytes, PINGREQ C0 00 and PINGRESP D0 00,
+//       esp-mqtt writes a packet in one call and reads the fixed header one byte at a time.
+//
+//       only the MQTT task uses the transport, there is no locking. a PINGRESP with no
+//       PINGREQ waiting is ignored by netmon, so a stray match costs nothing
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define MQTT_PING_REQ                       0xC0
+#define MQTT_PING_RESP                      0xD0
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static bool mqtt_ping_resp_header = false;      // the last read was the single byte D0
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+// the real ones, renamed by the linker
+int __real_esp_transport_write(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms);
+int __real_esp_transport_read(esp_transport_handle_t t, char *buffer, int len, int timeout_ms);
+int __wrap_esp_transport_write(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms);
+int __wrap_esp_transport_read(esp_transport_handle_t t, char *buffer, int len, int timeout_ms);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+int __wrap_esp_transport_write(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms)
+{
+    int ret = __real_esp_transport_write(t, buffer, len, timeout_ms);
+
+    if( ret == 2 && len == 2 && (uint8_t) buffer[0] == MQTT_PING_REQ && buffer[1] == 0x00 ) {
+        netmon_ping_sent();
+    }
+
+    return(ret);
+}
+
+
+int __wrap_esp_transport_read(esp_transport_handle_t t, char *buffer, int len, int timeout_ms)
+{
+    int ret = __real_esp_transport_read(t, buffer, len, timeout_ms);
+
+    if( ret <= 0 ) {
+        return(ret);
+    }
+
+    if( mqtt_ping_resp_header ) {
+
+        // the remaining length of the packet whose type came in the last read
+        mqtt_ping_resp_header = false;
+        if( buffer[0] == 0x00 ) {
+            netmon_ping_received();
+        }
+
+    } else if( (uint8_t) buffer[0] == MQTT_PING_RESP ) {
+
+        if( ret == 1 ) {
+            mqtt_ping_resp_header = true;
+        } else if( buffer[1] == 0x00 ) {
+            netmon_ping_received();
+        }
+    }
+
+    return(ret);
+}
@@ -0,0 +1,142 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "mqtt_reasm.h"
+
+// Note: esp-mqtt hands a message longer than its buffer over in several MQTT_EVENT_DATA,
+//       with total_data_len and current_data_offset set, and the topic only in the first one.
+//       the fragments of one message always come in order and are not interleaved
+//       with another message, so one buffer is enough.
+//
+//       a message in a single fragment is passed through without copying
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static void mqtt_reasm_drop(mqtt_reasm_t *reasm, uint32_t *counter);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+void mqtt_reasm_init(mqtt_reasm_t *reasm, char *buf, uint32_t bufSize)
+{
+    memset(reasm, 0, sizeof(mqtt_reasm_t));
+    reasm->buf = buf;
+    reasm->bufSize = bufSize;
+}
+
+
+/**
+ * add one MQTT_EVENT_DATA fragment
+ * returns true and fills msg once the message is complete
+ */
+bool mqtt_reasm_feed(mqtt_reasm_t *reasm, const char *topic, int topicLen,
+                     const char *data, int dataLen, int offset, int totalLen,
+                     int64_t now, mqtt_reasm_msg_t *msg)
+{
+    if( offset == 0 ) {
+
+        // a new message while the previous one is incomplete
+        if( reasm->active ) {
+            reasm->active = false;
+            reasm->stats.broken++;
+        }
+        reasm->skipping = false;
+
+        if( totalLen < 0 || dataLen < 0 || topicLen < 0 ) {
+            mqtt_reasm_drop(reasm, &reasm->stats.broken);
+            return(false);
+        }
+
+        if( (uint32_t) totalLen > reasm->bufSize ) {
+            mqtt_reasm_drop(reasm, &reasm->stats.oversized);
+            return(false);
+        }
+
+        // complete in one fragment
+        if( dataLen >= totalLen ) {
+
+            msg->topic = topic;
+            msg->topicLen = topicLen;
+            msg->data = data;
+            msg->dataLen = totalLen;
+            msg->arrival = now;
+
+            return(true);
+        }
+
+        if( (uint32_t) topicLen > sizeof(reasm->topic) ) {
+            mqtt_reasm_drop(reasm, &reasm->stats.oversized);
+            return(false);
+        }
+
+        memcpy(reasm->topic, topic, topicLen);
+        memcpy(reasm->buf, data, dataLen);
+        reasm->topicLen = topicLen;
+        reasm->totalLen = totalLen;
+        reasm->received = dataLen;
+        reasm->arrival = now;
+        reasm->active = true;
+
+        return(false);
+    }
+
+    if( reasm->skipping ) {
+        return(false);
+    }
+
+    // the first fragment was missed, or one in between
+    if( !reasm->active || dataLen < 0 || offset != (int) reasm->received ||
+        totalLen != (int) reasm->totalLen || dataLen > totalLen - offset ) {
+
+        reasm->active = false;
+        mqtt_reasm_drop(reasm, &reasm->stats.broken);
+        return(false);
+    }
+
+    memcpy(reasm->buf + reasm->received, data, dataLen);
+    reasm->received += dataLen;
+
+    if( reasm->received < reasm->totalLen ) {
+        return(false);
+    }
+
+    reasm->active = false;
+    reasm->stats.fragmented++;
+
+    msg->topic = reasm->topic;
+    msg->topicLen = reasm->topicLen;
+    msg->data = reasm->buf;
+    msg->dataLen = reasm->totalLen;
+    msg->arrival = reasm->arrival;
+
+    return(true);
+}
+
+
+/**
+ * drop the rest of a message, called instead of feeding its first fragment
+ */
+void mqtt_reasm_skip(mqtt_reasm_t *reasm)
+{
+    reasm->active = false;
+    reasm->skipping = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+static void mqtt_reasm_drop(mqtt_reasm_t *reasm, uint32_t *counter)
+{
+    (*counter)++;
+    reasm->skipping = true;
+}
@@ -0,0 +1,58 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _MQTT_REASM_H_
+#define _MQTT_REASM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define MQTT_REASM_TOPIC_SIZE               128     // longest topic of a fragmented message
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef struct {
+    uint32_t fragmented;                // messages rebuilt from more than one fragment
+    uint32_t oversized;                 // dropped, longer than the buffer
+    uint32_t broken;                    // dropped, a fragment was missing or out of order
+} mqtt_reasm_stats_t;
+
+// a complete message, valid until the next mqtt_reasm_feed()
+typedef struct {
+    const char *topic;
+    uint32_t topicLen;
+    const char *data;
+    uint32_t dataLen;
+    int64_t arrival;                    // esp_timer_get_time() of the first fragment
+} mqtt_reasm_msg_t;
+
+typedef struct {
+    char *buf;                          // preallocated by the caller
+    uint32_t bufSize;                   // the largest message accepted
+    char topic[MQTT_REASM_TOPIC_SIZE];
+    uint32_t topicLen;
+    uint32_t totalLen;
+    uint32_t received;
+    int64_t arrival;
+    bool active;                        // a fragmented message is being rebuilt
+    bool skipping;                      // the rest of the current message is dropped
+    mqtt_reasm_stats_t stats;
+} mqtt_reasm_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void mqtt_reasm_init(mqtt_reasm_t *reasm, char *buf, uint32_t bufSize);
+bool mqtt_reasm_feed(mqtt_reasm_t *reasm, const char *topic, int topicLen,
+                     const char *data, int dataLen, int offset, int totalLen,
+                     int64_t now, mqtt_reasm_msg_t *msg);
+void mqtt_reasm_skip(mqtt_reasm_t *reasm);
+
+#endif
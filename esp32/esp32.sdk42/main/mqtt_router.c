@@ -0,0 +1,206 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "mqtt_router.h"
+
+// Note: the topic filters are split in levels into a trie when the router is built,
+//       a topic is then matched level by level without copying or allocating.
+//       at every level an exact match is followed first, then '+', and '#' only when
+//       nothing below them matches; the topic is read again only when overlapping
+//       filters send the walk back to a '+'
+//
+//       wildcards do not match topics starting with '$', as on the broker
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static uint8_t mqtt_router_child(const mqtt_router_t *router, uint8_t parent, const char *level, uint32_t levelLen);
+static uint8_t mqtt_router_walk(const mqtt_router_t *router, uint8_t parent,
+                                const char *topic, uint32_t topicLen, uint32_t pos);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+void mqtt_router_init(mqtt_router_t *router)
+{
+    memset(router, 0, sizeof(mqtt_router_t));
+
+    // the root, no level of its own
+    router->nodes[0].firstChild = MQTT_ROUTER_NONE;
+    router->nodes[0].nextSibling = MQTT_ROUTER_NONE;
+    router->nodes[0].route = MQTT_ROUTER_NONE;
+    router->nodeCount = 1;
+}
+
+
+/**
+ * add a topic filter, '+' and '#' are allowed as whole levels, '#' only as the last one
+ * the filter string must stay valid, the levels point into it
+ */
+bool mqtt_router_add(mqtt_router_t *router, const char *filter, mqtt_router_handler_t handler)
+{
+    uint32_t filterLen = strlen(filter);
+
+    if( filterLen == 0 || handler == NULL || router->routeCount >= MQTT_ROUTER_MAX_ROUTES ) {
+        return(false);
+    }
+
+    // check the wildcards first, nothing is added for an invalid filter
+    for( uint32_t pos = 0; pos < filterLen; pos++ ) {
+
+        if( filter[pos] != '+' && filter[pos] != '#' ) {
+            continue;
+        }
+
+        bool wholeLevel = (pos == 0 || filter[pos - 1] == '/') &&
+                          (pos + 1 == filterLen || filter[pos + 1] == '/');
+        if( !wholeLevel || (filter[pos] == '#' && pos + 1 != filterLen) ) {
+            return(false);
+        }
+    }
+
+    uint8_t node = 0;
+    uint32_t pos = 0;
+
+    while( true ) {
+
+        const char *slash = memchr(filter + pos, '/', filterLen - pos);
+        uint32_t end = slash != NULL ? (uint32_t) (slash - filter) : filterLen;
+        uint32_t levelLen = end - pos;
+
+        if( levelLen > UINT8_MAX ) {
+            return(false);
+        }
+
+        uint8_t child = mqtt_router_child(router, node, filter + pos, levelLen);
+        if( child == MQTT_ROUTER_NONE ) {
+
+            if( router->nodeCount >= MQTT_ROUTER_MAX_NODES ) {
+                return(false);
+            }
+
+            child = router->nodeCount++;
+            router->nodes[child].level = filter + pos;
+            router->nodes[child].levelLen = levelLen;
+            router->nodes[child].firstChild = MQTT_ROUTER_NONE;
+            router->nodes[child].nextSibling = router->nodes[node].firstChild;
+            router->nodes[child].route = MQTT_ROUTER_NONE;
+            router->nodes[node].firstChild = child;
+        }
+        node = child;
+
+        if( end == filterLen ) {
+            break;
+        }
+        pos = end + 1;
+    }
+
+    // the same filter twice
+    if( router->nodes[node].route != MQTT_ROUTER_NONE ) {
+        return(false);
+    }
+
+    router->nodes[node].route = router->routeCount;
+    router->handlers[router->routeCount++] = handler;
+
+    return(true);
+}
+
+
+/**
+ * the handler of the filter matching the topic, NULL if none
+ * the topic does not need to be null terminated
+ */
+mqtt_router_handler_t mqtt_router_match(const mqtt_router_t *router, const char *topic, uint32_t topicLen)
+{
+    uint8_t route = mqtt_router_walk(router, 0, topic, topicLen, 0);
+
+    if( route == MQTT_ROUTER_NONE ) {
+        return(NULL);
+    }
+
+    return(router->handlers[route]);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+static uint8_t mqtt_router_child(const mqtt_router_t *router, uint8_t parent, const char *level, uint32_t levelLen)
+{
+    for( uint8_t child = router->nodes[parent].firstChild; child != MQTT_ROUTER_NONE; child = router->nodes[child].nextSibling ) {
+
+        const mqtt_router_node_t *node = &router->nodes[child];
+        if( node->levelLen == levelLen && !memcmp(node->level, level, levelLen) ) {
+            return(child);
+        }
+    }
+
+    return(MQTT_ROUTER_NONE);
+}
+
+
+/**
+ * match the topic level at pos against the children of parent, and the rest below them
+ */
+static uint8_t mqtt_router_walk(const mqtt_router_t *router, uint8_t parent,
+                                const char *topic, uint32_t topicLen, uint32_t pos)
+{
+    const char *slash = memchr(topic + pos, '/', topicLen - pos);
+    uint32_t end = slash != NULL ? (uint32_t) (slash - topic) : topicLen;
+    bool wildcards = pos > 0 || topicLen == 0 || topic[0] != '$';
+
+    uint8_t candidates[2] = {
+        mqtt_router_child(router, parent, topic + pos, end - pos),
+        wildcards ? mqtt_router_child(router, parent, "+", 1) : MQTT_ROUTER_NONE,
+    };
+
+    for( uint8_t cIdx = 0; cIdx < 2; cIdx++ ) {
+
+        uint8_t child = candidates[cIdx];
+        if( child == MQTT_ROUTER_NONE ) {
+            continue;
+        }
+
+        uint8_t route;
+        if( end == topicLen ) {
+
+            // the last level, "a/#" also matches "a"
+            route = router->nodes[child].route;
+            if( route == MQTT_ROUTER_NONE ) {
+
+                uint8_t multi = mqtt_router_child(router, child, "#", 1);
+                if( multi != MQTT_ROUTER_NONE ) {
+                    route = router->nodes[multi].route;
+                }
+            }
+
+        } else {
+
+            route = mqtt_router_walk(router, child, topic, topicLen, end + 1);
+        }
+
+        if( route != MQTT_ROUTER_NONE ) {
+            return(route);
+        }
+    }
+
+    // '#' takes this level and everything below it
+    if( wildcards ) {
+
+        uint8_t multi = mqtt_router_child(router, parent, "#", 1);
+        if( multi != MQTT_ROUTER_NONE ) {
+            return(router->nodes[multi].route);
+        }
+    }
+
+    return(MQTT_ROUTER_NONE);
+}
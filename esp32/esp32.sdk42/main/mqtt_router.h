@@ -0,0 +1,49 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _MQTT_ROUTER_H_
+#define _MQTT_ROUTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mqtt_reasm.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define MQTT_ROUTER_MAX_NODES               32      // topic levels of all the filters
+#define MQTT_ROUTER_MAX_ROUTES              8
+#define MQTT_ROUTER_NONE                    0xff
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef void (*mqtt_router_handler_t)(const mqtt_reasm_msg_t *msg);
+
+// one topic level of a filter, the children of a node are a linked list
+typedef struct {
+    const char *level;                  // points into the filter, not null terminated
+    uint8_t levelLen;
+    uint8_t firstChild;
+    uint8_t nextSibling;
+    uint8_t route;                      // the route of a filter ending here
+} mqtt_router_node_t;
+
+typedef struct {
+    mqtt_router_node_t nodes[MQTT_ROUTER_MAX_NODES];    // nodes[0] is the root
+    uint8_t nodeCount;
+    mqtt_router_handler_t handlers[MQTT_ROUTER_MAX_ROUTES];
+    uint8_t routeCount;
+} mqtt_router_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void mqtt_router_init(mqtt_router_t *router);
+bool mqtt_router_add(mqtt_router_t *router, const char *filter, mqtt_router_handler_t handler);
+mqtt_router_handler_t mqtt_router_match(const mqtt_router_t *router, const char *topic, uint32_t topicLen);
+
+#endif
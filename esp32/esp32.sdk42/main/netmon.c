@@ -0,0 +1,324 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "netmon.h"
+
+static const char *TAG = "NETMON";
+
+// Note: the MQTT connection over time, for comparing sites and tuning the keepalive and
+//       the buffers. the MQTT task reports the connection events and the inbound messages,
+//       the ping is seen on the transport (mqtt_ping.c), the outbound messages are counted
+//       by whichever task publishes
+//
+//       the round trips, the connection times and the outages are kept in fixed-size rings,
+//       the summaries are over what the rings hold, the counters are since boot
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct {
+    uint32_t values[NETMON_HISTORY_SIZE];
+    uint8_t head;                       // the next to write
+    uint8_t count;
+    uint32_t total;                     // pushed since boot
+} netmon_ring_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static portMUX_TYPE netmon_mux = portMUX_INITIALIZER_UNLOCKED;
+static netmon_stats_t netmon_stats;     // the counters, the summaries are filled in on read
+static netmon_ring_t netmon_ping_ring;  // in us
+static netmon_ring_t netmon_connect_ring;       // in us
+static netmon_outage_t netmon_outages[NETMON_OUTAGE_SIZE];
+static uint8_t netmon_outage_head = 0;
+
+// the state of the connection, the MQTT task only
+static bool netmon_connected = false;
+static int64_t netmon_connect_start = 0;
+static int64_t netmon_ping_start = 0;  // 0 if no PINGREQ is waiting for its PINGRESP
+static bool netmon_error_pending = false;
+static netmon_reason_t netmon_error_reason = NETMON_REASON_CLOSED;
+static int32_t netmon_error_detail = 0;
+
+static const char *const netmon_topic_names[NETMON_TOPIC_COUNT] = {
+    "cmd", "phone", "group", "status", "presence", "other"
+};
+
+static const char *const netmon_reason_names[NETMON_REASON_COUNT] = {
+    "closed", "tls", "socket", "refused", "ping"
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static void netmon_ring_push(netmon_ring_t *ring, uint32_t value);
+static void netmon_ring_summary(const netmon_ring_t *ring, netmon_summary_t *summary);
+static void netmon_outage_add(netmon_reason_t reason, int32_t detail, bool failed);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+void netmon_init(void)
+{
+    memset(&netmon_stats, 0, sizeof(netmon_stats));
+    memset(&netmon_ping_ring, 0, sizeof(netmon_ping_ring));
+    memset(&netmon_connect_ring, 0, sizeof(netmon_connect_ring));
+    memset(netmon_outages, 0, sizeof(netmon_outages));
+    netmon_outage_head = 0;
+
+    netmon_connected = false;
+    netmon_connect_start = 0;
+    netmon_ping_start = 0;
+    netmon_error_pending = false;
+}
+
+
+/**
+ * MQTT_EVENT_BEFORE_CONNECT, the connection time starts here
+ */
+void netmon_mqtt_before_connect(void)
+{
+    netmon_connect_start = esp_timer_get_time();
+}
+
+
+void netmon_mqtt_connected(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&netmon_mux);
+    netmon_stats.connects++;
+    if( netmon_connect_start > 0 ) {
+        netmon_ring_push(&netmon_connect_ring, (uint32_t) (now - netmon_connect_start));
+    }
+    portEXIT_CRITICAL(&netmon_mux);
+
+    netmon_connected = true;
+    netmon_connect_start = 0;
+    netmon_ping_start = 0;
+    netmon_error_pending = false;
+}
+
+
+/**
+ * MQTT_EVENT_ERROR, a failed connection is an outage of its own, on a connection
+ * the error is the reason of the disconnection which follows
+ */
+void netmon_mqtt_error(netmon_reason_t reason, int32_t detail)
+{
+    if( netmon_connected ) {
+        netmon_error_pending = true;
+        netmon_error_reason = reason;
+        netmon_error_detail = detail;
+        return;
+    }
+
+    netmon_connect_start = 0;
+    netmon_outage_add(reason, detail, true);
+}
+
+
+/**
+ * MQTT_EVENT_DISCONNECTED, only the first one after a connection counts
+ */
+void netmon_mqtt_disconnected(void)
+{
+    if( !netmon_connected ) {
+        return;
+    }
+    netmon_connected = false;
+
+    netmon_reason_t reason = NETMON_REASON_CLOSED;
+    int32_t detail = 0;
+    if( netmon_error_pending ) {
+        reason = netmon_error_reason;
+        detail = netmon_error_detail;
+    } else if( netmon_ping_start > 0 ) {
+        reason = NETMON_REASON_PING;
+    }
+
+    if( netmon_ping_start > 0 ) {
+        portENTER_CRITICAL(&netmon_mux);
+        netmon_stats.pingsLost++;
+        portEXIT_CRITICAL(&netmon_mux);
+        netmon_ping_start = 0;
+    }
+    netmon_error_pending = false;
+
+    netmon_outage_add(reason, detail, false);
+
+    ESP_LOGI(TAG, "disconnected, %s %d", netmon_reason_names[reason], detail);
+}
+
+
+/**
+ * a PINGREQ went out, from the MQTT task
+ */
+void netmon_ping_sent(void)
+{
+    netmon_ping_start = esp_timer_get_time();
+}
+
+
+/**
+ * a PINGRESP came in, from the MQTT task
+ */
+void netmon_ping_received(void)
+{
+    if( netmon_ping_start == 0 ) {
+        return;
+    }
+
+    uint32_t rtt = (uint32_t) (esp_timer_get_time() - netmon_ping_start);
+    netmon_ping_start = 0;
+
+    portENTER_CRITICAL(&netmon_mux);
+    netmon_ring_push(&netmon_ping_ring, rtt);
+    portEXIT_CRITICAL(&netmon_mux);
+}
+
+
+/**
+ * an inbound fragment, from the MQTT task
+ *
+ * @param first the first fragment of the message
+ */
+void netmon_topic_in(netmon_topic_t topic, uint32_t bytes, bool first)
+{
+    portENTER_CRITICAL(&netmon_mux);
+    if( first ) {
+        netmon_stats.topics[topic].inMsgs++;
+    }
+    netmon_stats.topics[topic].inBytes += bytes;
+    portEXIT_CRITICAL(&netmon_mux);
+}
+
+
+/**
+ * an outbound message handed to the client, from any task
+ */
+void netmon_topic_out(netmon_topic_t topic, uint32_t bytes)
+{
+    portENTER_CRITICAL(&netmon_mux);
+    netmon_stats.topics[topic].outMsgs++;
+    netmon_stats.topics[topic].outBytes += bytes;
+    portEXIT_CRITICAL(&netmon_mux);
+}
+
+
+/**
+ * the counters, the summaries of the rings in ms and the outages, oldest first
+ */
+void netmon_get_stats(netmon_stats_t *stats)
+{
+    portENTER_CRITICAL(&netmon_mux);
+
+    *stats = netmon_stats;
+
+    netmon_ring_summary(&netmon_ping_ring, &stats->ping);
+    netmon_ring_summary(&netmon_connect_ring, &stats->connect);
+
+    for( uint8_t oIdx = 0; oIdx < stats->outageCount; oIdx++ ) {
+        stats->outages[oIdx] = netmon_outages[(netmon_outage_head + NETMON_OUTAGE_SIZE - stats->outageCount + oIdx) %
+                                              NETMON_OUTAGE_SIZE];
+    }
+
+    portEXIT_CRITICAL(&netmon_mux);
+}
+
+
+const char *netmon_topic_name(netmon_topic_t topic)
+{
+    return(topic < NETMON_TOPIC_COUNT ? netmon_topic_names[topic] : "");
+}
+
+
+const char *netmon_reason_name(netmon_reason_t reason)
+{
+    return(reason < NETMON_REASON_COUNT ? netmon_reason_names[reason] : "");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+// with netmon_mux held
+static void netmon_ring_push(netmon_ring_t *ring, uint32_t value)
+{
+    ring->values[ring->head] = value;
+    ring->head = (ring->head + 1) % NETMON_HISTORY_SIZE;
+    if( ring->count < NETMON_HISTORY_SIZE ) {
+        ring->count++;
+    }
+    ring->total++;
+}
+
+
+// with netmon_mux held, the values are in us, the summary in ms
+static void netmon_ring_summary(const netmon_ring_t *ring, netmon_summary_t *summary)
+{
+    memset(summary, 0, sizeof(netmon_summary_t));
+    summary->count = ring->total;
+
+    if( ring->count == 0 ) {
+        return;
+    }
+
+    uint64_t sum = 0;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    for( uint8_t vIdx = 0; vIdx < ring->count; vIdx++ ) {
+
+        uint32_t value = ring->values[vIdx];
+        sum += value;
+        if( value < min ) {
+            min = value;
+        }
+        if( value > max ) {
+            max = value;
+        }
+    }
+
+    summary->last = ring->values[(ring->head + NETMON_HISTORY_SIZE - 1) % NETMON_HISTORY_SIZE] / 1000;
+    summary->min = min / 1000;
+    summary->avg = (uint32_t) (sum / ring->count / 1000);
+    summary->max = max / 1000;
+}
+
+
+static void netmon_outage_add(netmon_reason_t reason, int32_t detail, bool failed)
+{
+    netmon_outage_t outage = {
+        .at = (uint32_t) (esp_timer_get_time() / 1000000),
+        .reason = reason,
+        .detail = detail,
+        .failed = failed
+    };
+
+    portENTER_CRITICAL(&netmon_mux);
+
+    if( failed ) {
+        netmon_stats.failed++;
+    } else {
+        netmon_stats.disconnects++;
+    }
+    netmon_stats.reasons[reason]++;
+
+    netmon_outages[netmon_outage_head] = outage;
+    netmon_outage_head = (netmon_outage_head + 1) % NETMON_OUTAGE_SIZE;
+    if( netmon_stats.outageCount < NETMON_OUTAGE_SIZE ) {
+        netmon_stats.outageCount++;
+    }
+
+    portEXIT_CRITICAL(&netmon_mux);
+}
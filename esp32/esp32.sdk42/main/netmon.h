@@ -0,0 +1,93 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _NETMON_H_
+#define _NETMON_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define NETMON_HISTORY_SIZE                 16      // the last ping round trips and connection times kept
+#define NETMON_OUTAGE_SIZE                  4       // the last disconnections and failed connections kept
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+// the topics by their role, the same keys on every device
+typedef enum {
+    NETMON_TOPIC_COMMAND = 0,           // OPEN_TLS_MQTT_TOPIC
+    NETMON_TOPIC_PHONE,                 // the sub-topics of the phones
+    NETMON_TOPIC_GROUP,                 // OPEN_TLS_MQTT_GROUP_TOPIC
+    NETMON_TOPIC_STATUS,                // the reports
+    NETMON_TOPIC_PRESENCE,              // the online state
+    NETMON_TOPIC_OTHER,
+    NETMON_TOPIC_COUNT
+} netmon_topic_t;
+
+typedef enum {
+    NETMON_REASON_CLOSED = 0,           // by the broker or the network, no error was given
+    NETMON_REASON_TLS,                  // esp-tls, detail is the esp_err_t
+    NETMON_REASON_SOCKET,               // detail is the errno
+    NETMON_REASON_REFUSED,              // CONNACK, detail is the return code
+    NETMON_REASON_PING,                 // no PINGRESP
+    NETMON_REASON_COUNT
+} netmon_reason_t;
+
+typedef struct {
+    uint32_t count;                     // since boot
+    uint32_t last;
+    uint32_t min;                       // over the kept ones
+    uint32_t avg;
+    uint32_t max;
+} netmon_summary_t;
+
+typedef struct {
+    uint32_t at;                        // in seconds since boot
+    netmon_reason_t reason;
+    int32_t detail;
+    bool failed;                        // a connection that never came up, else a disconnection
+} netmon_outage_t;
+
+typedef struct {
+    uint32_t inMsgs;
+    uint32_t inBytes;                   // payload only
+    uint32_t outMsgs;
+    uint32_t outBytes;
+} netmon_topic_stats_t;
+
+typedef struct {
+    uint32_t connects;
+    uint32_t disconnects;
+    uint32_t failed;                    // connections that never came up
+    uint32_t pingsLost;                 // PINGREQ with no PINGRESP before the disconnection
+    uint32_t reasons[NETMON_REASON_COUNT];
+    netmon_summary_t ping;              // in ms, PINGREQ to PINGRESP
+    netmon_summary_t connect;           // in ms, from the start of the connection to CONNACK
+    netmon_outage_t outages[NETMON_OUTAGE_SIZE];    // oldest first
+    uint8_t outageCount;
+    netmon_topic_stats_t topics[NETMON_TOPIC_COUNT];
+} netmon_stats_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void netmon_init(void);
+void netmon_mqtt_before_connect(void);
+void netmon_mqtt_connected(void);
+void netmon_mqtt_error(netmon_reason_t reason, int32_t detail);
+void netmon_mqtt_disconnected(void);
+void netmon_ping_sent(void);
+void netmon_ping_received(void);
+void netmon_topic_in(netmon_topic_t topic, uint32_t bytes, bool first);
+void netmon_topic_out(netmon_topic_t topic, uint32_t bytes);
+void netmon_get_stats(netmon_stats_t *stats);
+const char *netmon_topic_name(netmon_topic_t topic);
+const char *netmon_reason_name(netmon_reason_t reason);
+
+#endif
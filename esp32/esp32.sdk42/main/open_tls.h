@@ -27,6 +27,7 @@
 #define OPEN_TLS_IP_TYPE                    OPEN_TLS_IP_TYPE_DHCP
 #define OPEN_TLS_MQTT_BROKER                "mqtts://my-endpoint-ats.iot.amazonaws.com:8883"
 #define OPEN_TLS_MQTT_TOPIC                 "mycontrol/demo"
+// #define OPEN_TLS_MQTT_GROUP_TOPIC        "mycontrol/all"      // optional, commands to a group of devices
 #define OPEN_TLS_OTP_AES_KEY                "11223344556677889900aabbccddeeff"  // my AES key
 
 // If "OPEN_TLS_IP_TYPE_STATIC" is used, continue the configurations below
@@ -57,6 +58,15 @@
 // what is the time difference allowed when the command is received
 #define OPEN_TLS_CMD_OTP_TOLERANCE                5       // in seconds
 
+// the longest inbound MQTT message, a longer one is dropped
+// messages over 2 KB arrive in fragments and are rebuilt in a buffer of this size
+#define OPEN_TLS_MQTT_MAX_MSG_SIZE                (8 * 1024)  // in bytes
+
+// the TLS session is kept in RTC memory and resumed after a reconnect or a software reset
+// define this to also keep it in NVS, so it is resumed after a power cycle.
+// the session secret is then stored in flash, use it with flash encryption only
+// #define OPEN_TLS_TLS_SESSION_NVS
+
 ///////////////////////////////////////////////////////////////////////////////////
 // more defines
 #define T_DEVICE_WATCHDOG_TIMER_SEC       60
@@ -20,6 +20,7 @@
 #include "t_gpio.h"
 #include "t_nvs.h"
 #include "periodical.h"
+#include "sysmon.h"
 #include "version.h"
 #include "button.h"
 #include "cmd.h"
@@ -86,19 +87,34 @@ void app_main()
         ESP_LOGI(TAG, "ESP32 WiFiAddress %s <---------------------------------------------- SERIAL NUMBER", t_device_sn_str);
     }
 
+    // the last good time, so the broker connection does not wait for SNTP
+    app_wifi_time_restore();
+
     // init WiFi
     app_wifi_initialise();
 
     // sync time
-    // this blocks the task until the correct time is obtained
+    // this blocks the task until there is an IP address, SNTP then runs in the background
     app_wifi_ntp_init();
 
+    // with no time to check the broker certificate against, wait for it, a restored time
+    // is only provisional, so the first sync is not waited for then
+    if( !app_wifi_time_valid() ) {
+
+        // get the broker resolved and reached while SNTP is in flight anyway
+        app_wifi_preconnect(OPEN_TLS_MQTT_BROKER);
+        app_wifi_ntp_wait();
+    }
+
     // feed the watchdog of the main task
     esp_task_wdt_reset();
 
     // init periodical routings
     periodical_init();
 
+    // sample the tasks and the heap from now on
+    sysmon_init();
+
     // main task stack size check point A
     ESP_LOGI(TAG, "main task sshw (A) = %d", uxTaskGetStackHighWaterMark(NULL));
 
@@ -0,0 +1,261 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "mbedtls/aes.h"
+#include "esp32/rom/crc.h"
+
+#include "util.h"
+#include "otp.h"
+
+// Note: the replay set is kept by the caller, the command task keeps it in RTC memory,
+//       so an OTP accepted just before a watchdog or panic reboot cannot be replayed
+//       after it. Each entry carries its own CRC, so accepting an OTP seals 20 bytes,
+//       not the whole set. The expiries are on the wall clock, which the RTC keeps as well.
+//       A power cut loses both, and no OTP is verified before SNTP sets the time again
+//
+//       only the command task writes the set, the MQTT task may look an OTP up in it
+//       through otp_replay_seen(), so an entry is written and read under otp_replay_mux
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define OTP_REPLAY_MAGIC                    0x4F545052  // "OTPR"
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static portMUX_TYPE otp_replay_mux = portMUX_INITIALIZER_UNLOCKED;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static void otp_replay_restore(otp_replay_store_t *replay);
+static void otp_replay_seal(otp_replay_entry_t *entry);
+static otp_replay_entry_t *otp_replay_probe(otp_verifier_t *verifier, const uint8_t *otpAuth, uint32_t now, otp_replay_entry_t **freeSlot);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+/**
+ * convert the key string and set up the AES context once
+ *
+ * @param keyStr 32 hex digits
+ * @param tolerance in seconds, how far the OTP time may be from now, both ways
+ * @param replay the accepted OTPs, the sealed ones are kept
+ *
+ * @return false if the key string is not valid
+ */
+bool otp_verifier_init(otp_verifier_t *verifier, const char *keyStr, int32_t tolerance, otp_replay_store_t *replay)
+{
+    uint8_t aesKey[16];
+
+    esp_aes_init(&verifier->aes);
+    verifier->tolerance = tolerance;
+    verifier->ready = false;
+    verifier->replay = replay;
+    otp_replay_restore(replay);
+    memset(&verifier->stats, 0, sizeof(verifier->stats));
+
+    if( util_string_to_aes_key((char *) keyStr, aesKey) && esp_aes_setkey(&verifier->aes, aesKey, 128) == 0 ) {
+        verifier->ready = true;
+    }
+
+    // do not leave the key on the stack
+    memset(aesKey, 0, sizeof(aesKey));
+
+    return(verifier->ready);
+}
+
+
+void otp_verifier_free(otp_verifier_t *verifier)
+{
+    esp_aes_free(&verifier->aes);
+    verifier->ready = false;
+}
+
+
+/**
+ * reject a replayed OTP first, then decrypt it and check its checksum and its time
+ * an accepted OTP is remembered until it would fail the time check anyway
+ *
+ * @param otpAuth 16 encrypted bytes
+ * @param now current time
+ * @param plain the decrypted block, for logging, valid for OTP_VERIFY_CHECKSUM and OTP_VERIFY_TIME
+ */
+otp_verify_result_t otp_verify(otp_verifier_t *verifier, const uint8_t *otpAuth, time_t now, otp_plain_t *plain)
+{
+    if( !verifier->ready ) {
+        return(OTP_VERIFY_NO_KEY);
+    }
+
+    // a replay is rejected on the ciphertext, before any decryption
+    otp_replay_entry_t *freeSlot = NULL;
+    if( otp_replay_probe(verifier, otpAuth, (uint32_t) now, &freeSlot) != NULL ) {
+
+        verifier->stats.replayHits++;
+        return(OTP_VERIFY_REPLAY);
+    }
+
+    otp_verify_result_t result = otp_check(verifier, otpAuth, now, plain);
+    if( result != OTP_VERIFY_OK ) {
+        return(result);
+    }
+
+    if( freeSlot == NULL ) {
+
+        // fail closed, a valid OTP that cannot be remembered could be replayed
+        verifier->stats.replayFull++;
+        return(OTP_VERIFY_REPLAY_FULL);
+    }
+
+    // remember it until it would fail the time check anyway
+    portENTER_CRITICAL(&otp_replay_mux);
+    memcpy(freeSlot->otpAuth, otpAuth, sizeof(freeSlot->otpAuth));
+    freeSlot->expiry = plain->otpTime + verifier->tolerance + 1;
+    otp_replay_seal(freeSlot);
+    portEXIT_CRITICAL(&otp_replay_mux);
+    verifier->stats.replayMisses++;
+
+    return(OTP_VERIFY_OK);
+}
+
+/**
+ * decrypt the OTP and check its checksum and its time, the replay set is not looked at
+ * the verifier is only read, the hardware AES is locked per block, so another task
+ * may check while the command task verifies
+ *
+ * @param plain the decrypted block, valid for OTP_VERIFY_CHECKSUM and OTP_VERIFY_TIME
+ */
+otp_verify_result_t otp_check(otp_verifier_t *verifier, const uint8_t *otpAuth, time_t now, otp_plain_t *plain)
+{
+    if( !verifier->ready ) {
+        return(OTP_VERIFY_NO_KEY);
+    }
+
+    uint8_t *plainText = (uint8_t *) plain;
+
+    esp_aes_crypt_ecb(&verifier->aes, ESP_AES_DECRYPT, otpAuth, plainText);
+
+    // the last byte is the sum of the others
+    uint8_t checksum = 0;
+    for( uint8_t pIdx = 0; pIdx < 15; pIdx++ ) {
+        checksum += plainText[pIdx];
+    }
+
+    if( checksum != plain->checksum ) {
+        return(OTP_VERIFY_CHECKSUM);
+    }
+
+    // in 64 bits, the time of a broken OTP is anything
+    int64_t timeDiff = (int64_t) now - (int64_t) plain->otpTime;
+    if( timeDiff > verifier->tolerance || timeDiff < -verifier->tolerance ) {
+        return(OTP_VERIFY_TIME);
+    }
+
+    return(OTP_VERIFY_OK);
+}
+
+
+/**
+ * whether the OTP was accepted before and is still remembered, the set is only read
+ * another task may look it up while the command task verifies
+ *
+ * @param otpAuth 16 encrypted bytes
+ * @param now current time
+ */
+bool otp_replay_seen(otp_verifier_t *verifier, const uint8_t *otpAuth, time_t now)
+{
+    otp_replay_entry_t *freeSlot = NULL;
+
+    portENTER_CRITICAL(&otp_replay_mux);
+    bool seen = otp_replay_probe(verifier, otpAuth, (uint32_t) now, &freeSlot) != NULL;
+    portEXIT_CRITICAL(&otp_replay_mux);
+
+    return(seen);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+/**
+ * keep the entries sealed before a reboot, start empty on a power-on
+ * a broken entry is marked expired rather than unused, so the probing still goes past it
+ */
+static void otp_replay_restore(otp_replay_store_t *replay)
+{
+    if( replay->magic != OTP_REPLAY_MAGIC ) {
+
+        memset(replay, 0, sizeof(otp_replay_store_t));
+        replay->magic = OTP_REPLAY_MAGIC;
+        for( uint32_t eIdx = 0; eIdx < OTP_REPLAY_SIZE; eIdx++ ) {
+            otp_replay_seal(&replay->entries[eIdx]);
+        }
+        return;
+    }
+
+    for( uint32_t eIdx = 0; eIdx < OTP_REPLAY_SIZE; eIdx++ ) {
+
+        otp_replay_entry_t *entry = &replay->entries[eIdx];
+        if( entry->crc != crc32_le(0, (const uint8_t *) entry, offsetof(otp_replay_entry_t, crc)) ) {
+
+            memset(entry->otpAuth, 0, sizeof(entry->otpAuth));
+            entry->expiry = 1;
+            otp_replay_seal(entry);
+        }
+    }
+}
+
+
+static void otp_replay_seal(otp_replay_entry_t *entry)
+{
+    entry->crc = crc32_le(0, (const uint8_t *) entry, offsetof(otp_replay_entry_t, crc));
+}
+
+
+/**
+ * open addressing with linear probing over at most OTP_REPLAY_MAX_PROBE slots
+ * expired slots are reused, but the probing does not stop at them
+ *
+ * @param freeSlot the first expired or unused slot, NULL if none
+ *
+ * @return the live entry of this OTP, NULL if not found
+ */
+static otp_replay_entry_t *otp_replay_probe(otp_verifier_t *verifier, const uint8_t *otpAuth, uint32_t now, otp_replay_entry_t **freeSlot)
+{
+    // the ciphertext is already uniformly distributed
+    uint32_t hash;
+    memcpy(&hash, otpAuth, sizeof(hash));
+
+    for( uint32_t probe = 0; probe < OTP_REPLAY_MAX_PROBE; probe++ ) {
+
+        otp_replay_entry_t *entry = &verifier->replay->entries[(hash + probe) & (OTP_REPLAY_SIZE - 1)];
+
+        if( entry->expiry > now ) {
+
+            if( memcmp(entry->otpAuth, otpAuth, sizeof(entry->otpAuth)) == 0 ) {
+                return(entry);
+            }
+
+        } else {
+
+            if( *freeSlot == NULL ) {
+                *freeSlot = entry;
+            }
+
+            // nothing was ever stored past a slot that was never used
+            if( entry->expiry == 0 ) {
+                break;
+            }
+        }
+    }
+
+    return(NULL);
+}
+
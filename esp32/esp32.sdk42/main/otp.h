@@ -0,0 +1,79 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _OTP_H_
+#define _OTP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "mbedtls/aes.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define OTP_REPLAY_SIZE                     64      // accepted OTPs remembered, power of 2
+#define OTP_REPLAY_MAX_PROBE                16      // slots looked at per lookup
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef enum {
+    OTP_VERIFY_OK = 0,
+    OTP_VERIFY_NO_KEY,                  // the verifier has no valid key
+    OTP_VERIFY_CHECKSUM,                // decrypted, but the checksum does not match
+    OTP_VERIFY_TIME,                    // the OTP time is out of the tolerance
+    OTP_VERIFY_REPLAY,                  // the same OTP was accepted before
+    OTP_VERIFY_REPLAY_FULL              // valid, but there is no room to remember it
+} otp_verify_result_t;
+
+// the decrypted OTP block
+typedef struct {
+    uint32_t random1;
+    uint32_t otpTime;
+    uint32_t random3;
+    uint8_t random4[3];
+    uint8_t checksum;
+} otp_plain_t;
+
+// an accepted OTP, kept until its time leaves the tolerance
+typedef struct {
+    uint8_t otpAuth[16];
+    uint32_t expiry;                    // 0 if the slot was never used
+    uint32_t crc;                       // over everything above
+} otp_replay_entry_t;
+
+// the accepted OTPs, each sealed on its own so that the set can be kept in RTC memory
+typedef struct {
+    uint32_t magic;
+    otp_replay_entry_t entries[OTP_REPLAY_SIZE];
+} otp_replay_store_t;
+
+typedef struct {
+    uint32_t replayHits;                // replays rejected
+    uint32_t replayMisses;              // first use, remembered
+    uint32_t replayFull;                // rejected, no free slot
+} otp_stats_t;
+
+// built once, then used for every command
+typedef struct {
+    esp_aes_context aes;                // holds the expanded key
+    bool ready;
+    int32_t tolerance;                  // in seconds, both ways
+    otp_replay_store_t *replay;         // owned by the caller
+    otp_stats_t stats;
+} otp_verifier_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+bool otp_verifier_init(otp_verifier_t *verifier, const char *keyStr, int32_t tolerance, otp_replay_store_t *replay);
+void otp_verifier_free(otp_verifier_t *verifier);
+otp_verify_result_t otp_verify(otp_verifier_t *verifier, const uint8_t *otpAuth, time_t now, otp_plain_t *plain);
+otp_verify_result_t otp_check(otp_verifier_t *verifier, const uint8_t *otpAuth, time_t now, otp_plain_t *plain);
+bool otp_replay_seen(otp_verifier_t *verifier, const uint8_t *otpAuth, time_t now);
+
+#endif
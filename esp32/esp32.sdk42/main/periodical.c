@@ -9,83 +9,319 @@
 
 #include <string.h>
 #include <stdlib.h>
-#include <time.h>
+#include <stdbool.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_int_wdt.h"
 #include "esp_task_wdt.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 
 #include "app_wifi.h"
 #include "open_tls.h"
 #include "mqtt.h"
 #include "periodical.h"
+#include "t_gpio.h"
 
 static const char *TAG = "PERIODICAL";
 
+// Note: the periodic jobs of the gpio task. a module registers its job with a period and
+//       a priority, and the job then runs in the gpio task once per period, the first
+//       time one period after it is registered. the due jobs run one at a time, the
+//       highest priority first, and each run is timed against its due time on the
+//       esp_timer clock, so an SNTP step does not move them
+//
+//       a run which ends after the next due time is an overrun, the missed periods are
+//       skipped rather than run back to back
+
 ///////////////////////////////////////////////////////////////////////////////////
 // defines
 #define PERIODICAL_NTP_ADJUST_INTERVAL              21600   // time is crital, regularly re-calibrate time
 #define PERIODICAL_DEVICE_STATUS_REPORT             600     // in seconds
+#define PERIODICAL_IDLE_WAIT                        3600000 // in ms, with no job registered
+
+#define PERIODICAL_PRIORITY_NTP                     2
+#define PERIODICAL_PRIORITY_DEVICE_STATUS_REPORT    1
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct {
+    periodical_job_t job;
+    uint8_t priority;
+    int64_t due;                        // in us, esp_timer clock
+    periodical_stats_t stats;
+} periodical_entry_t;
 
 ///////////////////////////////////////////////////////////////////////////////////
 // local variables
-static time_t periodical_initialized = false;
-static time_t periodical_last_ntp_request = 0;
-static time_t periodical_last_device_status_report = 0;
+static periodical_entry_t periodical_jobs[PERIODICAL_MAX_JOBS];
+static uint8_t periodical_job_count = 0;
+static portMUX_TYPE periodical_mux = portMUX_INITIALIZER_UNLOCKED;     // the due times and the count
+
+static int8_t periodical_report_job = -1;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local functions
+static void periodical_ntp_job(void);
+static void periodical_report(void);
+static int8_t periodical_next_due(int64_t now, int64_t *due);
+static void periodical_run(periodical_entry_t *entry);
 
 ///////////////////////////////////////////////////////////////////////////////////
 // public function implementations
 
 /**
- *  Initial the low-priority periodical module
+ *  Initial the low-priority periodical module with its own jobs
  */
 void periodical_init(void)
 {
-    // already init periodical
-    periodical_initialized = true;
+    // the first one is skipped since the time was just obtained
+    periodical_register("ntp", PERIODICAL_NTP_ADJUST_INTERVAL * 1000, PERIODICAL_PRIORITY_NTP, periodical_ntp_job);
+
+    // the first report is made when MQTT gets connected, see periodical_mqtt_connected()
+    periodical_report_job = periodical_register("report", PERIODICAL_DEVICE_STATUS_REPORT * 1000,
+                                                PERIODICAL_PRIORITY_DEVICE_STATUS_REPORT, periodical_report);
+}
+
+
+/**
+ * Add a job, from any task
+ *
+ * @param name kept as is, for the stats
+ * @param period in ms
+ * @param priority the higher runs first when more than one job is due
+ * @param job performed by the gpio task
+ *
+ * @return the job id, -1 if there is no room
+ */
+int8_t periodical_register(const char *name, uint32_t period, uint8_t priority, periodical_job_t job)
+{
+    int8_t jobId = -1;
+
+    portENTER_CRITICAL(&periodical_mux);
+
+    if( periodical_job_count < PERIODICAL_MAX_JOBS ) {
+
+        jobId = periodical_job_count;
+
+        periodical_entry_t *entry = &periodical_jobs[jobId];
+        memset(entry, 0, sizeof(periodical_entry_t));
+        entry->job = job;
+        entry->priority = priority;
+        entry->due = esp_timer_get_time() + (int64_t) period * 1000;
+        entry->stats.name = name;
+        entry->stats.period = period;
+
+        periodical_job_count++;
+    }
+
+    portEXIT_CRITICAL(&periodical_mux);
+
+    if( jobId < 0 ) {
+        ESP_LOGE(TAG, "no room for job %s", name);
+        return(-1);
+    }
+
+    // the gpio task sleeps until the first job is due
+    t_gpio_notify(T_GPIO_EVENT_PERIODICAL);
+
+    return(jobId);
+}
+
+
+/**
+ * Make a job due at once, from any task
+ */
+void periodical_trigger(int8_t jobId)
+{
+    if( jobId < 0 || jobId >= periodical_job_count ) {
+        return;
+    }
+
+    portENTER_CRITICAL(&periodical_mux);
+    periodical_jobs[jobId].due = esp_timer_get_time();
+    portEXIT_CRITICAL(&periodical_mux);
+
+    t_gpio_notify(T_GPIO_EVENT_PERIODICAL);
+}
+
+
+/**
+ * The device report right after the MQTT connection
+ */
+void periodical_mqtt_connected(void)
+{
+    periodical_trigger(periodical_report_job);
 }
 
 
 /**
  * this function is performed by the gpio task, so the other task functions
  * can impact the timing of this function
+ *
+ * @return ms until the next job is due
  */
-void periodical_perform(void)
+uint32_t periodical_perform(void)
 {
-    time_t currentTime;
+    int64_t now = esp_timer_get_time();
+    int64_t due = 0;
+    int8_t jobId;
 
-    if( !periodical_initialized ) {
-        return;
+    // the due jobs, the highest priority first
+    while( (jobId = periodical_next_due(now, &due)) >= 0 && due <= now ) {
+
+        periodical_run(&periodical_jobs[jobId]);
+
+        // feed the dog in case the job took too much time
+        esp_task_wdt_reset();
+        now = esp_timer_get_time();
+    }
+
+    if( jobId < 0 ) {
+        return(PERIODICAL_IDLE_WAIT);
     }
 
-    // get current time
-    time(&currentTime);
-
-    // time is critical, time calibration is needed regularly
-    if( periodical_last_ntp_request == 0 ) {
-        // skip the first one since the time was just obtained
-        periodical_last_ntp_request = currentTime;
-    } else if( (currentTime - periodical_last_ntp_request) > PERIODICAL_NTP_ADJUST_INTERVAL ) {
-        // send NTP request
-        // Note: NTP does not impact MQTT, so not need to stop MQTT
-        app_wifi_ntp_request();
-        periodical_last_ntp_request = currentTime;
-        ESP_LOGI(TAG, "perform time recalibration");
+    return((uint32_t) ((due - now + 999) / 1000));
+}
+
+
+/**
+ * Copy the figures of every job
+ *
+ * @return number of jobs copied
+ */
+uint8_t periodical_get_stats(periodical_stats_t *stats, uint8_t maxJobs)
+{
+    portENTER_CRITICAL(&periodical_mux);
+
+    uint8_t count = periodical_job_count < maxJobs ? periodical_job_count : maxJobs;
+    for( uint8_t jIdx = 0; jIdx < count; jIdx++ ) {
+        stats[jIdx] = periodical_jobs[jIdx].stats;
     }
 
-    // make sure the device report is performed periodically
-    if( mqtt_connected() &&
-        (currentTime - periodical_last_device_status_report ) > PERIODICAL_DEVICE_STATUS_REPORT ) {
+    portEXIT_CRITICAL(&periodical_mux);
+
+    return(count);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+// time is critical, time calibration is needed regularly
+static void periodical_ntp_job(void)
+{
+    // send NTP request
+    // Note: NTP does not impact MQTT, so not need to stop MQTT
+    app_wifi_ntp_request();
+    ESP_LOGI(TAG, "perform time recalibration");
+}
+
+
+// make sure the device report is performed periodically
+static void periodical_report(void)
+{
+    if( mqtt_connected() ) {
 
         ESP_LOGI(TAG, "perform periodical device status report");
 
         // perform the device status report
         mqtt_proceed_device_report();
+    }
+}
+
+
+/**
+ * the job to run next: the earliest due among those due by now, the highest priority first,
+ * or the earliest due if none is
+ *
+ * @param due set to the due time of that job
+ *
+ * @return the job id, -1 if there is no job
+ */
+static int8_t periodical_next_due(int64_t now, int64_t *due)
+{
+    int8_t next = -1;
 
-        // track the current time
-        periodical_last_device_status_report = currentTime;
+    portENTER_CRITICAL(&periodical_mux);
+
+    for( uint8_t jIdx = 0; jIdx < periodical_job_count; jIdx++ ) {
+
+        const periodical_entry_t *entry = &periodical_jobs[jIdx];
+
+        if( next < 0 ) {
+            next = jIdx;
+            continue;
+        }
+
+        const periodical_entry_t *best = &periodical_jobs[next];
+        bool entryDue = (entry->due <= now);
+        bool bestDue = (best->due <= now);
+
+        if( entryDue != bestDue ) {
+            if( entryDue ) {
+                next = jIdx;
+            }
+        } else if( entryDue ? (entry->priority > best->priority ||
+                               (entry->priority == best->priority && entry->due < best->due))
+                            : (entry->due < best->due) ) {
+            next = jIdx;
+        }
+    }
+
+    if( next >= 0 ) {
+        *due = periodical_jobs[next].due;
     }
+
+    portEXIT_CRITICAL(&periodical_mux);
+
+    return(next);
 }
 
+
+/**
+ * run the job, time it against its due time, then set the next due time
+ */
+static void periodical_run(periodical_entry_t *entry)
+{
+    portENTER_CRITICAL(&periodical_mux);
+    int64_t due = entry->due;
+    portEXIT_CRITICAL(&periodical_mux);
+
+    int64_t start = esp_timer_get_time();
+    entry->job();
+    int64_t end = esp_timer_get_time();
+
+    int64_t period = (int64_t) entry->stats.period * 1000;
+    int64_t next = due + period;
+    bool overrun = false;
+    if( end >= next ) {
+        // skip the missed periods
+        next += ((end - next) / period + 1) * period;
+        overrun = true;
+    }
+
+    portENTER_CRITICAL(&periodical_mux);
+
+    // a trigger during the run is kept
+    if( entry->due == due ) {
+        entry->due = next;
+    }
+
+    periodical_stats_t *stats = &entry->stats;
+    stats->runs++;
+    stats->lastRuntime = (uint32_t) (end - start);
+    stats->lastLateness = (uint32_t) (start - due);
+    if( stats->lastRuntime > stats->maxRuntime ) {
+        stats->maxRuntime = stats->lastRuntime;
+    }
+    if( stats->lastLateness > stats->maxLateness ) {
+        stats->maxLateness = stats->lastLateness;
+    }
+    if( overrun ) {
+        stats->overruns++;
+    }
+
+    portEXIT_CRITICAL(&periodical_mux);
+}
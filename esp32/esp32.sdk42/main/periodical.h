@@ -10,9 +10,34 @@
 #ifndef _PERIODICAL_H_
 #define _PERIODICAL_H_
 
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define PERIODICAL_MAX_JOBS                 8
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef void (*periodical_job_t)(void);
+
+typedef struct {
+    const char *name;
+    uint32_t period;                    // in ms
+    uint32_t runs;                      // since boot
+    uint32_t lastRuntime;               // in us
+    uint32_t maxRuntime;                // in us
+    uint32_t lastLateness;              // in us, from the due time to the start
+    uint32_t maxLateness;               // in us
+    uint32_t overruns;                  // runs which ended after the next due time, the missed periods are skipped
+} periodical_stats_t;
+
 ///////////////////////////////////////////////////////////////////////////////////
 // public function
 void periodical_init(void);
-void periodical_perform(void);
+int8_t periodical_register(const char *name, uint32_t period, uint8_t priority, periodical_job_t job);
+void periodical_trigger(int8_t jobId);
+void periodical_mqtt_connected(void);
+uint32_t periodical_perform(void);
+uint8_t periodical_get_stats(periodical_stats_t *stats, uint8_t maxJobs);
 
 #endif
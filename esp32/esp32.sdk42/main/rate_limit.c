@@ -0,0 +1,234 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "esp_timer.h"
+
+#include "rate_limit.h"
+
+// Note: token buckets in front of the inbound message handling, called from the MQTT task only
+//       a message needs a token from its sender's bucket, then one from the global bucket
+//       a flooding sender empties its own bucket and is dropped there, without using up
+//       the global tokens the other senders need
+//
+//       the sender is only the topic, which a flooder chooses. A new topic starts with a
+//       single token, so rotating topics gains no burst, but it still takes the global
+//       tokens, and a flood on a phone's own topic empties that phone's bucket. A command
+//       dropped here gets a second chance: on a token of the check bucket, taken before
+//       anything is parsed, the MQTT task checks its OTP and lets it through on a token of
+//       the verified bucket, which no junk message and no replay can take. A flood faster
+//       than the check bucket leaves the commands on its topics to chance, but costs no
+//       more than RATE_LIMIT_CHECK_RATE OTP checks per second
+//
+//       the drop path does no logging and no allocation, only the counters
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define RATE_LIMIT_TOKEN                    1000    // the buckets count in 1/1000 token
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct {
+    uint32_t tokens;                    // in 1/1000 token
+    int64_t lastRefill;                 // in us
+} rate_limit_bucket_t;
+
+typedef struct {
+    uint32_t hash;                      // 0 if the slot is free
+    int64_t lastSeen;                   // in us, the least recently seen sender is replaced
+    rate_limit_bucket_t bucket;
+} rate_limit_sender_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static rate_limit_sender_t rate_limit_senders[RATE_LIMIT_SENDERS];
+static rate_limit_bucket_t rate_limit_global;
+static rate_limit_bucket_t rate_limit_check;
+static rate_limit_bucket_t rate_limit_verified;
+static rate_limit_stats_t rate_limit_stats;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static uint32_t rate_limit_hash(const char *sender, uint32_t senderLen);
+static rate_limit_sender_t *rate_limit_find_sender(uint32_t hash, int64_t now);
+static void rate_limit_refill(rate_limit_bucket_t *bucket, int64_t now, uint32_t rate, uint32_t burst);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+/**
+ * the global, the check and the verified buckets start full
+ */
+void rate_limit_init(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    memset(rate_limit_senders, 0, sizeof(rate_limit_senders));
+    memset(&rate_limit_stats, 0, sizeof(rate_limit_stats));
+
+    rate_limit_global.tokens = RATE_LIMIT_GLOBAL_BURST * RATE_LIMIT_TOKEN;
+    rate_limit_global.lastRefill = now;
+    rate_limit_check.tokens = RATE_LIMIT_CHECK_BURST * RATE_LIMIT_TOKEN;
+    rate_limit_check.lastRefill = now;
+    rate_limit_verified.tokens = RATE_LIMIT_VERIFIED_BURST * RATE_LIMIT_TOKEN;
+    rate_limit_verified.lastRefill = now;
+}
+
+
+/**
+ * take a token for one message
+ *
+ * @param sender what tells the senders apart, MQTT 3.1.1 gives only the topic
+ *
+ * @return false if the message is to be dropped
+ */
+bool rate_limit_admit(const char *sender, uint32_t senderLen)
+{
+    int64_t now = esp_timer_get_time();
+    rate_limit_sender_t *senderSlot = rate_limit_find_sender(rate_limit_hash(sender, senderLen), now);
+
+    rate_limit_refill(&senderSlot->bucket, now, RATE_LIMIT_SENDER_RATE, RATE_LIMIT_SENDER_BURST);
+    if( senderSlot->bucket.tokens < RATE_LIMIT_TOKEN ) {
+
+        rate_limit_stats.droppedSender++;
+        return(false);
+    }
+
+    rate_limit_refill(&rate_limit_global, now, RATE_LIMIT_GLOBAL_RATE, RATE_LIMIT_GLOBAL_BURST);
+    if( rate_limit_global.tokens < RATE_LIMIT_TOKEN ) {
+
+        rate_limit_stats.droppedGlobal++;
+        return(false);
+    }
+
+    senderSlot->bucket.tokens -= RATE_LIMIT_TOKEN;
+    rate_limit_global.tokens -= RATE_LIMIT_TOKEN;
+    rate_limit_stats.admitted++;
+
+    return(true);
+}
+
+
+/**
+ * take a token to check the OTP of a message rate_limit_admit() dropped, before it is parsed
+ *
+ * @return false if the message is to be dropped without looking at it
+ */
+bool rate_limit_admit_check(void)
+{
+    rate_limit_refill(&rate_limit_check, esp_timer_get_time(), RATE_LIMIT_CHECK_RATE, RATE_LIMIT_CHECK_BURST);
+    if( rate_limit_check.tokens < RATE_LIMIT_TOKEN ) {
+        return(false);
+    }
+
+    rate_limit_check.tokens -= RATE_LIMIT_TOKEN;
+    rate_limit_stats.checked++;
+
+    return(true);
+}
+
+
+/**
+ * take a token for a message rate_limit_admit() dropped, once its OTP is found valid
+ *
+ * @return false if the message is to be dropped after all
+ */
+bool rate_limit_admit_verified(void)
+{
+    rate_limit_refill(&rate_limit_verified, esp_timer_get_time(), RATE_LIMIT_VERIFIED_RATE, RATE_LIMIT_VERIFIED_BURST);
+    if( rate_limit_verified.tokens < RATE_LIMIT_TOKEN ) {
+        return(false);
+    }
+
+    rate_limit_verified.tokens -= RATE_LIMIT_TOKEN;
+    rate_limit_stats.verified++;
+
+    return(true);
+}
+
+
+void rate_limit_get_stats(rate_limit_stats_t *stats)
+{
+    *stats = rate_limit_stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+/**
+ * FNV-1a, never 0 so 0 can mark a free slot
+ */
+static uint32_t rate_limit_hash(const char *sender, uint32_t senderLen)
+{
+    uint32_t hash = 2166136261u;
+
+    for( uint32_t cIdx = 0; cIdx < senderLen; cIdx++ ) {
+
+        hash ^= (uint8_t) sender[cIdx];
+        hash *= 16777619u;
+    }
+
+    return(hash != 0 ? hash : 1);
+}
+
+
+/**
+ * the sender's slot, or the least recently seen one given to it with RATE_LIMIT_SENDER_START tokens
+ * Note: two senders with the same hash share a bucket
+ */
+static rate_limit_sender_t *rate_limit_find_sender(uint32_t hash, int64_t now)
+{
+    rate_limit_sender_t *oldest = &rate_limit_senders[0];
+
+    for( uint8_t sIdx = 0; sIdx < RATE_LIMIT_SENDERS; sIdx++ ) {
+
+        rate_limit_sender_t *slot = &rate_limit_senders[sIdx];
+
+        if( slot->hash == hash ) {
+
+            slot->lastSeen = now;
+            return(slot);
+        }
+
+        if( slot->hash == 0 || (oldest->hash != 0 && slot->lastSeen < oldest->lastSeen) ) {
+            oldest = slot;
+        }
+    }
+
+    oldest->hash = hash;
+    oldest->lastSeen = now;
+    oldest->bucket.tokens = RATE_LIMIT_SENDER_START * RATE_LIMIT_TOKEN;
+    oldest->bucket.lastRefill = now;
+
+    return(oldest);
+}
+
+
+static void rate_limit_refill(rate_limit_bucket_t *bucket, int64_t now, uint32_t rate, uint32_t burst)
+{
+    // rate tokens per second is rate / 1000 of a 1/1000 token per us
+    int64_t refill = (now - bucket->lastRefill) * rate / 1000;
+
+    if( refill <= 0 ) {
+        return;
+    }
+
+    // keep the remainder of the time not converted to tokens yet
+    bucket->lastRefill += refill * 1000 / rate;
+
+    uint64_t tokens = (uint64_t) bucket->tokens + (uint64_t) refill;
+    if( tokens >= (uint64_t) burst * RATE_LIMIT_TOKEN ) {
+
+        tokens = (uint64_t) burst * RATE_LIMIT_TOKEN;
+        bucket->lastRefill = now;
+    }
+    bucket->tokens = (uint32_t) tokens;
+}
@@ -0,0 +1,47 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _RATE_LIMIT_H_
+#define _RATE_LIMIT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define RATE_LIMIT_SENDERS                  8       // senders tracked at once
+#define RATE_LIMIT_SENDER_RATE              4       // messages per second, per sender
+#define RATE_LIMIT_SENDER_BURST             8
+#define RATE_LIMIT_SENDER_START             1       // tokens of a sender not seen, or seen too long ago
+#define RATE_LIMIT_GLOBAL_RATE              16      // messages per second, all senders
+#define RATE_LIMIT_GLOBAL_BURST             32
+#define RATE_LIMIT_CHECK_RATE               64      // messages per second, over the limits, whose OTP is checked
+#define RATE_LIMIT_CHECK_BURST              16
+#define RATE_LIMIT_VERIFIED_RATE            2       // messages per second, over the limits but with a valid OTP
+#define RATE_LIMIT_VERIFIED_BURST           4
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef struct {
+    uint32_t admitted;
+    uint32_t droppedSender;             // over the sender's own rate
+    uint32_t droppedGlobal;             // within the sender's rate, but over the global rate
+    uint32_t checked;                   // of the dropped ones, the OTP checked
+    uint32_t verified;                  // of the checked ones, let through on a valid OTP
+} rate_limit_stats_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void rate_limit_init(void);
+bool rate_limit_admit(const char *sender, uint32_t senderLen);
+bool rate_limit_admit_check(void);
+bool rate_limit_admit_verified(void);
+void rate_limit_get_stats(rate_limit_stats_t *stats);
+
+#endif
@@ -0,0 +1,218 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+
+#include "open_tls.h"
+#include "relay.h"
+
+static const char *TAG = "RELAY";
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef enum {
+    RELAY_STATE_IDLE = 0,
+    RELAY_STATE_PULSE,                  // a relay is on, the timer turns it off
+    RELAY_STATE_GAP                     // the timer starts the next pending pulse
+} relay_state_t;
+
+typedef struct {
+    gpio_num_t gpio;
+    latency_stamps_t stamps;
+} relay_pending_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static esp_timer_handle_t relay_timer = NULL;
+static portMUX_TYPE relay_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static relay_state_t relay_state = RELAY_STATE_IDLE;
+static gpio_num_t relay_active_gpio = GPIO_NUM_NC;
+
+// pending pulses, the relays are never on at the same time
+static relay_pending_t relay_pending[RELAY_PENDING_SIZE];
+static uint8_t relay_pending_head = 0;
+static uint8_t relay_pending_count = 0;
+
+static relay_stats_t relay_stats;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static void relay_timer_callback(void *arg);
+static void relay_start_pulse(const relay_pending_t *pulse);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+/**
+ * create the one-shot timer that ends the relay pulses
+ */
+void relay_init(void)
+{
+    // vars init
+    relay_state = RELAY_STATE_IDLE;
+    relay_pending_head = 0;
+    relay_pending_count = 0;
+    memset(&relay_stats, 0, sizeof(relay_stats));
+
+    const esp_timer_create_args_t timerArgs = {
+        .callback = relay_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "relay"
+    };
+
+    if( esp_timer_create(&timerArgs, &relay_timer) != ESP_OK ) {
+
+        ESP_LOGE(TAG, "unable to create relay timer");
+    }
+}
+
+
+/**
+ * start a relay pulse without blocking the caller
+ * if another pulse is in progress, this one starts after it
+ *
+ * @param gpio relay output
+ * @param stamps the command's stage times, recorded at the rising edge
+ *
+ * @return false if the pulse is dropped
+ */
+bool relay_pulse(gpio_num_t gpio, const latency_stamps_t *stamps)
+{
+    relay_pending_t pulse = { .gpio = gpio, .stamps = *stamps };
+    bool accepted = true;
+    bool startNow = false;
+
+    if( relay_timer == NULL ) {
+        return(false);
+    }
+
+    portENTER_CRITICAL(&relay_mux);
+
+    if( relay_state == RELAY_STATE_IDLE ) {
+
+        relay_state = RELAY_STATE_PULSE;
+        startNow = true;
+
+    } else if( relay_pending_count < RELAY_PENDING_SIZE ) {
+
+        relay_pending[(relay_pending_head + relay_pending_count) % RELAY_PENDING_SIZE] = pulse;
+        relay_pending_count++;
+
+    } else {
+
+        relay_stats.dropped++;
+        accepted = false;
+    }
+
+    portEXIT_CRITICAL(&relay_mux);
+
+    if( startNow ) {
+        relay_start_pulse(&pulse);
+    } else if( !accepted ) {
+        ESP_LOGE(TAG, "too many pending pulses, gpio %d dropped", gpio);
+    }
+
+    return(accepted);
+}
+
+
+void relay_get_stats(relay_stats_t *stats)
+{
+    portENTER_CRITICAL(&relay_mux);
+    *stats = relay_stats;
+    portEXIT_CRITICAL(&relay_mux);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+/**
+ * turn the relay on and arm the timer to turn it off
+ */
+static void relay_start_pulse(const relay_pending_t *pulse)
+{
+    portENTER_CRITICAL(&relay_mux);
+    relay_active_gpio = pulse->gpio;
+    portEXIT_CRITICAL(&relay_mux);
+
+    gpio_set_level(pulse->gpio, 1);
+    int64_t actuated = esp_timer_get_time();
+    esp_timer_start_once(relay_timer, RELAY_PULSE_TIME * 1000);
+
+    int64_t queueWait = actuated - pulse->stamps.queued;
+
+    latency_record_command(&pulse->stamps, actuated);
+
+    portENTER_CRITICAL(&relay_mux);
+    relay_stats.pulses++;
+    relay_stats.lastQueueWait = queueWait;
+    if( queueWait > relay_stats.maxQueueWait ) {
+        relay_stats.maxQueueWait = queueWait;
+    }
+    portEXIT_CRITICAL(&relay_mux);
+
+    ESP_LOGI(TAG, "gpio %d on, queued for %lld us", pulse->gpio, (long long) queueWait);
+}
+
+
+// *******************************************************************************
+// runs in the esp_timer task, keep it short
+static void relay_timer_callback(void *arg)
+{
+    relay_pending_t next;
+    gpio_num_t endGpio = GPIO_NUM_NC;
+    bool startNext = false;
+
+    portENTER_CRITICAL(&relay_mux);
+
+    if( relay_state == RELAY_STATE_PULSE ) {
+
+        // always keep the relays apart, even if nothing is pending yet
+        endGpio = relay_active_gpio;
+        relay_state = RELAY_STATE_GAP;
+
+    } else if( relay_state == RELAY_STATE_GAP ) {
+
+        if( relay_pending_count > 0 ) {
+
+            next = relay_pending[relay_pending_head];
+            relay_pending_head = (relay_pending_head + 1) % RELAY_PENDING_SIZE;
+            relay_pending_count--;
+            relay_state = RELAY_STATE_PULSE;
+            startNext = true;
+
+        } else {
+
+            relay_state = RELAY_STATE_IDLE;
+        }
+    }
+
+    portEXIT_CRITICAL(&relay_mux);
+
+    if( endGpio != GPIO_NUM_NC ) {
+
+        gpio_set_level(endGpio, 0);
+        esp_timer_start_once(relay_timer, RELAY_PULSE_GAP_TIME * 1000);
+
+    } else if( startNext ) {
+
+        relay_start_pulse(&next);
+    }
+}
+// ******************************************************************************
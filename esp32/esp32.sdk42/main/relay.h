@@ -0,0 +1,39 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _RELAY_H_
+#define _RELAY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/gpio.h"
+#include "latency.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define RELAY_PULSE_TIME                    700     // in ms
+#define RELAY_PULSE_GAP_TIME                50      // in ms, between two consecutive pulses
+#define RELAY_PENDING_SIZE                  8
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef struct {
+    uint32_t pulses;                    // pulses started since boot
+    uint32_t dropped;                   // pulses dropped because the pending list was full
+    int64_t lastQueueWait;              // in us, from cmd_add() to the relay rising edge
+    int64_t maxQueueWait;               // in us
+} relay_stats_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void relay_init(void);
+bool relay_pulse(gpio_num_t gpio, const latency_stamps_t *stamps);
+void relay_get_stats(relay_stats_t *stats);
+
+#endif
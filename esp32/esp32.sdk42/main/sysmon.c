@@ -0,0 +1,236 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include "periodical.h"
+#include "sysmon.h"
+
+static const char *TAG = "SYSMON";
+
+// Note: a periodical job samples the tasks and the heap, the device report sends the figures
+//       the CPU use of a task comes from the FreeRTOS run-time stats, its share of both
+//       cores between two samples, CONFIG_FREERTOS_USE_TRACE_FACILITY and
+//       CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS are needed for it. the free stack is the
+//       high-water mark FreeRTOS keeps for every task, in bytes on the ESP32
+//
+//       the heap is the 8-bit capable one, where the buffers are. the free heap going down
+//       from sample to sample is a leak, a largest free block far below the free heap
+//       is fragmentation
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define SYSMON_SAMPLE_INTERVAL              60      // in seconds
+#define SYSMON_PRIORITY                     0       // of the periodical job, nothing waits for it
+#define SYSMON_STATUS_SIZE                  (SYSMON_MAX_TASKS + 8)  // uxTaskGetSystemState() needs room for all
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+typedef struct {
+    TaskHandle_t handle;                // NULL if the slot is free
+    uint32_t lastRunTime;               // the run-time counter at the last sample
+    bool seen;                          // in the current sample
+    sysmon_task_stats_t stats;
+} sysmon_task_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static sysmon_task_t sysmon_tasks[SYSMON_MAX_TASKS];
+static sysmon_stats_t sysmon_stats;
+static portMUX_TYPE sysmon_mux = portMUX_INITIALIZER_UNLOCKED;     // the figures, read by the report
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+static TaskStatus_t sysmon_status[SYSMON_STATUS_SIZE];             // the gpio task only
+static uint32_t sysmon_last_total = 0;
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static void sysmon_sample_heap(void);
+static void sysmon_sample_tasks(void);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+/**
+ * take the first sample, the CPU use since boot, and register the sampling job
+ */
+void sysmon_init(void)
+{
+    memset(sysmon_tasks, 0, sizeof(sysmon_tasks));
+    memset(&sysmon_stats, 0, sizeof(sysmon_stats));
+
+    sysmon_sample();
+
+    periodical_register("sysmon", SYSMON_SAMPLE_INTERVAL * 1000, SYSMON_PRIORITY, sysmon_sample);
+}
+
+
+/**
+ * the periodical job
+ */
+void sysmon_sample(void)
+{
+    sysmon_sample_heap();
+    sysmon_sample_tasks();
+}
+
+
+void sysmon_get_stats(sysmon_stats_t *stats)
+{
+    portENTER_CRITICAL(&sysmon_mux);
+    *stats = sysmon_stats;
+    portEXIT_CRITICAL(&sysmon_mux);
+}
+
+
+/**
+ * Copy the figures of the tracked tasks
+ *
+ * @return number of tasks copied
+ */
+uint8_t sysmon_get_task_stats(sysmon_task_stats_t *stats, uint8_t maxTasks)
+{
+    uint8_t count = 0;
+
+    portENTER_CRITICAL(&sysmon_mux);
+
+    for( uint8_t tIdx = 0; tIdx < SYSMON_MAX_TASKS && count < maxTasks; tIdx++ ) {
+        if( sysmon_tasks[tIdx].handle != NULL ) {
+            stats[count++] = sysmon_tasks[tIdx].stats;
+        }
+    }
+
+    portEXIT_CRITICAL(&sysmon_mux);
+
+    return(count);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+static void sysmon_sample_heap(void)
+{
+    uint32_t freeSize = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    uint32_t lowest = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    uint32_t frag = freeSize > 0 ? (freeSize - largest) * 100 / freeSize : 0;
+
+    portENTER_CRITICAL(&sysmon_mux);
+
+    bool first = (sysmon_stats.samples == 0);
+    sysmon_stats.samples++;
+    sysmon_stats.free = freeSize;
+    sysmon_stats.lowest = lowest;
+    sysmon_stats.largest = largest;
+    sysmon_stats.frag = frag;
+    if( first || freeSize < sysmon_stats.freeMin ) {
+        sysmon_stats.freeMin = freeSize;
+    }
+    if( freeSize > sysmon_stats.freeMax ) {
+        sysmon_stats.freeMax = freeSize;
+    }
+    if( first || largest < sysmon_stats.largestMin ) {
+        sysmon_stats.largestMin = largest;
+    }
+    if( frag > sysmon_stats.fragMax ) {
+        sysmon_stats.fragMax = frag;
+    }
+
+    portEXIT_CRITICAL(&sysmon_mux);
+
+    ESP_LOGD(TAG, "heap free %u, lowest %u, largest block %u", freeSize, lowest, largest);
+}
+
+
+/**
+ * match the tasks of this sample with the tracked ones by handle,
+ * a task gone since the last sample frees its slot
+ */
+static void sysmon_sample_tasks(void)
+{
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    uint32_t total = 0;
+    UBaseType_t count = uxTaskGetSystemState(sysmon_status, SYSMON_STATUS_SIZE, &total);
+
+    if( count == 0 ) {
+        // more tasks than room, nothing is filled in
+        ESP_LOGW(TAG, "%u tasks, more than %d", uxTaskGetNumberOfTasks(), SYSMON_STATUS_SIZE);
+        return;
+    }
+
+    // the counters of all tasks add up to the elapsed time once per core
+    uint64_t elapsed = (uint64_t) (total - sysmon_last_total) * portNUM_PROCESSORS;
+    sysmon_last_total = total;
+    uint32_t untracked = 0;
+
+    portENTER_CRITICAL(&sysmon_mux);
+
+    for( uint8_t tIdx = 0; tIdx < SYSMON_MAX_TASKS; tIdx++ ) {
+        sysmon_tasks[tIdx].seen = false;
+    }
+
+    for( UBaseType_t sIdx = 0; sIdx < count; sIdx++ ) {
+
+        const TaskStatus_t *status = &sysmon_status[sIdx];
+        sysmon_task_t *task = NULL;
+        sysmon_task_t *freeSlot = NULL;
+
+        for( uint8_t tIdx = 0; tIdx < SYSMON_MAX_TASKS; tIdx++ ) {
+            if( sysmon_tasks[tIdx].handle == status->xHandle ) {
+                task = &sysmon_tasks[tIdx];
+                break;
+            }
+            if( freeSlot == NULL && sysmon_tasks[tIdx].handle == NULL ) {
+                freeSlot = &sysmon_tasks[tIdx];
+            }
+        }
+
+        // a new task, its counter started at zero
+        if( task == NULL ) {
+            if( freeSlot == NULL ) {
+                untracked++;
+                continue;
+            }
+            task = freeSlot;
+            memset(task, 0, sizeof(sysmon_task_t));
+            task->handle = status->xHandle;
+            strncpy(task->stats.name, status->pcTaskName, sizeof(task->stats.name) - 1);
+        }
+
+        uint32_t ran = status->ulRunTimeCounter - task->lastRunTime;
+        task->lastRunTime = status->ulRunTimeCounter;
+        task->seen = true;
+
+        task->stats.cpu = elapsed > 0 ? (uint32_t) ((uint64_t) ran * 1000 / elapsed) : 0;
+        if( task->stats.cpu > task->stats.cpuMax ) {
+            task->stats.cpuMax = task->stats.cpu;
+        }
+        task->stats.stackFree = status->usStackHighWaterMark;
+    }
+
+    for( uint8_t tIdx = 0; tIdx < SYSMON_MAX_TASKS; tIdx++ ) {
+        if( !sysmon_tasks[tIdx].seen ) {
+            sysmon_tasks[tIdx].handle = NULL;
+        }
+    }
+
+    portEXIT_CRITICAL(&sysmon_mux);
+
+    if( untracked > 0 ) {
+        ESP_LOGW(TAG, "%u tasks not tracked, SYSMON_MAX_TASKS is %d", untracked, SYSMON_MAX_TASKS);
+    }
+#endif
+}
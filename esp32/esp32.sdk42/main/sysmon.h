@@ -0,0 +1,48 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _SYSMON_H_
+#define _SYSMON_H_
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define SYSMON_MAX_TASKS                    20      // tasks tracked, the device has about 15
+#define SYSMON_TASK_NAME_SIZE               16      // CONFIG_FREERTOS_MAX_TASK_NAME_LEN
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef struct {
+    uint32_t samples;                   // since boot
+    uint32_t free;                      // in bytes, at the last sample
+    uint32_t freeMin;                   // in bytes, the lowest sample since boot
+    uint32_t freeMax;                   // in bytes, the highest sample since boot
+    uint32_t lowest;                    // in bytes, the lowest free heap ever, between samples too
+    uint32_t largest;                   // in bytes, the largest free block at the last sample
+    uint32_t largestMin;                // in bytes, the smallest since boot
+    uint32_t frag;                      // in %, the free heap not in the largest block, at the last sample
+    uint32_t fragMax;                   // in %, since boot
+} sysmon_stats_t;
+
+typedef struct {
+    char name[SYSMON_TASK_NAME_SIZE];
+    uint32_t cpu;                       // in 0.1 % of both cores, between the last two samples
+    uint32_t cpuMax;                    // in 0.1 %, since boot
+    uint32_t stackFree;                 // in bytes, the unused stack at its lowest since the task started
+} sysmon_task_stats_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void sysmon_init(void);
+void sysmon_sample(void);
+void sysmon_get_stats(sysmon_stats_t *stats);
+uint8_t sysmon_get_task_stats(sysmon_task_stats_t *stats, uint8_t maxTasks);
+
+#endif
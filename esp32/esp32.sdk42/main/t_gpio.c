@@ -20,14 +20,15 @@
 #include "esp_system.h"
 #include "sys/time.h"
 #include <time.h>
-#include "driver/ledc.h"
 #include "driver/periph_ctrl.h"
+#include "esp_timer.h"
 
 #include "app_wifi.h"
 #include "util.h"
 #include "open_tls.h"
 #include "button.h"
 #include "periodical.h"
+#include "led_anim.h"
 #include "t_gpio.h"
 
 static const char *TAG = "TGPIO";
@@ -35,38 +36,68 @@ static const char *TAG = "TGPIO";
 ///////////////////////////////////////////////////////////////////////////////////
 // defines
 
-// LED-PWM config
-#define T_GPIO_LED_IO                      OPEN_TLS_HW_LED1
-#define T_GPIO_INTR_FLAG_LEDC              1
-#define T_GPIO_LEDC_SPEED_MODE             LEDC_LOW_SPEED_MODE
-#define T_GPIO_LEDC_CHANNEL                LEDC_CHANNEL_0
-#define T_GPIO_LED_DARK_DUTY               0
-#define T_GPIO_LED_LIGHT_DUTY              4000    // scale of 13-bit brightness (8192)
-#define T_GPIO_LED_DARK_FADE_TIME          2000    // in ms
-#define T_GPIO_LED_LIGHT_FADE_TIME         1000    // in ms
-
-#define T_GPIO_LED_BREATHING_INTERVAL_LONG     20  // in 250ms count
-#define T_GPIO_LED_BREATHING_INTERVAL_MEDIUM   10  // in 250ms count
-#define T_GPIO_LED_BREATHING_INTERVAL_SHORT    1   // in 250ms count
-
 // LED 2 config
 #define T_GPIO_LED2_IO                     OPEN_TLS_HW_LED2
+#define T_GPIO_LED2_BLINK_TIME             250     // in ms
 
 // no wifi tolerance before reboot
 #define T_GPIO_MAX_NO_WIFI_TIME            3600    // in seconds
 
+// software reset
+#define T_GPIO_REBOOT_DELAY                3       // in seconds
+
+// with no event, the task still wakes up to feed the watchdog
+#define T_GPIO_MAX_SLEEP_TIME              (T_DEVICE_WATCHDOG_TIMER_SEC / 2)   // in seconds
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+
+// one deadline timer per job, each sends its event when it expires
+typedef enum {
+    T_GPIO_TIMER_LED2 = 0,
+    T_GPIO_TIMER_WIFI,
+    T_GPIO_TIMER_RESTART,
+    T_GPIO_TIMER_PERIODICAL,
+    T_GPIO_TIMER_COUNT
+} t_gpio_timer_t;
+
 ///////////////////////////////////////////////////////////////////////////////////
 // local variables
 static t_gpio_led_t t_gpio_current_led_stat;
-static time_t t_gpio_reboot_time = 0;                          // 0 means no reboot request. if non-zero, reboot at the configured time
+static int64_t t_gpio_reboot_time = 0;                         // 0 means no reboot request. if non-zero, reboot at the configured esp_timer time
 static bool t_gpio_restart_issued = false;                     // to avoid continuously restart requests to delay the actual reboot time
-static bool t_gpio_led_mode_short_set = false;
-static bool t_gpio_led_mode_medium_set = false;
 static uint32_t t_gpio_led2_blinking_counter = 0;
 
+static TaskHandle_t t_gpio_task_handle = NULL;                 // NULL until the task runs, events before are covered by its first pass
+static esp_timer_handle_t t_gpio_timers[T_GPIO_TIMER_COUNT];
+static const uint32_t t_gpio_timer_events[T_GPIO_TIMER_COUNT] = {
+    T_GPIO_EVENT_LED2,
+    T_GPIO_EVENT_WIFI,
+    T_GPIO_EVENT_RESTART,
+    T_GPIO_EVENT_PERIODICAL
+};
+static const char *t_gpio_timer_names[T_GPIO_TIMER_COUNT] = { "led2", "wifi_lost", "restart", "periodical" };
+static int64_t t_gpio_deadlines[T_GPIO_TIMER_COUNT];          // 0 if the timer is not armed
+
+// WiFi supervision, owned by the task
+static int64_t t_gpio_wifi_lost_time = 0;
+
+// how often the task wakes up, and how late the jobs run after their deadlines
+static uint32_t t_gpio_wakeups = 0;
+static int64_t t_gpio_task_start_time = 0;
+static uint32_t t_gpio_late_count = 0;
+static int64_t t_gpio_late_total = 0;
+static int64_t t_gpio_late_max = 0;
+
 ///////////////////////////////////////////////////////////////////////////////////
 // local functions
-static void t_gpio_ledSetFade(uint32_t duty, uint32_t timeMs);
+static void t_gpio_led2_perform(void);
+static void t_gpio_wifi_perform(void);
+static void t_gpio_restart_perform(void);
+static void t_gpio_timer_callback(void *arg);
+static void t_gpio_timer_arm(t_gpio_timer_t timer, int64_t delayUs);
+static void t_gpio_timer_disarm(t_gpio_timer_t timer);
+static void t_gpio_lateness_update(uint32_t events);
 
 ///////////////////////////////////////////////////////////////////////////////////
 // public function implementations
@@ -80,33 +111,20 @@ void t_gpio_init(void)
     t_gpio_current_led_stat = T_GPIO_LED_MODE_ERROR_BLINKING;     // everything starts from an error blinking
     t_gpio_reboot_time = 0;
     t_gpio_restart_issued = false;
-    t_gpio_led_mode_short_set = false;
-    t_gpio_led_mode_medium_set = false;
     t_gpio_led2_blinking_counter = 0;
 
-    // ------ LED PWM initialization ------
-    ledc_timer_config_t ledc_timer = {
-        .duty_resolution = LEDC_TIMER_13_BIT,   // resolution of PWM duty
-        .freq_hz = 5000,                        // frequency of PWM signal
-        .speed_mode = T_GPIO_LEDC_SPEED_MODE,  // timer mode
-        .timer_num = LEDC_TIMER_0               // timer index
-    };
-
-    // set configuration of timer0 for high speed channels
-    ledc_timer_config(&ledc_timer);
-
-    ledc_channel_config_t ledc_channel = {
-        .channel    = T_GPIO_LEDC_CHANNEL,
-        .duty       = 0,
-        .gpio_num   = T_GPIO_LED_IO,
-        .speed_mode = T_GPIO_LEDC_SPEED_MODE,
-        .timer_sel  = LEDC_TIMER_0
-    };
-    // set configuration of timer0 for high speed channels
-    ledc_channel_config(&ledc_channel);
-
-    // initialize fade service.
-    ledc_fade_func_install(T_GPIO_INTR_FLAG_LEDC);
+    // the job deadlines
+    for( uint8_t tIdx = 0; tIdx < T_GPIO_TIMER_COUNT; tIdx++ ) {
+        const esp_timer_create_args_t timerArgs = {
+            .callback = t_gpio_timer_callback,
+            .arg = (void *) (uintptr_t) t_gpio_timer_events[tIdx],
+            .name = t_gpio_timer_names[tIdx]
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timerArgs, &t_gpio_timers[tIdx]));
+    }
+
+    // LED patterns
+    led_anim_init();
 
     // initialize the second LED and the IOs to control the door
     gpio_config_t ioConf;
@@ -141,21 +159,20 @@ void t_gpio_led_mode(t_gpio_led_t ledMode)
 {
     if( ledMode == T_GPIO_LED_MODE_CLEAR_ERROR ) {
         t_gpio_current_led_stat = T_GPIO_LED_MODE_BREATHING_INTERVAL_SHORT;
-        t_gpio_led_mode_short_set = true;
+        led_anim_play(LED_ANIM_BREATHE_SHORT);
 
     } else if( ledMode == T_GPIO_LED_MODE_ERROR_BLINKING ) {
         t_gpio_current_led_stat = ledMode;
+        led_anim_play(LED_ANIM_BLINK);
 
     } else if( t_gpio_current_led_stat != T_GPIO_LED_MODE_ERROR_BLINKING ) {
         t_gpio_current_led_stat = ledMode;
 
-        // set medium and short separately
-        // the purpose of using these two additional flags is to prevent
-        // medium mode preempt the short mode
+        // Note: a medium request does not preempt a short one, see led_anim.c
         if( ledMode == T_GPIO_LED_MODE_BREATHING_INTERVAL_SHORT ) {
-            t_gpio_led_mode_short_set = true;
+            led_anim_play(LED_ANIM_BREATHE_SHORT);
         } else if( ledMode == T_GPIO_LED_MODE_BREATHING_INTERVAL_MEDIUM ) {
-            t_gpio_led_mode_medium_set = true;
+            led_anim_play(LED_ANIM_BREATHE_MEDIUM);
         }
     }
 }
@@ -167,8 +184,6 @@ void t_gpio_led_mode(t_gpio_led_t ledMode)
  */
 void t_gpio_issue_esp_restart(void)
 {
-    time_t currentTime;
-
     // avoid duplicate restart request
     if( t_gpio_restart_issued ) {
         // do not proceed a restart command more than once
@@ -178,13 +193,11 @@ void t_gpio_issue_esp_restart(void)
         t_gpio_restart_issued = true;
     }
 
-    // get current time
-    time(&currentTime);
-
     // set the reboot time at 3 seconds from now
-    t_gpio_reboot_time = currentTime + 3;
+    t_gpio_reboot_time = esp_timer_get_time() + (int64_t) T_GPIO_REBOOT_DELAY * 1000000;
 
     ESP_LOGI(TAG, "software reset requested");
+    t_gpio_notify(T_GPIO_EVENT_RESTART);
 }
 
 
@@ -198,147 +211,108 @@ void t_gpio_led2_blink(void)
 
     // set the counter then let the gpio task to turn led2 off
     t_gpio_led2_blinking_counter = 1;
+    t_gpio_notify(T_GPIO_EVENT_LED2);
 }
 
 
 /**
- * this task serialize the routine tasks and the other low priority handlers
+ * Wake up the gpio task for the given T_GPIO_EVENT_ bits
  */
-void t_gpio_task(void *pvParameters)
+void t_gpio_notify(uint32_t events)
 {
-    time_t disconnectWifiTime = 0;
-    bool blinkingLedOn = false;
-    bool breathingLedOn = false;
-    uint8_t breathingLedWaitCounter = 0;
-    uint8_t breathingLedWaitMax = 0;
+    if( t_gpio_task_handle != NULL ) {
+        xTaskNotify(t_gpio_task_handle, events, eSetBits);
+    }
+}
 
-    while( 1 ) {
-        // per-250ms interval process resolution
-        vTaskDelay(pdMS_TO_TICKS(250));
-
-        // --------------------------------------------------
-        // handling led breathing/blinking
-        // --------------------------------------------------
-        if( t_gpio_current_led_stat == T_GPIO_LED_MODE_ERROR_BLINKING ) {
-
-            if( blinkingLedOn ) {
-                // turn off
-                t_gpio_ledSetFade(T_GPIO_LED_DARK_DUTY, 0);
-                blinkingLedOn = false;
-            } else {
-                // turn on
-                t_gpio_ledSetFade(T_GPIO_LED_LIGHT_DUTY, 0);
-                blinkingLedOn = true;
-            }
-
-        } else {
-
-            if( breathingLedOn ) {
-
-                // fade off
-                t_gpio_ledSetFade(T_GPIO_LED_DARK_DUTY, T_GPIO_LED_DARK_FADE_TIME);
-                breathingLedOn = false;
-
-            } else {
-
-                // determine how long to restart the led breathing
-                // note: short interval has the highest priority
-                if( t_gpio_led_mode_short_set ) {
-                    breathingLedWaitMax = T_GPIO_LED_BREATHING_INTERVAL_SHORT;
-                    t_gpio_led_mode_short_set = false; // clear the flag
-                } else if( t_gpio_led_mode_medium_set ) {
-                    breathingLedWaitMax = T_GPIO_LED_BREATHING_INTERVAL_MEDIUM;
-                    t_gpio_led_mode_medium_set = false;
-                } else {
-                    breathingLedWaitMax = T_GPIO_LED_BREATHING_INTERVAL_LONG;
-                }
-
-                if( breathingLedWaitCounter < breathingLedWaitMax ) {
-                    breathingLedWaitCounter++;
-                } else {
-                    // fade on
-                    t_gpio_ledSetFade(T_GPIO_LED_LIGHT_DUTY, T_GPIO_LED_LIGHT_FADE_TIME);
-                    breathingLedOn = true;
-                    breathingLedWaitCounter = 0;
-                }
-
-            }
 
+/**
+ * The same as t_gpio_notify(), from an ISR
+ */
+void IRAM_ATTR t_gpio_notify_from_isr(uint32_t events)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    if( t_gpio_task_handle != NULL ) {
+        xTaskNotifyFromISR(t_gpio_task_handle, events, eSetBits, &higherPriorityTaskWoken);
+        if( higherPriorityTaskWoken ) {
+            portYIELD_FROM_ISR();
         }
+    }
+}
 
-        time_t currentTime;
 
-        // get current time
-        time(&currentTime);
+/**
+ * Get how often the gpio task wakes up, and how late it runs the jobs
+ */
+void t_gpio_get_stats(t_gpio_stats_t *stats)
+{
+    int64_t elapsed = esp_timer_get_time() - t_gpio_task_start_time;
 
-        // --------------------------------------------------
-        // check WIFI status
-        // --------------------------------------------------
-
-        if( !app_wifi_is_connected() ) {
-            // save disconnect wifi time
-            if( disconnectWifiTime == 0 ) {
-                disconnectWifiTime = currentTime;
-            }
-
-            // no wifi or token over an hour
-            if( currentTime - disconnectWifiTime > T_GPIO_MAX_NO_WIFI_TIME ) {
-                ESP_LOGE(TAG, "already no wifi for %ld sec,  restart the system", currentTime - disconnectWifiTime);
-
-                // reset peripheral modules incase wifi/bt unknown error happened
-                periph_module_reset(PERIPH_WIFI_MODULE);
-                periph_module_reset(PERIPH_WIFI_BT_COMMON_MODULE);
-
-                // system will reboot in 3 seconds
-                t_gpio_issue_esp_restart();
-
-                // SYSTEM REBOOT ... (in 3 seconds)
-            }
-        } else {
-            // reset disconnect wifi time
-            disconnectWifiTime = 0;
-        }
+    stats->wakeups = t_gpio_wakeups;
+    stats->perMinute = 0;
+    if( t_gpio_task_start_time > 0 && elapsed > 0 ) {
+        stats->perMinute = (uint32_t) ((int64_t) t_gpio_wakeups * 60000000 / elapsed);
+    }
 
-        // --------------------------------------------------
-        // reboot request
-        // --------------------------------------------------
+    stats->jobs = t_gpio_late_count;
+    stats->lateAvg = t_gpio_late_count > 0 ? (uint32_t) (t_gpio_late_total / t_gpio_late_count) : 0;
+    stats->lateMax = (uint32_t) t_gpio_late_max;
+}
 
-        // check if reboot request is issued
-        if( t_gpio_reboot_time > 0 ) {
-            if( currentTime > t_gpio_reboot_time ) {
-                esp_restart();
 
-                // unreachable
-            }
+/**
+ * this task serialize the routine tasks and the other low priority handlers
+ * it sleeps until one of the T_GPIO_EVENT_ bits is sent, by an event source or by the deadline timer of a job
+ */
+void t_gpio_task(void *pvParameters)
+{
+    // everything is checked once at the start, then only what the events ask for
+    uint32_t events = T_GPIO_EVENT_ALL;
 
-            // time count down
-            ESP_LOGI(TAG, "software reset in %ld second(s)", t_gpio_reboot_time - currentTime);
-        }
+    t_gpio_task_start_time = esp_timer_get_time();
+    t_gpio_task_handle = xTaskGetCurrentTaskHandle();
 
-        // feed the watchdog
-        esp_task_wdt_reset();
+    while( 1 ) {
 
-        // check the LED2 blinking status
-        if( t_gpio_led2_blinking_counter > 0 ) {
+        // how late the deadlines are met
+        t_gpio_lateness_update(events);
 
-            t_gpio_led2_blinking_counter--;
-            if( t_gpio_led2_blinking_counter & 0x1 ) {
+        // check WIFI status
+        if( events & T_GPIO_EVENT_WIFI ) {
+            t_gpio_wifi_perform();
+        }
 
-                gpio_set_level(T_GPIO_LED2_IO, 1);
+        // reboot request
+        if( events & T_GPIO_EVENT_RESTART ) {
+            t_gpio_restart_perform();
+        }
 
-            } else {
+        // feed the watchdog
+        esp_task_wdt_reset();
 
-                gpio_set_level(T_GPIO_LED2_IO, 0);
-            }
+        // check the LED2 blinking status
+        if( events & T_GPIO_EVENT_LED2 ) {
+            t_gpio_led2_perform();
         }
 
         // perform button task
-        button_handle();
-        esp_task_wdt_reset();   // feed the dog in case the previous handler took too much time
+        if( events & T_GPIO_EVENT_BUTTON ) {
+            button_handle();
+            esp_task_wdt_reset();   // feed the dog in case the previous handler took too much time
+        }
+
+        // perform the periodical jobs, then sleep until the next one
+        if( events & T_GPIO_EVENT_PERIODICAL ) {
+            uint32_t nextJob = periodical_perform();
+            t_gpio_timer_arm(T_GPIO_TIMER_PERIODICAL, (int64_t) nextJob * 1000);
+            esp_task_wdt_reset();   // feed the dog in case the previous handler took too much time
+        }
 
-        // perform the periodical task
-        periodical_perform();
-        esp_task_wdt_reset();   // feed the dog in case the previous handler took too much time
+        // wait for the next event
+        events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(T_GPIO_MAX_SLEEP_TIME * 1000));
+        t_gpio_wakeups++;
 
     } // end while(1)
 
@@ -351,30 +325,135 @@ void t_gpio_task(void *pvParameters)
 // local functions implementation
 
 /**
- * Update led duty or set fade then wait it done
- * NOTE: Since LEDC_FADE_WAIT_DONE is a semaphore portMAX_DELAY, task will dead in ledc function,
- *          so use no blocking code.
- * NOTE: 0 ms still wait 1 ms to avoid SDK warning log.
- *
- * @param duty to update or set fade
- * @param timeMs fade time in ms, 0 means update without delay but SDK will show warning log,
- *                  so make it be 1 ms
+ * Turn LED2 off T_GPIO_LED2_BLINK_TIME after the last blink
  */
-static void t_gpio_ledSetFade(uint32_t duty, uint32_t timeMs)
+static void t_gpio_led2_perform(void)
 {
-    if( timeMs == 0 ) {
+    if( t_gpio_led2_blinking_counter > 0 ) {
 
-        // make led update duty as soon as possible
-        timeMs = 1;
+        // a new blink, turn off later
+        t_gpio_led2_blinking_counter = 0;
+        t_gpio_timer_arm(T_GPIO_TIMER_LED2, T_GPIO_LED2_BLINK_TIME * 1000);
+
+    } else {
+
+        gpio_set_level(T_GPIO_LED2_IO, 0);
     }
+}
 
-    // set led fade without blocking
-    ledc_set_fade_time_and_start(T_GPIO_LEDC_SPEED_MODE,
-                                T_GPIO_LEDC_CHANNEL,
-                                duty,
-                                timeMs,
-                                LEDC_FADE_NO_WAIT);
 
-    // wait fade done
-    vTaskDelay(timeMs / portTICK_RATE_MS);
+/**
+ * Restart the system when WiFi stays lost for T_GPIO_MAX_NO_WIFI_TIME
+ */
+static void t_gpio_wifi_perform(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    if( app_wifi_is_connected() ) {
+        // reset disconnect wifi time
+        t_gpio_wifi_lost_time = 0;
+        t_gpio_timer_disarm(T_GPIO_TIMER_WIFI);
+        return;
+    }
+
+    // save disconnect wifi time
+    if( t_gpio_wifi_lost_time == 0 ) {
+        t_gpio_wifi_lost_time = now;
+    }
+
+    int64_t lostTime = now - t_gpio_wifi_lost_time;
+
+    // no wifi or token over an hour
+    if( lostTime >= (int64_t) T_GPIO_MAX_NO_WIFI_TIME * 1000000 ) {
+        ESP_LOGE(TAG, "already no wifi for %lld sec,  restart the system", (long long) (lostTime / 1000000));
+
+        // reset peripheral modules incase wifi/bt unknown error happened
+        periph_module_reset(PERIPH_WIFI_MODULE);
+        periph_module_reset(PERIPH_WIFI_BT_COMMON_MODULE);
+
+        // system will reboot in 3 seconds
+        t_gpio_issue_esp_restart();
+
+        // SYSTEM REBOOT ... (in 3 seconds)
+        return;
+    }
+
+    t_gpio_timer_arm(T_GPIO_TIMER_WIFI, (int64_t) T_GPIO_MAX_NO_WIFI_TIME * 1000000 - lostTime);
+}
+
+
+/**
+ * Count down the requested software reset, once a second
+ */
+static void t_gpio_restart_perform(void)
+{
+    if( t_gpio_reboot_time == 0 ) {
+        return;
+    }
+
+    int64_t remaining = t_gpio_reboot_time - esp_timer_get_time();
+    if( remaining <= 0 ) {
+        esp_restart();
+
+        // unreachable
+    }
+
+    // time count down
+    ESP_LOGI(TAG, "software reset in %lld second(s)", (long long) ((remaining + 999999) / 1000000));
+    t_gpio_timer_arm(T_GPIO_TIMER_RESTART, remaining < 1000000 ? remaining : 1000000);
+}
+
+
+// runs in the esp_timer task, the job itself runs in the gpio task
+static void t_gpio_timer_callback(void *arg)
+{
+    t_gpio_notify((uint32_t) (uintptr_t) arg);
+}
+
+
+/**
+ * (Re)start the deadline timer of a job
+ */
+static void t_gpio_timer_arm(t_gpio_timer_t timer, int64_t delayUs)
+{
+    if( delayUs < 0 ) {
+        delayUs = 0;
+    }
+
+    // not running is fine
+    esp_timer_stop(t_gpio_timers[timer]);
+    t_gpio_deadlines[timer] = esp_timer_get_time() + delayUs;
+    esp_timer_start_once(t_gpio_timers[timer], (uint64_t) delayUs);
+}
+
+
+static void t_gpio_timer_disarm(t_gpio_timer_t timer)
+{
+    esp_timer_stop(t_gpio_timers[timer]);
+    t_gpio_deadlines[timer] = 0;
+}
+
+
+/**
+ * Account the jobs woken up by their deadline timers, from the deadline to now
+ */
+static void t_gpio_lateness_update(uint32_t events)
+{
+    int64_t now = esp_timer_get_time();
+
+    for( uint8_t tIdx = 0; tIdx < T_GPIO_TIMER_COUNT; tIdx++ ) {
+
+        if( !(events & t_gpio_timer_events[tIdx]) || t_gpio_deadlines[tIdx] == 0 || now < t_gpio_deadlines[tIdx] ) {
+            continue;
+        }
+
+        int64_t lateness = now - t_gpio_deadlines[tIdx];
+        t_gpio_deadlines[tIdx] = 0;
+
+        t_gpio_late_count++;
+        t_gpio_late_total += lateness;
+        if( lateness > t_gpio_late_max ) {
+            t_gpio_late_max = lateness;
+        }
+    }
 }
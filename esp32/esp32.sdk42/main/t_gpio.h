@@ -10,8 +10,20 @@
 #ifndef _T_GPIO_H_
 #define _T_GPIO_H_
 
+#include <stdint.h>
+
 ///////////////////////////////////////////////////////////////////////////////////
 // defines
+
+// the events which wake up t_gpio_task, more than one can be sent at once
+// Note: the LED patterns do not run in the task, see led_anim.c
+#define T_GPIO_EVENT_LED2                   (1 << 0)    // LED2 is turned on or is due to be turned off
+#define T_GPIO_EVENT_WIFI                   (1 << 1)    // WiFi is connected or lost
+#define T_GPIO_EVENT_BUTTON                 (1 << 2)    // the button is pressed, sent by the ISR
+#define T_GPIO_EVENT_RESTART                (1 << 3)    // a software reset is requested or its countdown is due
+#define T_GPIO_EVENT_PERIODICAL             (1 << 4)    // a periodical job is registered, triggered or due
+#define T_GPIO_EVENT_ALL                    0x1f
+
 typedef enum {
     T_GPIO_LED_MODE_ERROR_BLINKING = 1,                 // 250ms blinking, which has the highest priority
     T_GPIO_LED_MODE_CLEAR_ERROR,                        // clear the error blinking status, continue with short breathing
@@ -20,6 +32,16 @@ typedef enum {
                                                         // not short, not medium is long
 } t_gpio_led_t;
 
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef struct {
+    uint32_t wakeups;                   // since the task started
+    uint32_t perMinute;                 // the average since the task started
+    uint32_t jobs;                      // jobs run by their deadline timers
+    uint32_t lateAvg;                   // in us, from the deadline to the job
+    uint32_t lateMax;                   // in us
+} t_gpio_stats_t;
+
 ///////////////////////////////////////////////////////////////////////////////////
 // public function
 void t_gpio_init(void);
@@ -27,5 +49,8 @@ void t_gpio_led_mode(t_gpio_led_t ledMode);
 void t_gpio_task(void *pvParameters);
 void t_gpio_issue_esp_restart(void);
 void t_gpio_led2_blink(void);
+void t_gpio_notify(uint32_t events);
+void t_gpio_notify_from_isr(uint32_t events);
+void t_gpio_get_stats(t_gpio_stats_t *stats);
 
 #endif
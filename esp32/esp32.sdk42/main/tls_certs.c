@@ -0,0 +1,142 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_tls.h"
+#include "esp32/rom/crc.h"
+
+#include "tls_certs.h"
+
+static const char *TAG = "TLS_CERTS";
+
+// Note: the certificates and the key are taken as DER from the certs partition,
+//       mapped into the address space with esp_partition_mmap() and handed to esp-mqtt
+//       with their lengths, so there is no base64 decoding and no PEM copy in RAM.
+//       tools/certs_image.py builds the partition image from the PEM files, and
+//       parttool.py writes it, so the certificates are rotated without a new app.
+//
+//       the root CA chain is parsed once into the esp-tls global CA store and used by
+//       every connection. esp-tls of ESP-IDF v4.2 parses the client certificate and key
+//       for each connection, from the DER in flash.
+//
+//       when the partition is missing, empty or corrupted, the PEM files embedded in
+//       the app are used, the same as before
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+extern const uint8_t aws_root_ca_pem_start[] asm("_binary_aws_root_ca_pem_start");
+extern const uint8_t aws_root_ca_pem_end[] asm("_binary_aws_root_ca_pem_end");
+extern const uint8_t certificate_pem_crt_start[] asm("_binary_my_tls_certificate_pem_crt_start");
+extern const uint8_t certificate_pem_crt_end[] asm("_binary_my_tls_certificate_pem_crt_end");
+extern const uint8_t private_key_pem_start[] asm("_binary_my_tls_private_pem_key_start");
+extern const uint8_t private_key_pem_end[] asm("_binary_my_tls_private_pem_key_end");
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static tls_certs_t tls_certs;
+static spi_flash_mmap_handle_t tls_certs_mmap_handle;   // kept mapped for the life of the app
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static bool tls_certs_map_partition(void);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+/**
+ * find the certificates, in the certs partition or embedded in the app,
+ * and load the root CA chain into the global CA store
+ */
+const tls_certs_t *tls_certs_init(void)
+{
+    memset(&tls_certs, 0, sizeof(tls_certs));
+
+    size_t rootCaBytes;
+
+    if( tls_certs_map_partition() ) {
+
+        tls_certs.der = true;
+        rootCaBytes = tls_certs.len[TLS_CERTS_ROOT_CA];
+
+    } else {
+
+        tls_certs.data[TLS_CERTS_ROOT_CA] = (const char *) aws_root_ca_pem_start;
+        tls_certs.data[TLS_CERTS_CLIENT_CERT] = (const char *) certificate_pem_crt_start;
+        tls_certs.data[TLS_CERTS_CLIENT_KEY] = (const char *) private_key_pem_start;
+
+        // mbedtls takes the PEM length with its null terminator
+        rootCaBytes = aws_root_ca_pem_end - aws_root_ca_pem_start;
+    }
+
+    esp_err_t err = esp_tls_set_global_ca_store((const unsigned char *) tls_certs.data[TLS_CERTS_ROOT_CA], rootCaBytes);
+    if( err == ESP_OK ) {
+        tls_certs.globalCaStore = true;
+    } else {
+        ESP_LOGE(TAG, "unable to load the root CA into the global store, 0x%x", err);
+    }
+
+    ESP_LOGI(TAG, "certificates %s", tls_certs.der ? "in the certs partition" : "embedded in the app");
+
+    return(&tls_certs);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+/**
+ * map the certs partition, the header and every DER file must be intact
+ */
+static bool tls_certs_map_partition(void)
+{
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                                TLS_CERTS_PARTITION_LABEL);
+    if( partition == NULL ) {
+        return(false);
+    }
+
+    const void *mapped = NULL;
+    esp_err_t err = esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA, &mapped, &tls_certs_mmap_handle);
+    if( err != ESP_OK ) {
+        ESP_LOGE(TAG, "unable to map the certs partition, 0x%x", err);
+        return(false);
+    }
+
+    const tls_certs_header_t *header = mapped;
+    bool valid = header->magic == TLS_CERTS_MAGIC &&
+                 header->version == TLS_CERTS_VERSION &&
+                 header->crc == crc32_le(0, (const uint8_t *) header, offsetof(tls_certs_header_t, crc));
+
+    for( uint8_t item = 0; item < TLS_CERTS_COUNT && valid; item++ ) {
+
+        uint32_t offset = header->items[item].offset;
+        uint32_t len = header->items[item].len;
+
+        valid = len > 0 && offset >= sizeof(tls_certs_header_t) && offset <= partition->size &&
+                len <= partition->size - offset &&
+                header->items[item].crc == crc32_le(0, (const uint8_t *) mapped + offset, len);
+
+        tls_certs.data[item] = (const char *) mapped + offset;
+        tls_certs.len[item] = len;
+    }
+
+    if( !valid ) {
+        ESP_LOGW(TAG, "no valid certificates in the certs partition");
+        spi_flash_munmap(tls_certs_mmap_handle);
+        memset(&tls_certs, 0, sizeof(tls_certs));
+        return(false);
+    }
+
+    return(true);
+}
@@ -0,0 +1,56 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _TLS_CERTS_H_
+#define _TLS_CERTS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define TLS_CERTS_PARTITION_LABEL           "certs"
+#define TLS_CERTS_MAGIC                     0x434c544f  // "OTLC"
+#define TLS_CERTS_VERSION                   1
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef enum {
+    TLS_CERTS_ROOT_CA = 0,
+    TLS_CERTS_CLIENT_CERT,
+    TLS_CERTS_CLIENT_KEY,
+    TLS_CERTS_COUNT
+} tls_certs_item_t;
+
+// the head of the certs partition, the DER files follow it
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    struct {
+        uint32_t offset;                // from the start of the partition
+        uint32_t len;
+        uint32_t crc;                   // crc32_le(0, ...) of the DER
+    } items[TLS_CERTS_COUNT];
+    uint32_t crc;                       // over everything above
+} tls_certs_header_t;
+
+// where the MQTT client takes its certificates from
+typedef struct {
+    const char *data[TLS_CERTS_COUNT];
+    size_t len[TLS_CERTS_COUNT];        // 0 for a null terminated PEM, the esp-mqtt convention
+    bool der;                           // read in place from the certs partition
+    bool globalCaStore;                 // the root CA chain is parsed once, into the esp-tls global store
+} tls_certs_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+const tls_certs_t *tls_certs_init(void);
+
+#endif
@@ -0,0 +1,385 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp32/rom/crc.h"
+#include "nvs.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_internal.h"
+
+#include "open_tls.h"
+#include "tls_session.h"
+
+static const char *TAG = "TLS_SESSION";
+
+// Note: esp-mqtt and esp-tls of ESP-IDF v4.2 do not let the application set or read
+//       the TLS session, so mbedtls_ssl_handshake() is wrapped at link time
+//       (-Wl,--wrap, see CMakeLists.txt and component.mk). before the first step of a
+//       handshake the saved session of the same host is set, and after the handshake
+//       the new session, its ID or ticket, is saved for the next connection.
+//
+//       the session is kept in RTC memory, which survives a software or watchdog reset.
+//       with OPEN_TLS_TLS_SESSION_NVS it is also written to NVS after a full handshake,
+//       so a power cycle resumes it too.
+//
+//       if the broker does not accept the saved session, mbedtls falls back to a full
+//       handshake, nothing else changes. only the MQTT task connects over TLS,
+//       there is no locking
+//
+//       the same hook sets the cipher suites offered, ECDHE-ECDSA first, and P-256
+//       as the first ECDHE curve. the broker takes them when its certificate is ECC,
+//       and an RSA broker still finds its ECDHE-RSA suites. the client key may be RSA
+//       or EC P-256 either way, it only signs the CertificateVerify
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define TLS_SESSION_MAGIC                   0x544c5353  // "TLSS"
+#define TLS_SESSION_NVS_NAMESPACE           "tls_session"
+#define TLS_SESSION_NVS_KEY                 "session"
+
+///////////////////////////////////////////////////////////////////////////////////
+// typedefs
+// what mbedtls needs to resume, the peer certificate is not kept
+typedef struct {
+    uint32_t magic;
+    char host[TLS_SESSION_HOST_SIZE];
+    int32_t ciphersuite;
+    int32_t compression;
+    uint8_t idLen;
+    uint8_t id[32];
+    uint8_t master[48];
+    uint8_t mflCode;
+    uint8_t truncHmac;
+    uint8_t encryptThenMac;
+    uint32_t ticketLen;
+    uint32_t ticketLifetime;
+    uint8_t ticket[TLS_SESSION_TICKET_SIZE];
+    uint32_t crc;                       // over everything above
+} tls_session_store_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local variables
+static RTC_NOINIT_ATTR tls_session_store_t tls_session_store;
+
+// in order of preference, AES-128 is as safe here and cheaper than AES-256
+static const int tls_session_ciphersuites[] = {
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CBC_SHA256,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384,
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA256,
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384,
+    MBEDTLS_TLS_RSA_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_RSA_WITH_AES_128_CBC_SHA256,
+    0
+};
+
+// P-256 first, it has the fast NIST reduction and is the curve of the ECC certificates
+static const mbedtls_ecp_group_id tls_session_curves[] = {
+    MBEDTLS_ECP_DP_SECP256R1,
+    MBEDTLS_ECP_DP_SECP384R1,
+    MBEDTLS_ECP_DP_NONE
+};
+
+static tls_session_stats_t tls_session_stats;
+static uint64_t tls_session_full_total = 0;     // in us
+static uint64_t tls_session_resumed_total = 0;  // in us
+
+// the handshake in progress
+static const mbedtls_ssl_context *tls_session_ssl = NULL;
+static int64_t tls_session_start = 0;
+static bool tls_session_resuming = false;
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function
+static void tls_session_seal(void);
+static bool tls_session_is_valid(void);
+static void tls_session_restore(mbedtls_ssl_context *ssl);
+static void tls_session_save(const mbedtls_ssl_context *ssl, bool resumed);
+static void tls_session_nvs_load(void);
+static void tls_session_nvs_save(void);
+
+// the real one, renamed by the linker
+int __real_mbedtls_ssl_handshake(mbedtls_ssl_context *ssl);
+int __wrap_mbedtls_ssl_handshake(mbedtls_ssl_context *ssl);
+
+///////////////////////////////////////////////////////////////////////////////////
+// public function implementations
+
+/**
+ * keep the session of the previous boot if RTC memory still holds it, else take it from NVS
+ */
+void tls_session_init(void)
+{
+    memset(&tls_session_stats, 0, sizeof(tls_session_stats));
+    tls_session_full_total = 0;
+    tls_session_resumed_total = 0;
+
+    if( tls_session_is_valid() ) {
+        ESP_LOGI(TAG, "session of %s kept in RTC memory", tls_session_store.host);
+        return;
+    }
+
+    memset(&tls_session_store, 0, sizeof(tls_session_store));
+    tls_session_nvs_load();
+}
+
+
+void tls_session_get_stats(tls_session_stats_t *stats)
+{
+    *stats = tls_session_stats;
+
+    uint32_t full = tls_session_stats.handshakes - tls_session_stats.resumed;
+    stats->fullTime = full > 0 ? (uint32_t) (tls_session_full_total / full / 1000) : 0;
+    stats->resumedTime = tls_session_stats.resumed > 0 ?
+                         (uint32_t) (tls_session_resumed_total / tls_session_stats.resumed / 1000) : 0;
+}
+
+
+/**
+ * the same loop as mbedtls_ssl_handshake(), with the session set before the first step
+ * and read back once the ServerHello tells whether it was accepted
+ */
+int __wrap_mbedtls_ssl_handshake(mbedtls_ssl_context *ssl)
+{
+    if( ssl == NULL || ssl->conf == NULL || ssl->conf->endpoint != MBEDTLS_SSL_IS_CLIENT ) {
+        return(__real_mbedtls_ssl_handshake(ssl));
+    }
+
+    // the first call of a new handshake, a non-blocking one comes back until it is over
+    if( ssl->state == MBEDTLS_SSL_HELLO_REQUEST ) {
+        tls_session_ssl = ssl;
+        tls_session_start = esp_timer_get_time();
+        tls_session_resuming = false;
+
+        // the config belongs to esp-tls and lives as long as the connection
+        mbedtls_ssl_conf_ciphersuites((mbedtls_ssl_config *) ssl->conf, tls_session_ciphersuites);
+        mbedtls_ssl_conf_curves((mbedtls_ssl_config *) ssl->conf, tls_session_curves);
+        tls_session_restore(ssl);
+    }
+
+    int ret = 0;
+    while( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER ) {
+
+        ret = mbedtls_ssl_handshake_step(ssl);
+
+        // cleared by the ServerHello if the session is not accepted, and gone after the last step
+        if( ssl->handshake != NULL && ssl == tls_session_ssl ) {
+            tls_session_resuming = ssl->handshake->resume != 0;
+        }
+
+        if( ret != 0 ) {
+            break;
+        }
+    }
+
+    if( ssl != tls_session_ssl ) {
+        return(ret);
+    }
+
+    if( ret == 0 ) {
+
+        uint32_t elapsed = (uint32_t) (esp_timer_get_time() - tls_session_start);
+
+        tls_session_stats.handshakes++;
+        tls_session_stats.lastTime = elapsed / 1000;
+        if( tls_session_resuming ) {
+            tls_session_stats.resumed++;
+            tls_session_resumed_total += elapsed;
+        } else {
+            tls_session_full_total += elapsed;
+        }
+
+        tls_session_stats.suite = mbedtls_ssl_get_ciphersuite(ssl);
+        if( ssl->conf->key_cert != NULL && ssl->conf->key_cert->key != NULL ) {
+            tls_session_stats.key = mbedtls_pk_get_name(ssl->conf->key_cert->key);
+        }
+
+        ESP_LOGI(TAG, "%s handshake in %u ms, %s", tls_session_resuming ? "resumed" : "full", elapsed / 1000,
+                                                   tls_session_stats.suite);
+
+        tls_session_save(ssl, tls_session_resuming);
+        tls_session_ssl = NULL;
+
+    } else if( ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE ) {
+
+        // a session the broker takes but cannot finish is not tried again
+        if( tls_session_resuming ) {
+            tls_session_store.magic = 0;
+            tls_session_seal();
+        }
+
+        tls_session_stats.failed++;
+        tls_session_ssl = NULL;
+    }
+
+    return(ret);
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// local function implementations
+
+static void tls_session_seal(void)
+{
+    tls_session_store.crc = crc32_le(0, (const uint8_t *) &tls_session_store, offsetof(tls_session_store_t, crc));
+}
+
+
+static bool tls_session_is_valid(void)
+{
+    return(tls_session_store.magic == TLS_SESSION_MAGIC &&
+           tls_session_store.idLen <= sizeof(tls_session_store.id) &&
+           tls_session_store.ticketLen <= sizeof(tls_session_store.ticket) &&
+           tls_session_store.host[sizeof(tls_session_store.host) - 1] == 0x00 &&
+           tls_session_store.crc == crc32_le(0, (const uint8_t *) &tls_session_store, offsetof(tls_session_store_t, crc)));
+}
+
+
+/**
+ * offer the saved session if it is for the same host
+ */
+static void tls_session_restore(mbedtls_ssl_context *ssl)
+{
+    if( !tls_session_is_valid() || ssl->hostname == NULL || strcmp(ssl->hostname, tls_session_store.host) ) {
+        return;
+    }
+
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+
+#if defined(MBEDTLS_HAVE_TIME)
+    session.start = time(NULL);
+#endif
+    session.ciphersuite = tls_session_store.ciphersuite;
+    session.compression = tls_session_store.compression;
+    session.id_len = tls_session_store.idLen;
+    memcpy(session.id, tls_session_store.id, sizeof(session.id));
+    memcpy(session.master, tls_session_store.master, sizeof(session.master));
+    session.verify_result = 0;         // only sessions of a verified handshake are saved
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    session.ticket = tls_session_store.ticketLen > 0 ? tls_session_store.ticket : NULL;
+    session.ticket_len = tls_session_store.ticketLen;
+    session.ticket_lifetime = tls_session_store.ticketLifetime;
+#endif
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    session.mfl_code = tls_session_store.mflCode;
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+    session.trunc_hmac = tls_session_store.truncHmac;
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+    session.encrypt_then_mac = tls_session_store.encryptThenMac;
+#endif
+
+    // copied, including the ticket, so nothing of session is freed here
+    int ret = mbedtls_ssl_set_session(ssl, &session);
+    if( ret != 0 ) {
+        ESP_LOGW(TAG, "unable to set the saved session, -0x%x", -ret);
+    }
+}
+
+
+/**
+ * keep the negotiated session, a resumed one may come with a new ticket
+ */
+static void tls_session_save(const mbedtls_ssl_context *ssl, bool resumed)
+{
+    const mbedtls_ssl_session *session = ssl->session;
+
+    if( session == NULL || ssl->hostname == NULL || strlen(ssl->hostname) >= sizeof(tls_session_store.host) ) {
+        return;
+    }
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    if( session->ticket_len > sizeof(tls_session_store.ticket) ) {
+        ESP_LOGW(TAG, "session ticket of %u bytes is not kept", session->ticket_len);
+        return;
+    }
+#endif
+
+    memset(&tls_session_store, 0, sizeof(tls_session_store));
+    tls_session_store.magic = TLS_SESSION_MAGIC;
+    strcpy(tls_session_store.host, ssl->hostname);
+    tls_session_store.ciphersuite = session->ciphersuite;
+    tls_session_store.compression = session->compression;
+    tls_session_store.idLen = session->id_len;
+    memcpy(tls_session_store.id, session->id, sizeof(tls_session_store.id));
+    memcpy(tls_session_store.master, session->master, sizeof(tls_session_store.master));
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    if( session->ticket != NULL ) {
+        memcpy(tls_session_store.ticket, session->ticket, session->ticket_len);
+        tls_session_store.ticketLen = session->ticket_len;
+        tls_session_store.ticketLifetime = session->ticket_lifetime;
+    }
+#endif
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    tls_session_store.mflCode = session->mfl_code;
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+    tls_session_store.truncHmac = session->trunc_hmac;
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+    tls_session_store.encryptThenMac = session->encrypt_then_mac;
+#endif
+    tls_session_seal();
+
+    // one flash write per new session, not per reconnect
+    if( !resumed ) {
+        tls_session_nvs_save();
+    }
+}
+
+
+static void tls_session_nvs_load(void)
+{
+#ifdef OPEN_TLS_TLS_SESSION_NVS
+    nvs_handle_t handle;
+    if( nvs_open(TLS_SESSION_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK ) {
+        return;
+    }
+
+    size_t len = sizeof(tls_session_store);
+    if( nvs_get_blob(handle, TLS_SESSION_NVS_KEY, &tls_session_store, &len) != ESP_OK ||
+        len != sizeof(tls_session_store) || !tls_session_is_valid() ) {
+
+        memset(&tls_session_store, 0, sizeof(tls_session_store));
+    } else {
+        ESP_LOGI(TAG, "session of %s loaded from NVS", tls_session_store.host);
+    }
+
+    nvs_close(handle);
+#endif
+}
+
+
+static void tls_session_nvs_save(void)
+{
+#ifdef OPEN_TLS_TLS_SESSION_NVS
+    nvs_handle_t handle;
+    if( nvs_open(TLS_SESSION_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK ) {
+        ESP_LOGE(TAG, "unable to open NVS");
+        return;
+    }
+
+    if( nvs_set_blob(handle, TLS_SESSION_NVS_KEY, &tls_session_store, sizeof(tls_session_store)) != ESP_OK ||
+        nvs_commit(handle) != ESP_OK ) {
+        ESP_LOGE(TAG, "unable to save the session to NVS");
+    }
+
+    nvs_close(handle);
+#endif
+}
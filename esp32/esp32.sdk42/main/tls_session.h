@@ -0,0 +1,38 @@
+/*
+ * Project Secured MQTT Publisher
+ * Copyright 2026 Care Active Corp. ("Care Active").
+ * Open Source Project Licensed under MIT License.
+ * Please refer to https://github.com/tracmo/open-tls-iot-client
+ * for the license and the contributors information.
+ *
+ */
+
+#ifndef _TLS_SESSION_H_
+#define _TLS_SESSION_H_
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// defines
+#define TLS_SESSION_HOST_SIZE               96      // the longest broker host name kept
+#define TLS_SESSION_TICKET_SIZE             512     // the largest session ticket kept
+
+///////////////////////////////////////////////////////////////////////////////////
+// typdefs
+typedef struct {
+    uint32_t handshakes;                // completed since boot
+    uint32_t resumed;                   // of them, abbreviated with the saved session
+    uint32_t failed;
+    uint32_t lastTime;                  // in ms, the last completed handshake
+    uint32_t fullTime;                  // in ms, the average full handshake
+    uint32_t resumedTime;               // in ms, the average resumed handshake
+    const char *suite;                  // the cipher suite of the last handshake, NULL before the first
+    const char *key;                    // the type of the client key, "RSA" or "EC"
+} tls_session_stats_t;
+
+///////////////////////////////////////////////////////////////////////////////////
+// public functions
+void tls_session_init(void);
+void tls_session_get_stats(tls_session_stats_t *stats);
+
+#endif
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+#
+# Project Secured MQTT Publisher
+# Copyright 2026 Care Active Corp. ("Care Active").
+# Open Source Project Licensed under MIT License.
+# Please refer to https://github.com/tracmo/open-tls-iot-client
+# for the license and the contributors information.
+#
+# Builds the image of the certs partition read by main/tls_certs.c,
+# the root CA, the client certificate and the client key as DER behind a header.
+#
+#   python3 tools/certs_image.py main/certs/aws-root-ca.pem \
+#       main/certs/my-tls-certificate.pem.crt main/certs/my-tls-private.pem.key certs.bin
+#   parttool.py write_partition --partition-name certs --input certs.bin
+#
+# PEM or DER files are accepted, one certificate or key per file.
+
+import argparse
+import base64
+import re
+import struct
+import sys
+import zlib
+
+TLS_CERTS_MAGIC = 0x434c544f        # "OTLC"
+TLS_CERTS_VERSION = 1
+TLS_CERTS_PARTITION_SIZE = 0x4000   # partitions.csv
+
+# magic, version, (offset, len, crc) for the root CA, the client certificate and the key
+HEADER_FORMAT = "<II" + "III" * 3
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT) + 4
+
+PEM_BLOCK = re.compile(rb"-----BEGIN ([A-Z ]+)-----(.*?)-----END \1-----", re.DOTALL)
+
+
+def to_der(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if b"-----BEGIN" not in data:
+        return data
+
+    blocks = PEM_BLOCK.findall(data)
+    if len(blocks) != 1:
+        sys.exit("%s: %d PEM blocks, one is expected" % (path, len(blocks)))
+
+    label, body = blocks[0]
+    if label == b"ENCRYPTED PRIVATE KEY" or b"Proc-Type: 4,ENCRYPTED" in body:
+        sys.exit("%s: encrypted keys are not supported" % path)
+
+    return base64.b64decode(b"".join(body.split()))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="build the certs partition image")
+    parser.add_argument("root_ca")
+    parser.add_argument("client_cert")
+    parser.add_argument("client_key")
+    parser.add_argument("output")
+    args = parser.parse_args()
+
+    items = [to_der(path) for path in (args.root_ca, args.client_cert, args.client_key)]
+
+    entries = []
+    body = b""
+    offset = HEADER_SIZE
+    for der in items:
+        entries += [offset, len(der), zlib.crc32(der) & 0xffffffff]
+        padding = b"\xff" * (-len(der) % 4)
+        body += der + padding
+        offset += len(der) + len(padding)
+
+    header = struct.pack(HEADER_FORMAT, TLS_CERTS_MAGIC, TLS_CERTS_VERSION, *entries)
+    header += struct.pack("<I", zlib.crc32(header) & 0xffffffff)
+
+    image = header + body
+    if len(image) > TLS_CERTS_PARTITION_SIZE:
+        sys.exit("%d bytes do not fit in the certs partition" % len(image))
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+    print("%s: %d bytes, root CA %d, certificate %d, key %d" %
+          (args.output, len(image), len(items[0]), len(items[1]), len(items[2])))
+
+
+if __name__ == "__main__":
+    main()